@@ -0,0 +1,1099 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <utility>
+#include "BigFloat.h"
+
+/** Local Types: **********************************************************************/
+
+typedef std::vector<UINT32> tLimbs;
+
+/** Local Variables: ******************************************************************
+ *    The cached constants, each one with the number of limbs it was computed for:    */
+
+static std::mutex s_ConstLock;
+static tBigFloat  s_Const[C_BIG_ConstCount];
+static size_t     s_uConstLimbs[C_BIG_ConstCount];
+
+/** Local Functions: ******************************************************************
+ *    Natural numbers as limb-vectors, least significant limb first:                  */
+
+static void vTrimNat(tLimbs* pA) {
+    while ((!pA->empty()) && (pA->back() == 0)) pA->pop_back();
+}
+
+static int iCompareNat(const tLimbs& A, const tLimbs& B) {
+    size_t uPos;
+    if (A.size() != B.size()) return (A.size() < B.size()) ? -1 : 1;
+    for (uPos = A.size(); uPos-- > 0; ) {
+        if (A[uPos] != B[uPos]) return (A[uPos] < B[uPos]) ? -1 : 1;
+    }
+    return 0;
+}
+
+/** Adds X * Base^uShift to the number in place: **************************************/
+
+static void vAddNat(tLimbs* pR, const UINT32* pX, size_t uX, size_t uShift) {
+    UINT32 u32Carry = 0;
+    UINT32 u32Sum;
+    size_t uPos;
+    if (pR->size() < uShift + uX) pR->resize(uShift + uX, 0);
+    for (uPos = 0; uPos < uX; uPos++) {
+        u32Sum   = (*pR)[uShift + uPos] + pX[uPos] + u32Carry;
+        u32Carry = (u32Sum >= C_BIG_Base) ? 1 : 0;
+        (*pR)[uShift + uPos] = u32Sum - u32Carry * C_BIG_Base;
+    }
+    for (uPos = uShift + uX; u32Carry != 0; uPos++) {
+        if (uPos == pR->size()) pR->push_back(0);
+        u32Sum   = (*pR)[uPos] + u32Carry;
+        u32Carry = (u32Sum >= C_BIG_Base) ? 1 : 0;
+        (*pR)[uPos] = u32Sum - u32Carry * C_BIG_Base;
+    }
+}
+
+/** Subtracts X * Base^uShift in place, the number must not get negative: *************/
+
+static void vSubNat(tLimbs* pR, const UINT32* pX, size_t uX, size_t uShift) {
+    INT64  s64Diff;
+    INT64  s64Borrow = 0;
+    size_t uPos;
+    for (uPos = 0; uPos < uX; uPos++) {
+        s64Diff   = (INT64) (*pR)[uShift + uPos] - pX[uPos] - s64Borrow;
+        s64Borrow = (s64Diff < 0) ? 1 : 0;
+        (*pR)[uShift + uPos] = (UINT32) (s64Diff + s64Borrow * C_BIG_Base);
+    }
+    for (uPos = uShift + uX; s64Borrow != 0; uPos++) {
+        s64Diff   = (INT64) (*pR)[uPos] - s64Borrow;
+        s64Borrow = (s64Diff < 0) ? 1 : 0;
+        (*pR)[uPos] = (UINT32) (s64Diff + s64Borrow * C_BIG_Base);
+    }
+    vTrimNat(pR);
+}
+
+/** Multiplies by a small factor and adds a small summand in place: *******************/
+
+static void vMulAddNat(tLimbs* pR, UINT32 u32Factor, UINT32 u32Summand) {
+    UINT64 u64Carry = u32Summand;
+    for (UINT32& u32Limb : *pR) {
+        u64Carry += (UINT64) u32Limb * u32Factor;
+        u32Limb   = (UINT32) (u64Carry % C_BIG_Base);
+        u64Carry /= C_BIG_Base;
+    }
+    if (u64Carry != 0) pR->push_back((UINT32) u64Carry);
+}
+
+/** Schoolbook-Multiplication into a zeroed result of uA + uB limbs: ******************
+ *    A partial sum stays below Base^2, thus it fits into 64 bits:                    */
+
+static void vMulSchool(const UINT32* pA, size_t uA, const UINT32* pB, size_t uB, UINT32* pR) {
+    UINT64 u64Carry;
+    UINT64 u64Factor;
+    size_t uRow, uCol;
+    for (uRow = 0; uRow < uA; uRow++) {
+        u64Factor = pA[uRow];
+        if (u64Factor == 0) continue;
+        u64Carry = 0;
+        for (uCol = 0; uCol < uB; uCol++) {
+            u64Carry += pR[uRow + uCol] + u64Factor * pB[uCol];
+            pR[uRow + uCol] = (UINT32) (u64Carry % C_BIG_Base);
+            u64Carry /= C_BIG_Base;
+        }
+        pR[uRow + uB] = (UINT32) u64Carry;
+    }
+}
+
+/** Karatsuba-Multiplication: *********************************************************
+ *    Splits both factors in halves and gets along with three products of them.       *
+ *    Small or unbalanced factors are left to the schoolbook:                         */
+
+static void vMulNat(const UINT32* pA, size_t uA, const UINT32* pB, size_t uB, tLimbs* pR) {
+    /** Variables:                                                                    */
+    tLimbs Low, High, Mid, SumA, SumB;
+    size_t uHalf = ((uA > uB) ? uA : uB) / 2;
+    pR->assign(uA + uB, 0);
+    if ((uA < C_BIG_Karatsuba) || (uB < C_BIG_Karatsuba) || (uA <= uHalf) || (uB <= uHalf)) {
+        vMulSchool(pA, uA, pB, uB, pR->data());
+        vTrimNat(pR);
+        return;
+    }
+    /** The middle part is (a1 + a0)(b1 + b0) - a1 b1 - a0 b0:                        */
+    vMulNat(pA, uHalf, pB, uHalf, &Low);
+    vMulNat(pA + uHalf, uA - uHalf, pB + uHalf, uB - uHalf, &High);
+    SumA.assign(pA, pA + uHalf);
+    SumB.assign(pB, pB + uHalf);
+    vAddNat(&SumA, pA + uHalf, uA - uHalf, 0);
+    vAddNat(&SumB, pB + uHalf, uB - uHalf, 0);
+    vMulNat(SumA.data(), SumA.size(), SumB.data(), SumB.size(), &Mid);
+    vSubNat(&Mid, Low.data(), Low.size(), 0);
+    vSubNat(&Mid, High.data(), High.size(), 0);
+    /** Put the parts together:                                                       */
+    pR->assign(uA + uB, 0);
+    vAddNat(pR, Low.data(), Low.size(), 0);
+    vAddNat(pR, Mid.data(), Mid.size(), uHalf);
+    vAddNat(pR, High.data(), High.size(), 2 * uHalf);
+    vTrimNat(pR);
+}
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************/
+
+CBigMath::CBigMath(INT32 s32Digits) {
+    if (s32Digits < 1) s32Digits = 1;
+    m_s32Digits = s32Digits;
+    m_uLimbs    = (s32Digits + C_BIG_BaseDigits - 1) / C_BIG_BaseDigits + C_BIG_GuardLimbs;
+}
+
+/** Destructor: ***********************************************************************/
+
+CBigMath::~CBigMath() {
+}
+
+/** Get-Function of the significant digits of the output: *****************************/
+
+INT32 CBigMath::s32GetDigits(void) {
+    return m_s32Digits;
+}
+
+/** Conversions: **********************************************************************/
+
+void CBigMath::vFromInt(INT64 s64Value, tBigFloat* pResult) {
+    vFromUInt((s64Value < 0) ? (0 - (UINT64) s64Value) : (UINT64) s64Value, pResult);
+    pResult->bNeg = (s64Value < 0);
+}
+
+void CBigMath::vFromUInt(UINT64 u64Value, tBigFloat* pResult) {
+    pResult->Limbs.clear();
+    pResult->s64Exp = 0;
+    pResult->bNeg   = false;
+    pResult->u8Kind = C_BIG_Finite;
+    while (u64Value != 0) {
+        pResult->Limbs.push_back((UINT32) (u64Value % C_BIG_Base));
+        u64Value /= C_BIG_Base;
+    }
+    vRound(pResult);
+}
+
+/** Takes the double as it was printed with 17 digits: ********************************/
+
+void CBigMath::vFromDouble(double dValue, tBigFloat* pResult) {
+    char         szNumBuf[40];
+    std::wstring sText;
+    if (isnan(dValue)) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if (isinf(dValue)) return vSetSpecial(C_BIG_Inf, dValue < 0, pResult);
+    snprintf(szNumBuf, sizeof(szNumBuf), "%.17e", fabs(dValue));
+    for (const char* pc = szNumBuf; *pc != '\0'; pc++) sText += (WCHAR) *pc;
+    bParse(sText, pResult);
+    if (dValue < 0) pResult->bNeg = !pResult->bNeg;
+}
+
+/** Parses a literal: *****************************************************************
+ *    Decimals with point and exponent are taken exactly, as are integers in 0x and   *
+ *    0b. Returns false for anything else, like hex-floats:                           */
+
+bool CBigMath::bParse(const std::wstring& sText, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    std::string sDigits;
+    size_t      uPos    = 0;
+    INT64       s64Dec  = 0;
+    INT64       s64Pow  = 0;
+    UINT32      u32Base = 0;
+    UINT32      u32Digit;
+    bool        bPoint  = false;
+    bool        bExpNeg = false;
+    pResult->Limbs.clear();
+    pResult->s64Exp = 0;
+    pResult->bNeg   = false;
+    pResult->u8Kind = C_BIG_Finite;
+    if ((sText.length() > 2) && (sText[0] == L'0') && ((sText[1] == L'x') || (sText[1] == L'X') || (sText[1] == L'b'))) {
+        /** Integers in hex or binary, like bParseInteger of CTerm takes them:        */
+        u32Base = (sText[1] == L'b') ? 2 : 16;
+        for (uPos = 2; uPos < sText.length(); uPos++) {
+            if      ((sText[uPos] >= L'0') && (sText[uPos] <= L'9')) u32Digit = sText[uPos] - L'0';
+            else if ((sText[uPos] >= L'a') && (sText[uPos] <= L'f')) u32Digit = sText[uPos] - L'a' + 10;
+            else if ((sText[uPos] >= L'A') && (sText[uPos] <= L'F')) u32Digit = sText[uPos] - L'A' + 10;
+            else return false;
+            if (u32Digit >= u32Base) return false;
+            vMulAddNat(&pResult->Limbs, u32Base, u32Digit);
+        }
+        vRound(pResult);
+        return true;
+    }
+    /** Decimals, collect the digits without leading zeros:                           */
+    for (; uPos < sText.length(); uPos++) {
+        if ((sText[uPos] >= L'0') && (sText[uPos] <= L'9')) {
+            if ((!sDigits.empty()) || (sText[uPos] != L'0')) sDigits += (char) sText[uPos];
+            if (bPoint) s64Dec--;
+        }else if ((sText[uPos] == L'.') && (!bPoint)) {
+            bPoint = true;
+        }else{
+            break;
+        }
+    }
+    /** The exponent, which is limited to keep the limb-exponent in range:            */
+    if ((uPos < sText.length()) && ((sText[uPos] == L'e') || (sText[uPos] == L'E'))) {
+        uPos++;
+        if ((uPos < sText.length()) && ((sText[uPos] == L'+') || (sText[uPos] == L'-'))) bExpNeg = (sText[uPos++] == L'-');
+        if ((uPos >= sText.length()) || (sText[uPos] < L'0') || (sText[uPos] > L'9')) return false;
+        for (; (uPos < sText.length()) && (sText[uPos] >= L'0') && (sText[uPos] <= L'9'); uPos++) {
+            if (s64Pow < 1000000000000000LL) s64Pow = s64Pow * 10 + (sText[uPos] - L'0');
+        }
+        s64Dec += bExpNeg ? -s64Pow : s64Pow;
+    }
+    if (uPos != sText.length()) return false;
+    if (sDigits.empty()) return true;
+    /** Align the exponent to whole limbs and group the digits by nine:               */
+    while ((s64Dec % C_BIG_BaseDigits) != 0) {
+        sDigits += '0';
+        s64Dec--;
+    }
+    for (uPos = sDigits.length(); uPos > 0; ) {
+        size_t uStart = (uPos > C_BIG_BaseDigits) ? uPos - C_BIG_BaseDigits : 0;
+        pResult->Limbs.push_back((UINT32) strtoul(sDigits.substr(uStart, uPos - uStart).c_str(), NULL, 10));
+        uPos = uStart;
+    }
+    pResult->s64Exp = s64Dec / C_BIG_BaseDigits;
+    vRound(pResult);
+    return true;
+}
+
+/** Converts an integral value, which fits into INT64: ********************************/
+
+bool CBigMath::bToInt(const tBigFloat& A, INT64* ps64Value) {
+    UINT64 u64Value;
+    bool   bNeg;
+    if (!bToMagnitude(A, &u64Value, &bNeg)) return false;
+    if (u64Value > (UINT64) INT64_MAX + (bNeg ? 1 : 0)) return false;
+    *ps64Value = bNeg ? (INT64) (0 - u64Value) : (INT64) u64Value;
+    return true;
+}
+
+/** The same for the magnitude and the sign, which fit into 64 bits: ******************/
+
+bool CBigMath::bToMagnitude(const tBigFloat& A, UINT64* pu64Value, bool* pbNeg) {
+    UINT64 u64Value = 0;
+    size_t uPos;
+    INT64  s64Shift;
+    if (A.u8Kind != C_BIG_Finite) return false;
+    if (A.Limbs.empty()) {
+        *pu64Value = 0;
+        *pbNeg     = false;
+        return true;
+    }
+    if ((A.s64Exp < 0) || (A.s64Exp + (INT64) A.Limbs.size() > 3)) return false;
+    for (uPos = A.Limbs.size(); uPos-- > 0; ) {
+        if (u64Value > (UINT64) (UINT64_MAX - A.Limbs[uPos]) / C_BIG_Base) return false;
+        u64Value = u64Value * C_BIG_Base + A.Limbs[uPos];
+    }
+    for (s64Shift = 0; s64Shift < A.s64Exp; s64Shift++) {
+        if (u64Value > UINT64_MAX / C_BIG_Base) return false;
+        u64Value *= C_BIG_Base;
+    }
+    *pu64Value = u64Value;
+    *pbNeg     = A.bNeg;
+    return true;
+}
+
+bool CBigMath::bIsZero(const tBigFloat& A) {
+    return (A.u8Kind == C_BIG_Finite) && A.Limbs.empty();
+}
+
+/** Cuts off the fraction: ************************************************************/
+
+void CBigMath::vTrunc(const tBigFloat& A, tBigFloat* pResult) {
+    tBigFloat tResult = A;
+    if ((A.u8Kind == C_BIG_Finite) && (A.s64Exp < 0)) {
+        if ((size_t) -A.s64Exp >= A.Limbs.size()) {
+            tResult.Limbs.clear();
+        }else{
+            tResult.Limbs.erase(tResult.Limbs.begin(), tResult.Limbs.begin() + (size_t) -A.s64Exp);
+        }
+        tResult.s64Exp = 0;
+        vRound(&tResult);
+    }
+    *pResult = std::move(tResult);
+}
+
+/** Basic Arithmetic: *****************************************************************
+ *    All of them may write to one of their operands:                                 */
+
+void CBigMath::vAdd(const tBigFloat& A, const tBigFloat& B, tBigFloat* pResult) {
+    vAddSigned(A, B, false, pResult);
+}
+
+void CBigMath::vSub(const tBigFloat& A, const tBigFloat& B, tBigFloat* pResult) {
+    vAddSigned(A, B, true, pResult);
+}
+
+void CBigMath::vMul(const tBigFloat& A, const tBigFloat& B, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    tBigFloat tResult;
+    size_t    uSkipA = 0;
+    size_t    uSkipB = 0;
+    if ((A.u8Kind == C_BIG_NaN) || (B.u8Kind == C_BIG_NaN)) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if ((A.u8Kind == C_BIG_Inf) || (B.u8Kind == C_BIG_Inf)) {
+        if (bIsZero(A) || bIsZero(B)) return vSetSpecial(C_BIG_NaN, false, pResult);
+        return vSetSpecial(C_BIG_Inf, A.bNeg != B.bNeg, pResult);
+    }
+    /** Limbs below the precision do not matter:                                      */
+    if (A.Limbs.size() > m_uLimbs + 1) uSkipA = A.Limbs.size() - m_uLimbs - 1;
+    if (B.Limbs.size() > m_uLimbs + 1) uSkipB = B.Limbs.size() - m_uLimbs - 1;
+    vMulNat(A.Limbs.data() + uSkipA, A.Limbs.size() - uSkipA, B.Limbs.data() + uSkipB, B.Limbs.size() - uSkipB, &tResult.Limbs);
+    tResult.s64Exp = A.s64Exp + B.s64Exp + (INT64) (uSkipA + uSkipB);
+    tResult.bNeg   = (A.bNeg != B.bNeg);
+    tResult.u8Kind = C_BIG_Finite;
+    vRound(&tResult);
+    *pResult = std::move(tResult);
+}
+
+/** Division: *************************************************************************
+ *    Returns false for a divisor of zero. Small integer divisors are divided         *
+ *    directly, all others are multiplied by the reciprocal:                          */
+
+bool CBigMath::bDiv(const tBigFloat& A, const tBigFloat& B, tBigFloat* pResult) {
+    tBigFloat tRecip;
+    bool      bNeg = (A.bNeg != B.bNeg);
+    if ((A.u8Kind == C_BIG_NaN) || (B.u8Kind == C_BIG_NaN)) {
+        vSetSpecial(C_BIG_NaN, false, pResult);
+        return true;
+    }
+    if (bIsZero(B)) return false;
+    if (B.u8Kind == C_BIG_Inf) {
+        if (A.u8Kind == C_BIG_Inf) vSetSpecial(C_BIG_NaN, false, pResult);
+        else vFromInt(0, pResult);
+        return true;
+    }
+    if (A.u8Kind == C_BIG_Inf) {
+        vSetSpecial(C_BIG_Inf, bNeg, pResult);
+        return true;
+    }
+    if (B.Limbs.size() == 1) {
+        INT64 s64Exp = B.s64Exp;
+        vDivSmall(A, B.Limbs[0], pResult);
+        pResult->s64Exp -= s64Exp;
+        if (!pResult->Limbs.empty()) pResult->bNeg = bNeg;
+        return true;
+    }
+    vReciprocal(B, &tRecip);
+    vMul(A, tRecip, pResult);
+    return true;
+}
+
+/** Square Root: **********************************************************************
+ *    Newton-iteration on the inverse root, which needs no division. It starts from   *
+ *    the double-result and doubles the correct digits with each step:                */
+
+void CBigMath::vSqrt(const tBigFloat& A, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    tBigFloat tY, tT, tThree;
+    INT64     s64Exp;
+    double    dApproxA;
+    size_t    uGood;
+    size_t    uSaved = m_uLimbs;
+    if ((A.u8Kind == C_BIG_NaN) || (A.bNeg && !bIsZero(A))) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if ((A.u8Kind == C_BIG_Inf) || bIsZero(A)) {
+        *pResult = A;
+        return;
+    }
+    /** A = d * Base^exp, with an even exponent:                                      */
+    dApproxA = dApprox(A, &s64Exp);
+    if ((s64Exp % 2) != 0) {
+        dApproxA *= C_BIG_Base;
+        s64Exp--;
+    }
+    vFromDouble(1 / sqrt(dApproxA), &tY);
+    tY.s64Exp -= s64Exp / 2;
+    m_uLimbs++;
+    vFromInt(3, &tThree);
+    /** y = y (3 - A y^2) / 2:                                                        */
+    for (uGood = 14; uGood < m_uLimbs * C_BIG_BaseDigits; uGood *= 2) {
+        vMul(tY, tY, &tT);
+        vMul(tT, A, &tT);
+        vSub(tThree, tT, &tT);
+        vMul(tY, tT, &tY);
+        vDivSmall(tY, 2, &tY);
+    }
+    vMul(A, tY, &tY);
+    m_uLimbs = uSaved;
+    vRound(&tY);
+    *pResult = std::move(tY);
+}
+
+/** Power: ****************************************************************************
+ *    Integer exponents are done by squaring, thus they stay exact for integer        *
+ *    bases. All others go through exp(b * log(a)):                                   */
+
+void CBigMath::vPow(const tBigFloat& A, const tBigFloat& B, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    tBigFloat tBase, tResult;
+    INT64     s64Power;
+    UINT64    u64Power;
+    size_t    uSaved = m_uLimbs;
+    if ((A.u8Kind == C_BIG_NaN) || (B.u8Kind == C_BIG_NaN)) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if (bToInt(B, &s64Power)) {
+        if (bIsZero(A)) {
+            if (s64Power == 0) return vFromInt(1, pResult);
+            if (s64Power > 0) return vFromInt(0, pResult);
+            return vSetSpecial(C_BIG_Inf, false, pResult);
+        }
+        m_uLimbs++;
+        tBase    = A;
+        u64Power = (s64Power < 0) ? (0 - (UINT64) s64Power) : (UINT64) s64Power;
+        vFromInt(1, &tResult);
+        while (u64Power != 0) {
+            if (u64Power & 1) vMul(tResult, tBase, &tResult);
+            u64Power >>= 1;
+            if (u64Power != 0) vMul(tBase, tBase, &tBase);
+        }
+        if (s64Power < 0) {
+            vFromInt(1, &tBase);
+            bDiv(tBase, tResult, &tResult);
+        }
+    }else{
+        if (A.bNeg && !bIsZero(A)) return vSetSpecial(C_BIG_NaN, false, pResult);
+        if (bIsZero(A)) {
+            if (B.bNeg) return vSetSpecial(C_BIG_Inf, false, pResult);
+            return vFromInt(0, pResult);
+        }
+        m_uLimbs += 2;
+        vLog(A, &tResult);
+        vMul(tResult, B, &tResult);
+        vExp(tResult, &tResult);
+    }
+    m_uLimbs = uSaved;
+    vRound(&tResult);
+    *pResult = std::move(tResult);
+}
+
+/** Exponential Function: *************************************************************
+ *    The argument is divided by 2^k, so that the Taylor-series converges quickly.    *
+ *    Squaring k times doubles the error each time, thus there are more guards:       */
+
+void CBigMath::vExp(const tBigFloat& A, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    tBigFloat tR, tTerm, tSum;
+    INT64     s64Exp;
+    double    dValue;
+    INT32     s32Halve;
+    UINT32    u32Index;
+    size_t    uSaved = m_uLimbs;
+    if (A.u8Kind == C_BIG_NaN) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if (A.u8Kind == C_BIG_Inf) {
+        if (A.bNeg) return vFromInt(0, pResult);
+        return vSetSpecial(C_BIG_Inf, false, pResult);
+    }
+    if (bIsZero(A)) return vFromInt(1, pResult);
+    dValue = dApprox(A, &s64Exp);
+    dValue = (s64Exp > 2) ? HUGE_VAL : (dValue * pow((double) C_BIG_Base, (double) s64Exp));
+    if (fabs(dValue) > C_BIG_MaxExp) {
+        if (A.bNeg) return vFromInt(0, pResult);
+        return vSetSpecial(C_BIG_Inf, false, pResult);
+    }
+    /** Get |r| below 2^-sqrt(bits):                                                  */
+    s32Halve = (INT32) sqrt((double) m_uLimbs * 30) + ilogb(fabs(dValue)) + 1;
+    if (s32Halve < 0) s32Halve = 0;
+    m_uLimbs += 1 + s32Halve / 29;
+    vScale2(A, -s32Halve, &tR);
+    /** The series:                                                                   */
+    vFromInt(1, &tSum);
+    vFromInt(1, &tTerm);
+    for (u32Index = 1; ; u32Index++) {
+        vMul(tTerm, tR, &tTerm);
+        vDivSmall(tTerm, u32Index, &tTerm);
+        if (bNegligible(tTerm, tSum)) break;
+        vAdd(tSum, tTerm, &tSum);
+    }
+    /** And square it back:                                                           */
+    for (; s32Halve > 0; s32Halve--) vMul(tSum, tSum, &tSum);
+    m_uLimbs = uSaved;
+    vRound(&tSum);
+    *pResult = std::move(tSum);
+}
+
+/** Natural Logarithm: ****************************************************************
+ *    With A = m * Base^k, log(A) = log(m) + 9 k log(10), where m is in [1, 10^9):    */
+
+void CBigMath::vLog(const tBigFloat& A, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    tBigFloat tMantissa, tResult, tLn10;
+    INT64     s64Exp;
+    size_t    uSaved = m_uLimbs;
+    if ((A.u8Kind == C_BIG_NaN) || (A.bNeg && !bIsZero(A))) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if (A.u8Kind == C_BIG_Inf) return vSetSpecial(C_BIG_Inf, false, pResult);
+    if (bIsZero(A)) return vSetSpecial(C_BIG_Inf, true, pResult);
+    dApprox(A, &s64Exp);
+    tMantissa = A;
+    tMantissa.s64Exp -= s64Exp;
+    m_uLimbs++;
+    vLogNewton(tMantissa, &tResult);
+    if (s64Exp != 0) {
+        vConstant(C_BIG_ConstLn10, &tLn10);
+        vFromInt(s64Exp * C_BIG_BaseDigits, &tMantissa);
+        vMul(tLn10, tMantissa, &tLn10);
+        vAdd(tResult, tLn10, &tResult);
+    }
+    m_uLimbs = uSaved;
+    vRound(&tResult);
+    *pResult = std::move(tResult);
+}
+
+/** Trigonometric Functions: **********************************************************/
+
+void CBigMath::vSin(const tBigFloat& A, tBigFloat* pResult) {
+    tBigFloat tCos;
+    vSinCos(A, pResult, &tCos);
+}
+
+void CBigMath::vCos(const tBigFloat& A, tBigFloat* pResult) {
+    tBigFloat tSin;
+    vSinCos(A, &tSin, pResult);
+}
+
+void CBigMath::vTan(const tBigFloat& A, tBigFloat* pResult) {
+    tBigFloat tSin, tCos;
+    vSinCos(A, &tSin, &tCos);
+    if (!bDiv(tSin, tCos, pResult)) vSetSpecial(C_BIG_Inf, tSin.bNeg, pResult);
+}
+
+/** Arcus Tangens: ********************************************************************
+ *    Arguments above one are inverted. As atan(x) = 2 atan(x / (1 + sqrt(1 + x^2))), *
+ *    the argument is halved, until the series converges quickly:                     */
+
+void CBigMath::vAtan(const tBigFloat& A, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    tBigFloat tX, tX2, tPower, tTerm, tSum, tOne;
+    INT32     s32Halve;
+    INT32     s32Step;
+    UINT32    u32Index;
+    bool      bInvert;
+    size_t    uSaved = m_uLimbs;
+    if (A.u8Kind == C_BIG_NaN) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if (bIsZero(A)) return vFromInt(0, pResult);
+    m_uLimbs++;
+    vFromInt(1, &tOne);
+    tX      = A;
+    tX.bNeg = false;
+    bInvert = (A.u8Kind == C_BIG_Inf);
+    if (bInvert) {
+        vFromInt(0, &tX);
+    }else if (tX.s64Exp + (INT64) tX.Limbs.size() >= 1) {
+        bInvert = true;
+        bDiv(tOne, tX, &tX);
+    }
+    /** Halve the argument:                                                           */
+    s32Halve = (INT32) sqrt((double) m_uLimbs * 30) / 3;
+    if (s32Halve > 29) s32Halve = 29;
+    for (s32Step = 0; s32Step < s32Halve; s32Step++) {
+        vMul(tX, tX, &tTerm);
+        vAdd(tTerm, tOne, &tTerm);
+        vSqrt(tTerm, &tTerm);
+        vAdd(tTerm, tOne, &tTerm);
+        bDiv(tX, tTerm, &tX);
+    }
+    /** The series x - x^3/3 + x^5/5 - ...:                                           */
+    tSum   = tX;
+    tPower = tX;
+    vMul(tX, tX, &tX2);
+    for (u32Index = 1; !bIsZero(tPower); u32Index++) {
+        vMul(tPower, tX2, &tPower);
+        vDivSmall(tPower, 2 * u32Index + 1, &tTerm);
+        if (bNegligible(tTerm, tSum)) break;
+        if (u32Index & 1) vSub(tSum, tTerm, &tSum);
+        else              vAdd(tSum, tTerm, &tSum);
+    }
+    vMulSmall(tSum, (UINT32) 1 << s32Halve, &tSum);
+    /** pi/2 - atan(1/x) for the inverted ones:                                       */
+    if (bInvert) {
+        vConstant(C_BIG_ConstPi, &tX);
+        vDivSmall(tX, 2, &tX);
+        vSub(tX, tSum, &tSum);
+    }
+    tSum.bNeg = A.bNeg && !bIsZero(tSum);
+    m_uLimbs  = uSaved;
+    vRound(&tSum);
+    *pResult = std::move(tSum);
+}
+
+/** Arcus Sinus and Cosinus, based on the arcus tangens: ******************************/
+
+void CBigMath::vAsin(const tBigFloat& A, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    tBigFloat tOne, tT, tU;
+    size_t    uSaved = m_uLimbs;
+    if (A.u8Kind != C_BIG_Finite) return vSetSpecial(C_BIG_NaN, false, pResult);
+    vFromInt(1, &tOne);
+    tT      = A;
+    tT.bNeg = false;
+    vSub(tT, tOne, &tU);
+    if ((!tU.bNeg) && (!bIsZero(tU))) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if (bIsZero(tU)) {
+        /** +-pi/2:                                                                   */
+        vConstant(C_BIG_ConstPi, &tT);
+        vDivSmall(tT, 2, pResult);
+        pResult->bNeg = A.bNeg;
+        return;
+    }
+    /** asin(x) = atan(x / sqrt((1 - x)(1 + x))):                                     */
+    m_uLimbs++;
+    vSub(tOne, A, &tT);
+    vAdd(tOne, A, &tU);
+    vMul(tT, tU, &tT);
+    vSqrt(tT, &tT);
+    bDiv(A, tT, &tT);
+    vAtan(tT, &tT);
+    m_uLimbs = uSaved;
+    vRound(&tT);
+    *pResult = std::move(tT);
+}
+
+void CBigMath::vAcos(const tBigFloat& A, tBigFloat* pResult) {
+    tBigFloat tHalfPi, tAsin;
+    size_t    uSaved = m_uLimbs;
+    m_uLimbs++;
+    vAsin(A, &tAsin);
+    vConstant(C_BIG_ConstPi, &tHalfPi);
+    vDivSmall(tHalfPi, 2, &tHalfPi);
+    vSub(tHalfPi, tAsin, pResult);
+    m_uLimbs = uSaved;
+    vRound(pResult);
+}
+
+/** Cached Constants: *****************************************************************
+ *    pi by Machin's formula, e by its series and log(10) by Newton. Once computed,   *
+ *    a constant serves all instances with the same or fewer digits:                  */
+
+void CBigMath::vConstant(UINT32 u32Const, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    std::lock_guard<std::mutex> Guard(s_ConstLock);
+    tBigFloat tValue, tTerm;
+    UINT32    u32Index;
+    size_t    uSaved = m_uLimbs;
+    if (u32Const >= C_BIG_ConstCount) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if (s_uConstLimbs[u32Const] < m_uLimbs) {
+        m_uLimbs++;
+        switch (u32Const) {
+        case C_BIG_ConstPi:
+            /** pi = 16 atan(1/5) - 4 atan(1/239):                                    */
+            vArctanInv(5, &tValue);
+            vArctanInv(239, &tTerm);
+            vMulSmall(tValue, 4, &tValue);
+            vSub(tValue, tTerm, &tValue);
+            vMulSmall(tValue, 4, &tValue);
+            break;
+        case C_BIG_ConstE:
+            /** e = sum of 1/k!:                                                      */
+            vFromInt(1, &tValue);
+            vFromInt(1, &tTerm);
+            for (u32Index = 1; ; u32Index++) {
+                vDivSmall(tTerm, u32Index, &tTerm);
+                if (bNegligible(tTerm, tValue)) break;
+                vAdd(tValue, tTerm, &tValue);
+            }
+            break;
+        default:
+            vFromInt(10, &tTerm);
+            vLogNewton(tTerm, &tValue);
+            break;
+        }
+        m_uLimbs = uSaved;
+        s_Const[u32Const]       = std::move(tValue);
+        s_uConstLimbs[u32Const] = m_uLimbs;
+    }
+    *pResult = s_Const[u32Const];
+    vRound(pResult);
+}
+
+/** Output: ***************************************************************************
+ *    Writes the digits of the constructor. Numbers with up to this many integer-     *
+ *    digits and down to 10^-5 are written in fixed-point, all others exponential:    */
+
+void CBigMath::vAppend(const tBigFloat& A, std::wstring* psOutput) {
+    /** Variables:                                                                    */
+    std::string sDigits;
+    char        szLimb[24];
+    size_t      uPos;
+    INT64       s64Point;
+    if (A.u8Kind == C_BIG_NaN) {
+        *psOutput += L"NAN";
+        return;
+    }
+    if (A.bNeg) *psOutput += L'-';
+    if (A.u8Kind == C_BIG_Inf) {
+        *psOutput += L"INF";
+        return;
+    }
+    if (A.Limbs.empty()) {
+        *psOutput += L'0';
+        return;
+    }
+    /** All digits, the decimal point is behind s64Point of them:                     */
+    for (uPos = A.Limbs.size(); uPos-- > 0; ) {
+        snprintf(szLimb, sizeof(szLimb), (uPos + 1 == A.Limbs.size()) ? "%u" : "%09u", (unsigned) A.Limbs[uPos]);
+        sDigits += szLimb;
+    }
+    s64Point = (INT64) sDigits.length() + A.s64Exp * C_BIG_BaseDigits;
+    /** Round to the requested digits:                                                */
+    if (sDigits.length() > (size_t) m_s32Digits) {
+        bool bUp = (sDigits[m_s32Digits] >= '5');
+        sDigits.resize(m_s32Digits);
+        for (uPos = sDigits.length(); bUp && (uPos-- > 0); ) {
+            bUp = (sDigits[uPos] == '9');
+            sDigits[uPos] = bUp ? '0' : (char) (sDigits[uPos] + 1);
+        }
+        if (bUp) {
+            sDigits.insert(sDigits.begin(), '1');
+            sDigits.pop_back();
+            s64Point++;
+        }
+    }
+    while ((sDigits.length() > 1) && (sDigits.back() == '0')) sDigits.pop_back();
+    /** And write it:                                                                 */
+    if ((s64Point > 0) && (s64Point <= m_s32Digits)) {
+        if ((INT64) sDigits.length() <= s64Point) {
+            sDigits.append((size_t) (s64Point - sDigits.length()), '0');
+        }else{
+            sDigits.insert((size_t) s64Point, 1, '.');
+        }
+    }else if ((s64Point <= 0) && (s64Point > -5)) {
+        sDigits.insert(0, "0." + std::string((size_t) -s64Point, '0'));
+    }else{
+        if (sDigits.length() > 1) sDigits.insert(1, 1, '.');
+        snprintf(szLimb, sizeof(szLimb), "E%+03lld", (long long) (s64Point - 1));
+        sDigits += szLimb;
+    }
+    for (char c : sDigits) *psOutput += (WCHAR) c;
+}
+
+/** Private Functions: ****************************************************************/
+
+void CBigMath::vSetSpecial(UINT8 u8Kind, bool bNeg, tBigFloat* pResult) {
+    pResult->Limbs.clear();
+    pResult->s64Exp = 0;
+    pResult->bNeg   = bNeg;
+    pResult->u8Kind = u8Kind;
+}
+
+/** Rounds to the working precision and removes zero-limbs at both ends: **************/
+
+void CBigMath::vRound(tBigFloat* pA) {
+    size_t uDrop;
+    UINT32 u32One = 1;
+    bool   bUp;
+    vTrimNat(&pA->Limbs);
+    if (pA->Limbs.empty()) {
+        pA->s64Exp = 0;
+        pA->bNeg   = false;
+        return;
+    }
+    if (pA->Limbs.size() > m_uLimbs) {
+        uDrop = pA->Limbs.size() - m_uLimbs;
+        bUp   = (pA->Limbs[uDrop - 1] >= C_BIG_Base / 2);
+        pA->Limbs.erase(pA->Limbs.begin(), pA->Limbs.begin() + uDrop);
+        pA->s64Exp += (INT64) uDrop;
+        if (bUp) vAddNat(&pA->Limbs, &u32One, 1, 0);
+    }
+    for (uDrop = 0; pA->Limbs[uDrop] == 0; uDrop++);
+    if (uDrop > 0) {
+        pA->Limbs.erase(pA->Limbs.begin(), pA->Limbs.begin() + uDrop);
+        pA->s64Exp += (INT64) uDrop;
+    }
+    /** Out of range:                                                                 */
+    if (pA->s64Exp > C_BIG_MaxLimbExp) {
+        vSetSpecial(C_BIG_Inf, pA->bNeg, pA);
+    }else if (pA->s64Exp < -C_BIG_MaxLimbExp) {
+        pA->Limbs.clear();
+        pA->s64Exp = 0;
+        pA->bNeg   = false;
+    }
+}
+
+/** Adds or subtracts, with the operands aligned to their lower exponent. Limbs far   *
+ *  below the precision of the larger one are dropped before:                         */
+
+void CBigMath::vAddSigned(const tBigFloat& A, const tBigFloat& B, bool bFlipB, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    const tBigFloat* apOp[2] = { &A, &B };
+    tLimbs           aAligned[2];
+    tBigFloat        tResult;
+    bool             bNegB = (B.bNeg != bFlipB);
+    INT64            s64TopA, s64TopB, s64Low;
+    INT64            s64Shift;
+    INT32            s32Cmp;
+    size_t           uOp;
+    if ((A.u8Kind == C_BIG_NaN) || (B.u8Kind == C_BIG_NaN)) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if ((A.u8Kind == C_BIG_Inf) && (B.u8Kind == C_BIG_Inf) && (A.bNeg != bNegB)) return vSetSpecial(C_BIG_NaN, false, pResult);
+    if (A.u8Kind == C_BIG_Inf) return vSetSpecial(C_BIG_Inf, A.bNeg, pResult);
+    if (B.u8Kind == C_BIG_Inf) return vSetSpecial(C_BIG_Inf, bNegB, pResult);
+    if (B.Limbs.empty()) {
+        tResult = A;
+    }else if (A.Limbs.empty()) {
+        tResult      = B;
+        tResult.bNeg = bNegB;
+    }else{
+        /** Align both to the same exponent:                                          */
+        s64TopA = A.s64Exp + (INT64) A.Limbs.size();
+        s64TopB = B.s64Exp + (INT64) B.Limbs.size();
+        s64Low  = ((s64TopA > s64TopB) ? s64TopA : s64TopB) - (INT64) (m_uLimbs + 2);
+        if ((A.s64Exp > s64Low) && (B.s64Exp > s64Low)) s64Low = (A.s64Exp < B.s64Exp) ? A.s64Exp : B.s64Exp;
+        for (uOp = 0; uOp < 2; uOp++) {
+            s64Shift = apOp[uOp]->s64Exp - s64Low;
+            if (s64Shift >= 0) {
+                aAligned[uOp].assign((size_t) s64Shift, 0);
+                aAligned[uOp].insert(aAligned[uOp].end(), apOp[uOp]->Limbs.begin(), apOp[uOp]->Limbs.end());
+            }else if ((size_t) -s64Shift < apOp[uOp]->Limbs.size()) {
+                aAligned[uOp].assign(apOp[uOp]->Limbs.begin() + (size_t) -s64Shift, apOp[uOp]->Limbs.end());
+            }
+            vTrimNat(&aAligned[uOp]);
+        }
+        /** Same signs add up, otherwise the smaller is subtracted:                   */
+        tResult.s64Exp = s64Low;
+        tResult.u8Kind = C_BIG_Finite;
+        if (A.bNeg == bNegB) {
+            tResult.Limbs = std::move(aAligned[0]);
+            vAddNat(&tResult.Limbs, aAligned[1].data(), aAligned[1].size(), 0);
+            tResult.bNeg  = A.bNeg;
+        }else{
+            s32Cmp = iCompareNat(aAligned[0], aAligned[1]);
+            uOp    = (s32Cmp >= 0) ? 0 : 1;
+            tResult.Limbs = std::move(aAligned[uOp]);
+            vSubNat(&tResult.Limbs, aAligned[1 - uOp].data(), aAligned[1 - uOp].size(), 0);
+            tResult.bNeg  = (uOp == 0) ? A.bNeg : bNegB;
+        }
+    }
+    vRound(&tResult);
+    *pResult = std::move(tResult);
+}
+
+/** Multiplies by a factor below the base: ********************************************/
+
+void CBigMath::vMulSmall(const tBigFloat& A, UINT32 u32Factor, tBigFloat* pResult) {
+    if (pResult != &A) *pResult = A;
+    if (pResult->u8Kind != C_BIG_Finite) return;
+    vMulAddNat(&pResult->Limbs, u32Factor, 0);
+    vRound(pResult);
+}
+
+/** Divides by a divisor below the base: **********************************************
+ *    The dividend is extended by zero-limbs to the precision first:                  */
+
+void CBigMath::vDivSmall(const tBigFloat& A, UINT32 u32Divisor, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    tBigFloat tResult;
+    UINT64    u64Rest = 0;
+    size_t    uExtra  = 0;
+    size_t    uPos;
+    if (A.u8Kind != C_BIG_Finite) {
+        *pResult = A;
+        return;
+    }
+    if (A.Limbs.size() < m_uLimbs + 1) uExtra = m_uLimbs + 1 - A.Limbs.size();
+    tResult.Limbs.assign(uExtra + A.Limbs.size(), 0);
+    tResult.s64Exp = A.s64Exp - (INT64) uExtra;
+    tResult.bNeg   = A.bNeg;
+    tResult.u8Kind = C_BIG_Finite;
+    for (uPos = tResult.Limbs.size(); uPos-- > 0; ) {
+        u64Rest = u64Rest * C_BIG_Base + ((uPos >= uExtra) ? A.Limbs[uPos - uExtra] : 0);
+        tResult.Limbs[uPos] = (UINT32) (u64Rest / u32Divisor);
+        u64Rest %= u32Divisor;
+    }
+    vRound(&tResult);
+    *pResult = std::move(tResult);
+}
+
+/** Multiplies by 2^s32Power: *********************************************************/
+
+void CBigMath::vScale2(const tBigFloat& A, INT32 s32Power, tBigFloat* pResult) {
+    INT32 s32Step;
+    *pResult = A;
+    for (; s32Power != 0; s32Power -= (s32Power > 0) ? s32Step : -s32Step) {
+        s32Step = (abs(s32Power) > 29) ? 29 : abs(s32Power);
+        if (s32Power > 0) vMulSmall(*pResult, (UINT32) 1 << s32Step, pResult);
+        else              vDivSmall(*pResult, (UINT32) 1 << s32Step, pResult);
+    }
+}
+
+/** Reciprocal by Newton: y = y + y (1 - A y), starting from the double-result: *******/
+
+void CBigMath::vReciprocal(const tBigFloat& A, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    tBigFloat tY, tT, tOne;
+    INT64     s64Exp;
+    size_t    uGood;
+    size_t    uSaved = m_uLimbs;
+    vFromDouble(1 / dApprox(A, &s64Exp), &tY);
+    tY.s64Exp -= s64Exp;
+    m_uLimbs++;
+    vFromInt(1, &tOne);
+    for (uGood = 14; uGood < m_uLimbs * C_BIG_BaseDigits; uGood *= 2) {
+        vMul(A, tY, &tT);
+        vSub(tOne, tT, &tT);
+        vMul(tY, tT, &tT);
+        vAdd(tY, tT, &tY);
+    }
+    m_uLimbs = uSaved;
+    vRound(&tY);
+    *pResult = std::move(tY);
+}
+
+/** Logarithm of a positive value by Newton, y = y + 2 (A - e^y) / (A + e^y). It      *
+ *  starts from the double-result and triples the correct digits with each step:      */
+
+void CBigMath::vLogNewton(const tBigFloat& A, tBigFloat* pResult) {
+    /** Variables:                                                                    */
+    tBigFloat tY, tE, tDiff, tSum;
+    INT64     s64Exp;
+    double    dValue;
+    size_t    uGood;
+    dValue = dApprox(A, &s64Exp);
+    vFromDouble(log(dValue) + (double) s64Exp * C_BIG_BaseDigits * log(10.0), &tY);
+    for (uGood = 14; uGood < m_uLimbs * C_BIG_BaseDigits; uGood *= 3) {
+        vExp(tY, &tE);
+        vSub(A, tE, &tDiff);
+        vAdd(A, tE, &tSum);
+        bDiv(tDiff, tSum, &tDiff);
+        vMulSmall(tDiff, 2, &tDiff);
+        vAdd(tY, tDiff, &tY);
+    }
+    *pResult = std::move(tY);
+}
+
+/** Sinus and Cosinus together: *******************************************************
+ *    The argument is reduced by multiples of pi/2, which needs pi with as many more  *
+ *    digits as the argument has integer-digits. The rest is divided by 2^k for the   *
+ *    series and brought back with the double-angle formulas:                         */
+
+void CBigMath::vSinCos(const tBigFloat& A, tBigFloat* pSin, tBigFloat* pCos) {
+    /** Variables:                                                                    */
+    tBigFloat tHalfPi, tQuad, tR, tR2, tTerm, tSin, tCos;
+    INT64     s64Top;
+    INT32     s32Halve;
+    UINT32    u32Index;
+    UINT32    u32Quadrant = 0;
+    size_t    uSaved = m_uLimbs;
+    s64Top = A.s64Exp + (INT64) A.Limbs.size();
+    if ((A.u8Kind != C_BIG_Finite) || (s64Top > C_BIG_MaxDigits / C_BIG_BaseDigits)) {
+        vSetSpecial(C_BIG_NaN, false, pSin);
+        vSetSpecial(C_BIG_NaN, false, pCos);
+        return;
+    }
+    m_uLimbs += 1 + ((s64Top > 0) ? (size_t) s64Top : 0);
+    /** r = A - n pi/2, with the quadrant n:                                          */
+    vConstant(C_BIG_ConstPi, &tHalfPi);
+    vDivSmall(tHalfPi, 2, &tHalfPi);
+    bDiv(A, tHalfPi, &tQuad);
+    vFromInt(tQuad.bNeg ? -1 : 1, &tTerm);
+    vDivSmall(tTerm, 2, &tTerm);
+    vAdd(tQuad, tTerm, &tQuad);
+    vTrunc(tQuad, &tQuad);
+    if ((!tQuad.Limbs.empty()) && (tQuad.s64Exp == 0)) {
+        u32Quadrant = tQuad.Limbs[0] % 4;
+        if (tQuad.bNeg) u32Quadrant = (4 - u32Quadrant) % 4;
+    }
+    vMul(tQuad, tHalfPi, &tR);
+    vSub(A, tR, &tR);
+    /** The series of both on r / 2^k:                                                */
+    s32Halve = (INT32) sqrt((double) m_uLimbs * 30) / 2;
+    vScale2(tR, -s32Halve, &tR);
+    vMul(tR, tR, &tR2);
+    tSin = tR;
+    tTerm = tR;
+    for (u32Index = 1; !bIsZero(tTerm); u32Index++) {
+        vMul(tTerm, tR2, &tTerm);
+        vDivSmall(tTerm, (2 * u32Index) * (2 * u32Index + 1), &tTerm);
+        if (bNegligible(tTerm, tSin)) break;
+        if (u32Index & 1) vSub(tSin, tTerm, &tSin);
+        else              vAdd(tSin, tTerm, &tSin);
+    }
+    vFromInt(1, &tCos);
+    vFromInt(1, &tTerm);
+    for (u32Index = 1; ; u32Index++) {
+        vMul(tTerm, tR2, &tTerm);
+        vDivSmall(tTerm, (2 * u32Index - 1) * (2 * u32Index), &tTerm);
+        if (bNegligible(tTerm, tCos)) break;
+        if (u32Index & 1) vSub(tCos, tTerm, &tCos);
+        else              vAdd(tCos, tTerm, &tCos);
+    }
+    /** sin 2a = 2 sin a cos a, cos 2a = 1 - 2 sin^2 a:                               */
+    for (; s32Halve > 0; s32Halve--) {
+        vMul(tSin, tSin, &tTerm);
+        vMul(tSin, tCos, &tSin);
+        vMulSmall(tSin, 2, &tSin);
+        vMulSmall(tTerm, 2, &tTerm);
+        vFromInt(1, &tCos);
+        vSub(tCos, tTerm, &tCos);
+    }
+    /** Back to the quadrant:                                                         */
+    if (u32Quadrant & 1) std::swap(tSin, tCos);
+    if ((u32Quadrant == 1) || (u32Quadrant == 2)) tCos.bNeg = !tCos.bNeg && !bIsZero(tCos);
+    if ((u32Quadrant == 2) || (u32Quadrant == 3)) tSin.bNeg = !tSin.bNeg && !bIsZero(tSin);
+    m_uLimbs = uSaved;
+    vRound(&tSin);
+    vRound(&tCos);
+    *pSin = std::move(tSin);
+    *pCos = std::move(tCos);
+}
+
+/** atan(1/n) = 1/n - 1/(3 n^3) + 1/(5 n^5) - ..., for Machin's formula: **************/
+
+void CBigMath::vArctanInv(UINT32 u32Inverse, tBigFloat* pResult) {
+    tBigFloat tPower, tTerm, tSum;
+    UINT32    u32Index;
+    vFromInt(1, &tPower);
+    vDivSmall(tPower, u32Inverse, &tPower);
+    tSum = tPower;
+    for (u32Index = 1; ; u32Index++) {
+        vDivSmall(tPower, u32Inverse * u32Inverse, &tPower);
+        vDivSmall(tPower, 2 * u32Index + 1, &tTerm);
+        if (bNegligible(tTerm, tSum)) break;
+        if (u32Index & 1) vSub(tSum, tTerm, &tSum);
+        else              vAdd(tSum, tTerm, &tSum);
+    }
+    *pResult = std::move(tSum);
+}
+
+/** Tells, if a term of a series is below the precision of its sum: *******************/
+
+bool CBigMath::bNegligible(const tBigFloat& Term, const tBigFloat& Sum) {
+    if (Term.Limbs.empty()) return true;
+    if (Sum.Limbs.empty()) return false;
+    return (Term.s64Exp + (INT64) Term.Limbs.size()) < (Sum.s64Exp + (INT64) Sum.Limbs.size() - (INT64) m_uLimbs);
+}
+
+/** A as d * Base^exp, where d is within [1, Base): ***********************************/
+
+double CBigMath::dApprox(const tBigFloat& A, INT64* ps64Exp) {
+    size_t uSize  = A.Limbs.size();
+    double dValue = 0;
+    *ps64Exp = 0;
+    if (uSize == 0) return 0;
+    dValue = A.Limbs[uSize - 1];
+    if (uSize > 1) dValue += A.Limbs[uSize - 2] / (double) C_BIG_Base;
+    if (uSize > 2) dValue += A.Limbs[uSize - 3] / ((double) C_BIG_Base * C_BIG_Base);
+    *ps64Exp = A.s64Exp + (INT64) uSize - 1;
+    return A.bNeg ? -dValue : dValue;
+}
@@ -0,0 +1,104 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+#define C_BIG_Base        1000000000  // Each limb holds nine decimal digits
+#define C_BIG_BaseDigits  9
+#define C_BIG_GuardLimbs  2           // Limbs beyond the requested digits
+#define C_BIG_Karatsuba   32          // Limbs of both factors, from which on Karatsuba is used
+#define C_BIG_MaxDigits   2000
+#define C_BIG_MaxExp      1e15        // Larger arguments of exp() overflow right away
+#define C_BIG_MaxLimbExp  100000000000000LL  // Limb-exponents beyond give INF or zero
+
+#define C_BIG_Finite      0x00
+#define C_BIG_NaN         0x01
+#define C_BIG_Inf         0x02
+
+#define C_BIG_ConstPi     0x00
+#define C_BIG_ConstE      0x01
+#define C_BIG_ConstLn10   0x02
+#define C_BIG_ConstCount  0x03
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct tBigFloat {
+    std::vector<UINT32> Limbs;           // Base 10^9, least significant first, no zero on top
+    INT64               s64Exp;          // The value is Limbs * 10^(9 * s64Exp)
+    bool                bNeg;
+    UINT8               u8Kind;          // C_BIG_Finite, C_BIG_NaN or C_BIG_Inf
+} tBigFloat;
+
+/** Class Definition: *****************************************************************
+ *    Arbitrary-precision arithmetic for CTerm::s32ExecuteBig. The numbers are        *
+ *    decimal floats, thus the literals and the output are exact, and results are     *
+ *    rounded to the digits of the constructor plus some guard-limbs. Division and    *
+ *    square root are Newton-iterations on the multiplication, the transcendental     *
+ *    functions are Taylor-series after an argument reduction. The constants are      *
+ *    cached for all instances at the highest precision, which was asked for:         */
+
+class CBigMath {
+public:
+    CBigMath(INT32 s32Digits);
+    ~CBigMath();
+    INT32  s32GetDigits(void);
+    void   vFromInt(INT64 s64Value, tBigFloat* pResult);
+    void   vFromUInt(UINT64 u64Value, tBigFloat* pResult);
+    void   vFromDouble(double dValue, tBigFloat* pResult);
+    bool   bParse(const std::wstring& sText, tBigFloat* pResult);
+    bool   bToInt(const tBigFloat& A, INT64* ps64Value);
+    bool   bToMagnitude(const tBigFloat& A, UINT64* pu64Value, bool* pbNeg);
+    bool   bIsZero(const tBigFloat& A);
+    void   vTrunc(const tBigFloat& A, tBigFloat* pResult);
+    void   vAdd(const tBigFloat& A, const tBigFloat& B, tBigFloat* pResult);
+    void   vSub(const tBigFloat& A, const tBigFloat& B, tBigFloat* pResult);
+    void   vMul(const tBigFloat& A, const tBigFloat& B, tBigFloat* pResult);
+    bool   bDiv(const tBigFloat& A, const tBigFloat& B, tBigFloat* pResult);
+    void   vSqrt(const tBigFloat& A, tBigFloat* pResult);
+    void   vPow(const tBigFloat& A, const tBigFloat& B, tBigFloat* pResult);
+    void   vExp(const tBigFloat& A, tBigFloat* pResult);
+    void   vLog(const tBigFloat& A, tBigFloat* pResult);
+    void   vSin(const tBigFloat& A, tBigFloat* pResult);
+    void   vCos(const tBigFloat& A, tBigFloat* pResult);
+    void   vTan(const tBigFloat& A, tBigFloat* pResult);
+    void   vAtan(const tBigFloat& A, tBigFloat* pResult);
+    void   vAsin(const tBigFloat& A, tBigFloat* pResult);
+    void   vAcos(const tBigFloat& A, tBigFloat* pResult);
+    void   vConstant(UINT32 u32Const, tBigFloat* pResult);
+    void   vAppend(const tBigFloat& A, std::wstring* psOutput);
+private:
+    INT32  m_s32Digits;
+    size_t m_uLimbs;
+    void   vSetSpecial(UINT8 u8Kind, bool bNeg, tBigFloat* pResult);
+    void   vRound(tBigFloat* pA);
+    void   vAddSigned(const tBigFloat& A, const tBigFloat& B, bool bFlipB, tBigFloat* pResult);
+    void   vMulSmall(const tBigFloat& A, UINT32 u32Factor, tBigFloat* pResult);
+    void   vDivSmall(const tBigFloat& A, UINT32 u32Divisor, tBigFloat* pResult);
+    void   vScale2(const tBigFloat& A, INT32 s32Power, tBigFloat* pResult);
+    void   vReciprocal(const tBigFloat& A, tBigFloat* pResult);
+    void   vLogNewton(const tBigFloat& A, tBigFloat* pResult);
+    void   vSinCos(const tBigFloat& A, tBigFloat* pSin, tBigFloat* pCos);
+    void   vArctanInv(UINT32 u32Inverse, tBigFloat* pResult);
+    bool   bNegligible(const tBigFloat& Term, const tBigFloat& Sum);
+    double dApprox(const tBigFloat& A, INT64* ps64Exp);
+};
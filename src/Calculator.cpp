@@ -0,0 +1,532 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string>
+#include <algorithm>
+#include <cwctype>
+#include <math.h>
+#include "Term.h"
+#include "TermCache.h"
+#include "TermSymbols.h"
+#include "WorkerPool.h"
+#include "Sweep.h"
+#include "Integrate.h"
+#include "Solver.h"
+#include "NumFormat.h"
+#include "BigFloat.h"
+#include "Calculator.h"
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************/
+
+CCalculator::CCalculator(INT32 s32CacheSize, INT32 s32Precision) : m_Format(s32Precision) {
+    m_pCache    = new CTermCache(s32CacheSize);
+    m_pSymbols  = new CTermSymbols();
+    m_pCache->vSetSymbols(m_pSymbols);
+    m_u32SymbolVersion = m_pSymbols->u32GetVersion();
+    m_pPool     = NULL;
+    m_pOwnCancel = new CCancelToken();
+    m_pCancel   = m_pOwnCancel;
+    m_pBigTerm  = NULL;
+    m_tBudget.u32MaxNodes  = C_TERM_DefMaxNodes;
+    m_tBudget.u32MaxDepth  = C_TERM_DefMaxDepth;
+    m_tBudget.u32TimeLimit = 0;
+    m_bFailed   = false;
+    m_u32Format = C_CALC_FormatAuto;
+}
+
+/** Destructor: ***********************************************************************/
+
+CCalculator::~CCalculator() {
+    if (m_pPool != NULL) delete m_pPool;
+    if (m_pBigTerm != NULL) delete m_pBigTerm;
+    delete m_pOwnCancel;
+    delete m_pCache;
+    delete m_pSymbols;
+}
+
+/** Handler for a mathematical input: *************************************************
+ *    Returns the result-lines, each one terminated by CR/LF:                         */
+
+std::wstring CCalculator::sProcMath(const std::wstring& sInput) {
+    std::wstring sOutput;
+    vProcMath(sInput, &sOutput);
+    return sOutput;
+}
+
+/** Same as sProcMath, but appends to a buffer of the caller. Apart from parsing new  *
+ *  terms, this does not allocate, once the buffers have grown:                       */
+
+void CCalculator::vProcMath(const std::wstring& sInput, std::wstring* psOutput) {
+    /** Variables:                                                                    */
+    bool         bOutputHex = (m_u32Format == C_CALC_FormatHex);
+    bool         bOutputBin = (m_u32Format == C_CALC_FormatBin);
+    double       dOutput;
+    tTermInt     tOutput;
+    INT32        s32Result;
+    CTerm*       pTerm;
+    m_bFailed = false;
+    /** The time limit starts with each input, a shared token is reset by its owner:  */
+    if (m_pCancel == m_pOwnCancel) m_pOwnCancel->vReset();
+    m_pCancel->vSetDeadline(m_tBudget.u32TimeLimit);
+    /** Change the input to lower-case:                                               */
+    m_sInput.assign(sInput);
+    std::transform(m_sInput.begin(), m_sInput.end(), m_sInput.begin(), ::towlower);
+    /** Check for a tabulation over x:                                                */
+    if ((m_sInput.compare(0, 6, L"table(") == 0) && (m_sInput.back() == L')')) {
+        psOutput->append(sProcTable(m_sInput.substr(6, m_sInput.length() - 7)));
+        return;
+    }
+    /** Check for an integration over x:                                              */
+    if ((m_sInput.compare(0, 10, L"integrate(") == 0) && (m_sInput.back() == L')')) {
+        psOutput->append(sProcIntegrate(m_sInput.substr(10, m_sInput.length() - 11)));
+        return;
+    }
+    /** Check for root-finding and minimization:                                      */
+    if ((m_sInput.compare(0, 6, L"solve(") == 0) && (m_sInput.back() == L')')) {
+        psOutput->append(sProcSolve(m_sInput.substr(6, m_sInput.length() - 7)));
+        return;
+    }
+    if ((m_sInput.compare(0, 9, L"minimize(") == 0) && (m_sInput.back() == L')')) {
+        psOutput->append(sProcMinimize(m_sInput.substr(9, m_sInput.length() - 10)));
+        return;
+    }
+    /** Check for an arbitrary precision:                                             */
+    if ((m_sInput.compare(0, 5, L"prec(") == 0) && (m_sInput.back() == L')')) {
+        psOutput->append(sProcPrecise(m_sInput.substr(5, m_sInput.length() - 6)));
+        return;
+    }
+    /** Check for a definition of a variable or function:                             */
+    if (CTermSymbols::bIsDefinition(m_sInput)) {
+        psOutput->append(sProcDefine(m_sInput));
+        return;
+    }
+    /** Check for output-formatting:                                                  */
+    if (m_sInput.compare(0, 4, L"hex(") == 0) {
+        /** It shall be hexadecimal:                                                  */
+        m_sInput.erase(0, 3);
+        bOutputHex = true;
+        bOutputBin = false;
+    }else if (m_sInput.compare(0, 4, L"bin(") == 0) {
+        m_sInput.erase(0, 3);
+        bOutputHex = false;
+        bOutputBin = true;
+    }
+    /** Try to parse it, repeated input is taken from the cache:                      */
+    s32Result = m_pCache->s32Parse(m_sInput, &pTerm);
+    if (s32Result == C_TERM_FuncOK      ) return vFail(L"Results in function!", psOutput);
+    if (s32Result == C_TERM_BudgetExceeded) return vFail(L"Too complex!", psOutput);
+    if (s32Result != C_TERM_NumOK       ) return vFail(L"Parsing Error!", psOutput);
+    /** Integer-terms are calculated exactly, unless they overflow:                   */
+    if (pTerm->bIsInteger() && (pTerm->s32ExecuteInt(&tOutput) == C_TERM_NumOK)) {
+        psOutput->append(L"  = ");
+        if (bOutputHex) {
+            m_Format.vAppendHexInt(tOutput.s64Value, psOutput);
+        }else if (bOutputBin) {
+            m_Format.vAppendBin(tOutput.s64Value, psOutput);
+        }else if (tOutput.bUnsigned) {
+            m_Format.vAppendUInt((UINT64) tOutput.s64Value, psOutput);
+        }else{
+            m_Format.vAppendInt(tOutput.s64Value, psOutput);
+        }
+        psOutput->append(L"\r\n");
+        return;
+    }
+    /** If we got here, the term can be calculated:                                   */
+    s32Result = pTerm->s32Execute(0, &dOutput);
+    if (s32Result == C_TERM_DivByZero   ) return vFail(L"Division by zero!", psOutput);
+    if (s32Result == C_TERM_BoolTooLarge) return vFail(L"Boolean operator too large!", psOutput);
+    /**                                                                               */
+    /** Build up the output, integers in hex and binary as the patterns of & | ~:     */
+    if (bOutputBin) {
+        if (!m_Format.isInteger(dOutput)) return vFail(L"Binary output only supported for integers!", psOutput);
+        if (!CTerm::bToPattern(dOutput, &tOutput)) return vFail(L"Result too large for binary output!", psOutput);
+    }
+    psOutput->append(L"  = ");
+    if (bOutputHex) {
+        /** Build as hex:                                                             */
+        if ((!m_Format.isInteger(dOutput)) || (!CTerm::bToPattern(dOutput, &tOutput))) {
+            m_Format.vAppendHexFloat(dOutput, psOutput);
+        }else{
+            m_Format.vAppendHexInt(tOutput.s64Value, psOutput);
+        }
+    }else if (bOutputBin) {
+        /** Build as binary:                                                          */
+        m_Format.vAppendBin(tOutput.s64Value, psOutput);
+    }else if (m_Format.isInteger(dOutput)) {
+        /** Build as usual integer:                                                   */
+        m_Format.vAppendInt(dOutput, psOutput);
+    }else{
+        /** Build as some kind of float:                                              */
+        m_Format.vAppendFloat(dOutput, psOutput);
+    }
+    psOutput->append(L"\r\n");
+}
+
+/** Set-Function of the output-format of plain inputs, see C_CALC_Format...: **********/
+
+void CCalculator::vSetFormat(UINT32 u32Format) {
+    m_u32Format = u32Format;
+}
+
+/** Set-Function of the token, which stops long calculations. The commands poll it    *
+ *  and end with "Cancelled!", plain terms are too short to need it. Without one,     *
+ *  an own token carries the deadline of the budget:                                  */
+
+void CCalculator::vSetCancel(CCancelToken* pCancel) {
+    m_pCancel = (pCancel != NULL) ? pCancel : m_pOwnCancel;
+}
+
+/** Set-Function of the budget of each input. The parsers reject terms beyond its     *
+ *  nodes or depth with "Too complex!", commands stop at its time limit:              */
+
+void CCalculator::vSetBudget(const tTermBudget& tBudget) {
+    m_tBudget = tBudget;
+    m_pCache->vSetBudget(tBudget);
+    m_pSymbols->vSetBudget(tBudget);
+    if (m_pBigTerm != NULL) m_pBigTerm->vSetBudget(tBudget);
+}
+
+/** Tells, if the last input ended with an error-message: *****************************/
+
+bool CCalculator::bLastFailed(void) {
+    return m_bFailed;
+}
+
+/** Private Functions: ****************************************************************/
+
+/** Handler for the tabulation: *******************************************************
+ *    Evaluates table(expr, x0, x1, step) on the worker-pool. The first rows are      *
+ *    listed, followed by a summary over all points:                                  */
+
+std::wstring CCalculator::sProcTable(const std::wstring& sArgs) {
+    /** Variables:                                                                    */
+    std::vector<std::wstring> Args;
+    std::wstring sOutput;
+    CTerm        TermBound;
+    CTerm*       pTerm;
+    double       adBounds[3];
+    INT32        s32Result;
+    size_t       uIndex;
+    /** Split and check the arguments:                                                */
+    if ((!bSplitArguments(sArgs, &Args)) || (Args.size() != 4)) return sFail(L"Usage: table(expr, x0, x1, step)");
+    TermBound.vSetSymbols(m_pSymbols);
+    TermBound.vSetBudget(m_tBudget);
+    s32Result = m_pCache->s32Parse(Args[0], &pTerm);
+    if (s32Result == C_TERM_BudgetExceeded) return sFail(L"Too complex!");
+    if ((s32Result != C_TERM_NumOK) && (s32Result != C_TERM_FuncOK)) return sFail(L"Parsing Error!");
+    for (uIndex = 0; uIndex < 3; uIndex++) {
+        if (TermBound.s32Parse(Args[uIndex + 1]) != C_TERM_NumOK) return sFail(L"Parsing Error!");
+        if (TermBound.s32Execute(0, &adBounds[uIndex]) != C_TERM_NumOK) return sFail(L"Invalid range!");
+    }
+    /** The pool is only started, when it is needed for the first time:               */
+    if (m_pPool == NULL) m_pPool = new CWorkerPool();
+    CSweep Sweep(m_pPool, m_pCancel);
+    s32Result = Sweep.s32Run(*pTerm, adBounds[0], adBounds[1], adBounds[2]);
+    if (s32Result == C_TERM_Cancelled) return sCancelled();
+    if (s32Result == C_SWEEP_TooManyPoints) return sFail(L"Too many points!");
+    if (s32Result != C_TERM_NumOK) return sFail(L"Invalid range!");
+    /** List the first rows:                                                          */
+    for (uIndex = 0; (uIndex < Sweep.uGetCount()) && (uIndex < C_CALC_TableRows); uIndex++) {
+        switch (Sweep.m_Status[uIndex]) {
+        case C_TERM_NumOK:
+            sOutput += L"  = f(" + m_Format.sOutputNumber(Sweep.dGetX(uIndex)) + L") = " + m_Format.sOutputNumber(Sweep.m_Results[uIndex]) + L"\r\n";
+            break;
+        case C_TERM_DivByZero:
+            sOutput += L"  * f(" + m_Format.sOutputNumber(Sweep.dGetX(uIndex)) + L"): Division by zero!\r\n";
+            break;
+        default:
+            sOutput += L"  * f(" + m_Format.sOutputNumber(Sweep.dGetX(uIndex)) + L"): Boolean operator too large!\r\n";
+            break;
+        }
+    }
+    if (Sweep.uGetCount() > C_CALC_TableRows) {
+        sOutput += L"  * " + std::to_wstring(Sweep.uGetCount() - C_CALC_TableRows) + L" more rows not shown\r\n";
+    }
+    /** And add the summary:                                                          */
+    if (Sweep.m_Summary.uValid == 0) return (sOutput + sFail(L"No valid results!"));
+    sOutput += L"  = min " + m_Format.sOutputNumber(Sweep.m_Summary.dMin) + L" at x = " + m_Format.sOutputNumber(Sweep.m_Summary.dArgMin) +
+               L", max " + m_Format.sOutputNumber(Sweep.m_Summary.dMax) + L" at x = " + m_Format.sOutputNumber(Sweep.m_Summary.dArgMax) +
+               L", sum " + m_Format.sOutputNumber(Sweep.m_Summary.dSum) + L"\r\n";
+    return sOutput;
+}
+
+/** Handler for the integration: ******************************************************
+ *    Evaluates integrate(expr, a, b) on the worker-pool. The result is followed by   *
+ *    its estimated error and the effort:                                             */
+
+std::wstring CCalculator::sProcIntegrate(const std::wstring& sArgs) {
+    /** Variables:                                                                    */
+    std::vector<std::wstring> Args;
+    std::wstring sOutput;
+    CTerm        TermBound;
+    CTerm*       pTerm;
+    double       adBounds[2];
+    INT32        s32Result;
+    size_t       uIndex;
+    /** Split and check the arguments:                                                */
+    if ((!bSplitArguments(sArgs, &Args)) || (Args.size() != 3)) return sFail(L"Usage: integrate(expr, a, b)");
+    TermBound.vSetSymbols(m_pSymbols);
+    TermBound.vSetBudget(m_tBudget);
+    s32Result = m_pCache->s32Parse(Args[0], &pTerm);
+    if (s32Result == C_TERM_BudgetExceeded) return sFail(L"Too complex!");
+    if ((s32Result != C_TERM_NumOK) && (s32Result != C_TERM_FuncOK)) return sFail(L"Parsing Error!");
+    for (uIndex = 0; uIndex < 2; uIndex++) {
+        if (TermBound.s32Parse(Args[uIndex + 1]) != C_TERM_NumOK) return sFail(L"Parsing Error!");
+        if (TermBound.s32Execute(0, &adBounds[uIndex]) != C_TERM_NumOK) return sFail(L"Invalid range!");
+    }
+    /** The pool is only started, when it is needed for the first time:               */
+    if (m_pPool == NULL) m_pPool = new CWorkerPool();
+    CIntegrate Integrate(m_pPool, m_pCancel);
+    s32Result = Integrate.s32Run(*pTerm, adBounds[0], adBounds[1]);
+    if (s32Result == C_TERM_Cancelled) return sCancelled();
+    if (s32Result == C_INTEG_InvalidRange) return sFail(L"Invalid range!");
+    if (s32Result == C_INTEG_NotIntegrable) return sFail(L"Not integrable at x = " + m_Format.sOutputNumber(Integrate.m_dFailX) + L"!");
+    /** The result and how good it is:                                                */
+    sOutput  = L"  = " + m_Format.sOutputNumber(Integrate.m_dResult) + L"\r\n";
+    sOutput += L"  = error " + m_Format.sOutputNumber(Integrate.m_dError) + L" from " + std::to_wstring(Integrate.m_uIntervals) +
+               L" intervals, " + std::to_wstring(Integrate.uGetPoints()) + L" points\r\n";
+    if (!Integrate.m_bConverged) sOutput += L"  * Accuracy not reached, the error is an estimate only\r\n";
+    return sOutput;
+}
+
+/** Handler for the root-finding: *****************************************************
+ *    Solves solve(expr, x0) for expr = 0 by Newton-iteration from x0, with the       *
+ *    derivatives of the dual-executor:                                               */
+
+std::wstring CCalculator::sProcSolve(const std::wstring& sArgs) {
+    /** Variables:                                                                    */
+    std::vector<std::wstring> Args;
+    CTerm        TermStart;
+    CTerm*       pTerm;
+    double       dX0;
+    INT32        s32Result;
+    /** Split and check the arguments:                                                */
+    if ((!bSplitArguments(sArgs, &Args)) || (Args.size() != 2)) return sFail(L"Usage: solve(expr, x0)");
+    TermStart.vSetSymbols(m_pSymbols);
+    TermStart.vSetBudget(m_tBudget);
+    s32Result = m_pCache->s32Parse(Args[0], &pTerm);
+    if (s32Result == C_TERM_BudgetExceeded) return sFail(L"Too complex!");
+    if ((s32Result != C_TERM_NumOK) && (s32Result != C_TERM_FuncOK)) return sFail(L"Parsing Error!");
+    if (TermStart.s32Parse(Args[1]) != C_TERM_NumOK) return sFail(L"Parsing Error!");
+    if (TermStart.s32Execute(0, &dX0) != C_TERM_NumOK) return sFail(L"Invalid start!");
+    /** Solve it:                                                                     */
+    CSolver Solver(pTerm, m_pCancel);
+    s32Result = Solver.s32Solve(dX0);
+    if ((m_pCancel != NULL) && m_pCancel->bIsCancelled()) return sCancelled();
+    if (s32Result != C_TERM_NumOK) return sFail(L"No root found!");
+    return L"  = x = " + m_Format.sOutputNumber(Solver.m_dX) + L" (f(x) = " + m_Format.sOutputNumber(Solver.m_dY) + L", " +
+           std::to_wstring(Solver.m_u32Evals) + L" evaluations)\r\n";
+}
+
+/** Handler for the minimization: *****************************************************
+ *    Finds the global minimum of minimize(expr, a, b) within the closed range:       */
+
+std::wstring CCalculator::sProcMinimize(const std::wstring& sArgs) {
+    /** Variables:                                                                    */
+    std::vector<std::wstring> Args;
+    CTerm        TermBound;
+    CTerm*       pTerm;
+    double       adBounds[2];
+    INT32        s32Result;
+    size_t       uIndex;
+    /** Split and check the arguments:                                                */
+    if ((!bSplitArguments(sArgs, &Args)) || (Args.size() != 3)) return sFail(L"Usage: minimize(expr, a, b)");
+    TermBound.vSetSymbols(m_pSymbols);
+    TermBound.vSetBudget(m_tBudget);
+    s32Result = m_pCache->s32Parse(Args[0], &pTerm);
+    if (s32Result == C_TERM_BudgetExceeded) return sFail(L"Too complex!");
+    if ((s32Result != C_TERM_NumOK) && (s32Result != C_TERM_FuncOK)) return sFail(L"Parsing Error!");
+    for (uIndex = 0; uIndex < 2; uIndex++) {
+        if (TermBound.s32Parse(Args[uIndex + 1]) != C_TERM_NumOK) return sFail(L"Parsing Error!");
+        if (TermBound.s32Execute(0, &adBounds[uIndex]) != C_TERM_NumOK) return sFail(L"Invalid range!");
+    }
+    /** Minimize it:                                                                  */
+    CSolver Solver(pTerm, m_pCancel);
+    s32Result = Solver.s32Minimize(adBounds[0], adBounds[1]);
+    if ((m_pCancel != NULL) && m_pCancel->bIsCancelled()) return sCancelled();
+    if (s32Result != C_TERM_NumOK) return sFail(L"No minimum found!");
+    return L"  = min " + m_Format.sOutputNumber(Solver.m_dY) + L" at x = " + m_Format.sOutputNumber(Solver.m_dX) + L" (" +
+           std::to_wstring(Solver.m_u32Evals) + L" evaluations)\r\n";
+}
+
+/** Handler for the definitions: ******************************************************
+ *    Defines name = expr or name(a, b) = expr. The value of a variable is followed   *
+ *    by the ones of the variables, which depend on it and were calculated again:     */
+
+std::wstring CCalculator::sProcDefine(const std::wstring& sInput) {
+    /** Variables:                                                                    */
+    std::vector<UINT32> Updated;
+    std::wstring        sOutput;
+    const tTermSymbol*  pSymbol;
+    UINT32              u32Symbol;
+    INT32               s32Result;
+    size_t              uIndex;
+    s32Result = m_pSymbols->s32Define(sInput, &u32Symbol, &Updated);
+    /** Cached terms may refer to outdated names or function-bodies:                  */
+    if (m_pSymbols->u32GetVersion() != m_u32SymbolVersion) {
+        m_pCache->vClear();
+        m_u32SymbolVersion = m_pSymbols->u32GetVersion();
+    }
+    if (s32Result == C_SYM_InvalidName  ) return sFail(L"Invalid name!");
+    if (s32Result == C_SYM_NameInUse    ) return sFail(L"Name already in use!");
+    if (s32Result == C_SYM_Circular     ) return sFail(L"Circular definition!");
+    if (s32Result == C_TERM_FuncOK      ) return sFail(L"Results in function!");
+    if (s32Result == C_TERM_DivByZero   ) return sFail(L"Division by zero!");
+    if (s32Result == C_TERM_BoolTooLarge) return sFail(L"Boolean operator too large!");
+    if (s32Result == C_TERM_BudgetExceeded) return sFail(L"Too complex!");
+    if (s32Result != C_TERM_NumOK       ) return sFail(L"Parsing Error!");
+    pSymbol = m_pSymbols->pGetSymbol(u32Symbol);
+    if (pSymbol->bFunction) {
+        sOutput = L"  = " + pSymbol->sName + L"(";
+        for (uIndex = 0; uIndex < pSymbol->Arguments.size(); uIndex++) {
+            if (uIndex > 0) sOutput += L", ";
+            sOutput += pSymbol->Arguments[uIndex];
+        }
+        sOutput += L") defined\r\n";
+    }else{
+        sOutput = L"  = " + sOutputVariable(u32Symbol) + L"\r\n";
+    }
+    /** The variables, which changed along with it:                                   */
+    for (UINT32 u32Updated : Updated) {
+        pSymbol = m_pSymbols->pGetSymbol(u32Updated);
+        switch (pSymbol->s32Status) {
+        case C_TERM_NumOK:
+            sOutput += L"  = " + pSymbol->sName + L" = " + sOutputVariable(u32Updated) + L"\r\n";
+            break;
+        case C_TERM_FuncOK:
+            sOutput += L"  * " + pSymbol->sName + L": Results in function!\r\n";
+            break;
+        case C_TERM_DivByZero:
+            sOutput += L"  * " + pSymbol->sName + L": Division by zero!\r\n";
+            break;
+        case C_TERM_BoolTooLarge:
+            sOutput += L"  * " + pSymbol->sName + L": Boolean operator too large!\r\n";
+            break;
+        case C_TERM_BudgetExceeded:
+            sOutput += L"  * " + pSymbol->sName + L": Too complex!\r\n";
+            break;
+        default:
+            sOutput += L"  * " + pSymbol->sName + L": Parsing Error!\r\n";
+            break;
+        }
+    }
+    return sOutput;
+}
+
+/** Handler for an arbitrary precision: ***********************************************
+ *    Evaluates prec(digits, expr) with CBigMath. This bypasses the term-cache and    *
+ *    the double-executors, which stay the fast path of all other inputs:             */
+
+std::wstring CCalculator::sProcPrecise(const std::wstring& sArgs) {
+    /** Variables:                                                                    */
+    std::vector<std::wstring> Args;
+    std::wstring sOutput;
+    CTerm        TermDigits;
+    tBigFloat    tOutput;
+    double       dDigits;
+    INT32        s32Result;
+    /** Split and check the arguments:                                                */
+    if ((!bSplitArguments(sArgs, &Args)) || (Args.size() != 2)) return sFail(L"Usage: prec(digits, expr)");
+    TermDigits.vSetSymbols(m_pSymbols);
+    TermDigits.vSetBudget(m_tBudget);
+    if (TermDigits.s32Parse(Args[0]) != C_TERM_NumOK) return sFail(L"Parsing Error!");
+    if (TermDigits.s32Execute(0, &dDigits) != C_TERM_NumOK) return sFail(L"Invalid precision!");
+    if ((!m_Format.isInteger(dDigits)) || (dDigits < 1) || (dDigits > C_BIG_MaxDigits)) return sFail(L"Invalid precision!");
+    /** The term keeps its literals as text, thus it does not go into the cache:      */
+    if (m_pBigTerm == NULL) {
+        m_pBigTerm = new CTerm();
+        m_pBigTerm->vSetBig(true);
+        m_pBigTerm->vSetSymbols(m_pSymbols);
+        m_pBigTerm->vSetBudget(m_tBudget);
+    }
+    s32Result = m_pBigTerm->s32Parse(Args[1]);
+    if (s32Result == C_TERM_FuncOK) return sFail(L"Results in function!");
+    if (s32Result == C_TERM_BudgetExceeded) return sFail(L"Too complex!");
+    if (s32Result != C_TERM_NumOK ) return sFail(L"Parsing Error!");
+    /** Calculate it:                                                                 */
+    CBigMath Math((INT32) dDigits);
+    s32Result = m_pBigTerm->s32ExecuteBig(&Math, &tOutput, m_pCancel);
+    if (s32Result == C_TERM_Cancelled   ) return sCancelled();
+    if (s32Result == C_TERM_DivByZero   ) return sFail(L"Division by zero!");
+    if (s32Result == C_TERM_BoolTooLarge) return sFail(L"Boolean operator too large!");
+    if (s32Result != C_TERM_NumOK       ) return sFail(L"Parsing Error!");
+    sOutput = L"  = ";
+    Math.vAppend(tOutput, &sOutput);
+    sOutput += L"\r\n";
+    return sOutput;
+}
+
+/** Formats the value of a variable, integer-typed ones exactly like vProcMath: *******/
+
+std::wstring CCalculator::sOutputVariable(UINT32 u32Symbol) {
+    /** Variables:                                                                    */
+    std::wstring sOutput;
+    tTermInt     tValue;
+    if (!m_pSymbols->bGetInteger(u32Symbol, &tValue)) return m_Format.sOutputNumber(m_pSymbols->dGetValue(u32Symbol));
+    if (tValue.bUnsigned) m_Format.vAppendUInt((UINT64) tValue.s64Value, &sOutput);
+    else m_Format.vAppendInt(tValue.s64Value, &sOutput);
+    return sOutput;
+}
+
+/** Builds an error-line and remembers the failure: ***********************************/
+
+std::wstring CCalculator::sFail(const std::wstring& sMessage) {
+    std::wstring sOutput;
+    vFail(sMessage.c_str(), &sOutput);
+    return sOutput;
+}
+
+/** Builds the error-line of a stopped command, which tells a cancel by the user      *
+ *  from the time limit:                                                              */
+
+std::wstring CCalculator::sCancelled(void) {
+    if (m_pCancel->bIsExpired()) return sFail(L"Time limit exceeded!");
+    return sFail(L"Cancelled!");
+}
+
+void CCalculator::vFail(const WCHAR* pszMessage, std::wstring* psOutput) {
+    m_bFailed = true;
+    psOutput->append(L"  * ");
+    psOutput->append(pszMessage);
+    psOutput->append(L"\r\n");
+}
+
+/** Splits comma-separated arguments, ignoring commas within brackets: ****************/
+
+bool CCalculator::bSplitArguments(const std::wstring& sInput, std::vector<std::wstring>* pArgs) {
+    size_t uPos;
+    size_t uStart = 0;
+    int    iLvl   = 0;
+    pArgs->clear();
+    for (uPos = 0; uPos < sInput.length(); uPos++) {
+        if (sInput[uPos] == L'(') iLvl++;
+        if (sInput[uPos] == L')') iLvl--;
+        if (iLvl < 0) return false;
+        if ((sInput[uPos] == L',') && (iLvl == 0)) {
+            pArgs->push_back(sInput.substr(uStart, uPos - uStart));
+            uStart = uPos + 1;
+        }
+    }
+    pArgs->push_back(sInput.substr(uStart));
+    return (iLvl == 0);
+}
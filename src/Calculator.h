@@ -0,0 +1,76 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#define C_CALC_TableRows   100
+
+#define C_CALC_FormatAuto  0x00         // Integer or float, whatever fits
+#define C_CALC_FormatHex   0x01         // As if each input was wrapped in hex()
+#define C_CALC_FormatBin   0x02         // As if each input was wrapped in bin()
+
+/** Class Definition: *****************************************************************
+ *    The platform-independent part of the command handling. It turns one line of    *
+ *    input into the lines of its result, as shown by the GUI and the CLI:            */
+
+class CTerm;
+class CTermCache;
+class CTermSymbols;
+class CWorkerPool;
+class CCancelToken;
+
+class CCalculator {
+public:
+    CNumFormat   m_Format;
+    CCalculator(INT32 s32CacheSize, INT32 s32Precision);
+    ~CCalculator();
+    std::wstring sProcMath(const std::wstring& sInput);
+    void         vProcMath(const std::wstring& sInput, std::wstring* psOutput);
+    void         vSetFormat(UINT32 u32Format);
+    void         vSetCancel(CCancelToken* pCancel);
+    void         vSetBudget(const tTermBudget& tBudget);
+    bool         bLastFailed(void);
+private:
+    CTermCache*  m_pCache;
+    CTermSymbols* m_pSymbols;
+    UINT32       m_u32SymbolVersion;
+    CWorkerPool* m_pPool;
+    CCancelToken* m_pCancel;
+    CCancelToken* m_pOwnCancel;
+    tTermBudget  m_tBudget;
+    CTerm*       m_pBigTerm;
+    bool         m_bFailed;
+    UINT32       m_u32Format;
+    std::wstring m_sInput;
+    std::wstring sProcTable(const std::wstring& sArgs);
+    std::wstring sProcIntegrate(const std::wstring& sArgs);
+    std::wstring sProcSolve(const std::wstring& sArgs);
+    std::wstring sProcMinimize(const std::wstring& sArgs);
+    std::wstring sProcDefine(const std::wstring& sInput);
+    std::wstring sProcPrecise(const std::wstring& sArgs);
+    std::wstring sFail(const std::wstring& sMessage);
+    std::wstring sCancelled(void);
+    std::wstring sOutputVariable(UINT32 u32Symbol);
+    void         vFail(const WCHAR* pszMessage, std::wstring* psOutput);
+    bool         bSplitArguments(const std::wstring& sInput, std::vector<std::wstring>* pArgs);
+};
@@ -26,6 +26,10 @@
 #include <Richedit.h>
 #include "ConfigHandler.h"
 #include "Term.h"
+#include "NumFormat.h"
+#include "Calculator.h"
+#include "History.h"
+#include "WorkerPool.h"
 #include "CommandHandler.h"
 
 /** Compiler Settings: ****************************************************************/
@@ -39,31 +43,46 @@
 /** Constructor: **********************************************************************/
 
 CCommandHandler::CCommandHandler(CConfigHandler* Config) {
-    m_pConfig = Config;
+    /** Variables:                                                                    */
+    tTermBudget tBudget;
+    m_pConfig      = Config;
+    m_pCalc        = new CCalculator(Config->iCacheSize, Config->iPrecision);
+    m_pHistory     = new CHistory(Config->iLines);
+    m_pCancel      = new CCancelToken();
+    m_pCalc->vSetCancel(m_pCancel);
+    tBudget.u32MaxNodes  = (UINT32) Config->iMaxNodes;
+    tBudget.u32MaxDepth  = (UINT32) Config->iMaxDepth;
+    tBudget.u32TimeLimit = (UINT32) Config->iTimeLimit;
+    m_pCalc->vSetBudget(tBudget);
+    m_u64RecallPos = 0;
+    m_hMain        = NULL;
+    m_bBusy        = false;
+    m_bStop        = false;
 }
 
 /** Destructor: ***********************************************************************/
 
 CCommandHandler::~CCommandHandler() {
+    vStopWorker();
+    delete m_pCalc;
+    delete m_pHistory;
+    delete m_pCancel;
 }
 
-/** Tiny function to store a pointer to the info-text: ********************************/
+/** Tiny function to store the info-text: *********************************************/
 
-void CCommandHandler::vSetInfoText(WCHAR* pszwTextPtr) {
-    this->m_pszwInfoText = pszwTextPtr;
+void CCommandHandler::vSetInfoText(const std::wstring& sText) {
+    m_sInfoText = sText;
 }
 
 /** Set-function, which adds the info-text if there's empty input: ********************/
 
 void CCommandHandler::vSetText(HWND hEditBox, const WCHAR* pszwNewText) {
-    TCHAR  buffer[C_TEXTBUFSIZE];
     DWORD  dwIndex;
-    if (pszwNewText[0] != L'\0') {
-        wcscpy(buffer, pszwNewText);
-    } else {
-        wcscpy(buffer, m_pszwInfoText);
-    }
-    SetWindowText(hEditBox, buffer);
+    if (pszwNewText[0] == L'\0') pszwNewText = m_sInfoText.c_str();
+    SetWindowText(hEditBox, pszwNewText);
+    /** The inputs of the former session can be recalled again:                       */
+    m_pHistory->vLoad(pszwNewText);
     /** Set the selection at its end:                                                 */
     dwIndex = GetWindowTextLength(hEditBox);
     SendMessage(hEditBox, EM_SETSEL, dwIndex, dwIndex);
@@ -73,353 +92,307 @@ void CCommandHandler::vSetText(HWND hEditBox, const WCHAR* pszwNewText) {
     vColorizeText(hEditBox);
 }
 
-
-
-/** Handler for a command to be executed: *********************************************/
-
+/** Handler for a command to be executed: *********************************************
+ *    The commands of the GUI are done at once, everything else is queued for the     *
+ *    worker. The input-line is cleared, so that the next one can be typed, while     *
+ *    the worker is busy. vProcResults echoes the input along with its result:        */
 
 void CCommandHandler::vProcEnter(HWND hMain, HWND hEditBox) {
-    // Get current line index (line with caret)
-    DWORD dwIndex;
-    CHARRANGE cr;
-    CHARFORMAT2W cfDef = { sizeof(CHARFORMAT2W) };
-    std::wstring sInput;
-    std::wstring sFullOutput;
-    
-    DWORD dwLineIndex = SendMessage(hEditBox, EM_LINEINDEX, -1, 0);
-    // Get length of text
-    DWORD dwTextLen = GetWindowTextLength(hEditBox);
-    
-    // Get text from this line only?
-    // Get everything from dwLineIndex to end
-    dwIndex = dwTextLen - dwLineIndex;
-    if (dwIndex <= 2) return; // Only prompt or empty
-    
-    WCHAR* pszBuff = new WCHAR[dwIndex + 1];
-    TEXTRANGEW tr;
-    tr.chrg.cpMin = dwLineIndex;
-    tr.chrg.cpMax = dwTextLen;
-    tr.lpstrText = pszBuff;
-    SendMessage(hEditBox, EM_GETTEXTRANGE, 0, (LPARAM)&tr);
-    // Null terminate manually just in case
-    // Note: cpMax - cpMin is length.
-    // EM_GETTEXTRANGE needs buffer of size (cpMax - cpMin + 1)
-    
-    sInput = pszBuff;
-    delete[] pszBuff;
-    
-    // Check prompt
-    if (sInput.substr(0, 2) != L"> ") return;
-    
-    // Strip prompt
-    sInput = sInput.substr(2);
-    // Trim newlines from end if any (user pressed Enter, so there shouldn't be valid ones, but...)
-    while (!sInput.empty() && (sInput.back() == L'\r' || sInput.back() == L'\n')) {
-        sInput.pop_back();
+    /** Variables:                                                                    */
+    tCalcJob tJob;
+    DWORD    dwIndex;
+    /** Fetch the input-line and check its prompt:                                    */
+    vGetText(hEditBox, m_dwEditLastLF, &m_sLine);
+    if ((m_sLine.length() <= 2) || (m_sLine.compare(0, 2, L"> ") != 0)) return;
+    tJob.sInput.assign(m_sLine, 2, std::wstring::npos);
+    while (!tJob.sInput.empty() && ((tJob.sInput.back() == L'\r') || (tJob.sInput.back() == L'\n'))) tJob.sInput.pop_back();
+    tJob.bFailed = false;
+    /** Commands:                                                                     */
+    if (tJob.sInput == L"exit") {
+        SendMessage(hMain, WM_DESTROY, 0, 0);
+        return;
+    }
+    if (tJob.sInput == L"clear") {
+        SetWindowText(hEditBox, L"> ");
+        m_dwEditLastLF = 0;
+        dwIndex = 2;
+        SendMessage(hEditBox, EM_SETSEL, dwIndex, dwIndex);
+        return;
     }
+    if (tJob.sInput == L"help") {
+        ShellExecute(NULL, L"open", L"PeaCalc.html", NULL, NULL, SW_SHOW);
+        /** Just append a new prompt:                                                 */
+        SendMessage(hEditBox, EM_SETSEL, -1, -1);
+        SendMessage(hEditBox, EM_REPLACESEL, 0, (LPARAM)L"\r\n> ");
+        SendMessage(hEditBox, EM_SETSEL, -1, -1);
+        m_dwEditLastLF = SendMessage(hEditBox, EM_LINEINDEX, -1, 0);
+        return;
+    }
+    /** Clear the input behind the prompt:                                            */
+    SendMessage(hEditBox, EM_SETSEL, m_dwEditLastLF + 2, -1);
+    SendMessage(hEditBox, EM_REPLACESEL, 0, (LPARAM)L"");
+    /** Queue it, the worker is started with the first input:                         */
+    {
+        std::unique_lock<std::mutex> Guard(m_Lock);
+        if (!m_Worker.joinable() && !m_bStop) {
+            m_hMain  = hMain;
+            m_Worker = std::thread(&CCommandHandler::vWorker, this);
+        }
+        m_Requests.push_back(tJob);
+    }
+    m_JobReady.notify_one();
+    /** The title shows the progress, as long as there's work left:                   */
+    SetTimer(hMain, C_TIMER_Progress, C_PROGRESS_Interval, NULL);
+}
+
+/** Handler for WM_CALCDONE: **********************************************************
+ *    Inserts the finished inputs with their results in front of the input-line, so   *
+ *    that what is typed there is kept. Each block gets its colors, and the oldest    *
+ *    lines are removed, once there are too many:                                     */
 
-    // Commands
-    if (sInput == L"exit") {
-         SendMessage(hMain, WM_DESTROY, 0, 0);
-         return;
-    } else if (sInput == L"clear") {
-         SetWindowText(hEditBox, L"> ");
-         m_dwEditLastLF = 0;
-         dwIndex = 2;
-         SendMessage(hEditBox, EM_SETSEL, dwIndex, dwIndex);
-         return;
-    } else if (sInput == L"help") {
-         ShellExecute(NULL, L"open", L"PeaCalc.html", NULL, NULL, SW_SHOW);
-         // Just append new prompt
-         SendMessage(hEditBox, EM_SETSEL, -1, -1);
-         SendMessage(hEditBox, EM_REPLACESEL, 0, (LPARAM)L"\r\n> ");
-         SendMessage(hEditBox, EM_SETSEL, -1, -1); // Move to absolute end
-         m_dwEditLastLF = SendMessage(hEditBox, EM_LINEINDEX, -1, 0);
-         return;
-    } 
-
-    // Math Processing
-    sFullOutput = vProcMath(sInput);
-    
-    // Prepare Defaults for Color
-    cfDef.dwMask = CFM_COLOR;
-    DWORD cBg, cTxt, cRes;
+void CCommandHandler::vProcResults(HWND hEditBox) {
+    /** Variables:                                                                    */
+    std::deque<tCalcJob> Done;
+    std::wstring         sBlock;
+    CHARFORMAT2W         cfDef = { sizeof(CHARFORMAT2W) };
+    CHARRANGE            crSel, crNew;
+    DWORD                cBg, cTxt, cRes;
+    DWORD                dwEventMask, dwLineCount, dwCut, dwShift;
+    {
+        std::unique_lock<std::mutex> Guard(m_Lock);
+        Done.swap(m_Results);
+    }
+    if (Done.empty()) return;
     m_pConfig->vGetColors(cBg, cTxt, cRes);
+    cfDef.dwMask      = CFM_COLOR;
     cfDef.crTextColor = cTxt;
-
-    // Replace the LAST PARAGRAPH with the new output
-    // Use EM_SETSEL for simplicity and reliability
-    SendMessage(hEditBox, EM_SETSEL, dwLineIndex, -1);
-    
-    // Set default format for the new block
-    SendMessage(hEditBox, EM_SETCHARFORMAT, SCF_SELECTION, (LPARAM)&cfDef); 
-    // Replace
-    SendMessage(hEditBox, EM_REPLACESEL, 0, (LPARAM)sFullOutput.c_str());
-    
-    // Scroll
-    SendMessage(hEditBox, EM_SCROLLCARET, 0, 0);
-    
-    // Limit lines logic
-    // Get new line count (Visual count is fine for limiting total output)
-    DWORD dwLineCount = SendMessage(hEditBox, EM_GETLINECOUNT, 0, 0);
-    if (dwLineCount > (DWORD)m_pConfig->iLines) {
-        // Delete top lines
-        DWORD dwLinesToRemove = dwLineCount - m_pConfig->iLines;
-        DWORD dwEndChar = SendMessage(hEditBox, EM_LINEINDEX, dwLinesToRemove, 0);
-        cr.cpMin = 0;
-        cr.cpMax = dwEndChar;
-        SendMessage(hEditBox, EM_EXSETSEL, 0, (LPARAM)&cr);
+    /** All changes are painted at once, when they are done:                          */
+    SendMessage(hEditBox, EM_EXGETSEL, 0, (LPARAM)&crSel);
+    dwEventMask = dwSuspendRedraw(hEditBox);
+    for (const tCalcJob& tJob : Done) {
+        m_pHistory->vAdd(tJob.sInput, tJob.sResult, tJob.bFailed);
+        sBlock = L"  " + tJob.sInput + L"\r\n" + tJob.sResult;
+        SendMessage(hEditBox, EM_SETSEL, m_dwEditLastLF, m_dwEditLastLF);
+        SendMessage(hEditBox, EM_SETCHARFORMAT, SCF_SELECTION, (LPARAM)&cfDef);
+        SendMessage(hEditBox, EM_REPLACESEL, 0, (LPARAM)sBlock.c_str());
+        /** The caret is behind the block now, the selection moves along with it:     */
+        SendMessage(hEditBox, EM_EXGETSEL, 0, (LPARAM)&crNew);
+        dwShift = (DWORD) crNew.cpMax - m_dwEditLastLF;
+        if ((DWORD) crSel.cpMin >= m_dwEditLastLF) crSel.cpMin += (LONG) dwShift;
+        if ((DWORD) crSel.cpMax >= m_dwEditLastLF) crSel.cpMax += (LONG) dwShift;
+        vColorizeBlock(hEditBox, m_dwEditLastLF, sBlock);
+        m_dwEditLastLF += dwShift;
+    }
+    /** Limit the lines, but never cut into the input-line:                           */
+    dwLineCount = SendMessage(hEditBox, EM_GETLINECOUNT, 0, 0);
+    if (dwLineCount > (DWORD) m_pConfig->iLines) {
+        dwCut = std::min((DWORD) SendMessage(hEditBox, EM_LINEINDEX, dwLineCount - m_pConfig->iLines, 0), m_dwEditLastLF);
+        SendMessage(hEditBox, EM_SETSEL, 0, dwCut);
         SendMessage(hEditBox, EM_REPLACESEL, 0, (LPARAM)L"");
+        m_dwEditLastLF -= dwCut;
+        crSel.cpMin = ((DWORD) crSel.cpMin > dwCut) ? (crSel.cpMin - (LONG) dwCut) : 0;
+        crSel.cpMax = ((DWORD) crSel.cpMax > dwCut) ? (crSel.cpMax - (LONG) dwCut) : 0;
     }
-
-    // Apply Colors Globaly
-    vColorizeText(hEditBox);
-
-    // Store cursor
-    m_dwEditLastLF = SendMessage(hEditBox, EM_LINEINDEX, -1, 0);
+    /** Restore the selection, paint and scroll:                                      */
+    SendMessage(hEditBox, EM_EXSETSEL, 0, (LPARAM)&crSel);
+    vResumeRedraw(hEditBox, dwEventMask);
+    SendMessage(hEditBox, EM_SCROLLCARET, 0, 0);
 }
 
-/** Handler for a mathematical input: *************************************************/
+/** Handler for TAB: ******************************************************************
+ *    Replaces the input-line by the next older input of the history (or the next     *
+ *    newer one with bNewer), which starts with the text typed before the first TAB.  *
+ *    Nothing changes, when there is no further match:                                */
 
-std::wstring CCommandHandler::vProcMath(std::wstring sInput) {
+void CCommandHandler::vProcTab(HWND hEditBox, bool bNewer, bool bRestart) {
     /** Variables:                                                                    */
-    std::wstring sOutput;
-    bool         bOutputHex = false;
-    bool         bOutputBin = false;
-    double       dOutput;
-    INT32        s32Result;
-    /** Save the input in the output-string:                                          */
-    sOutput = L"  " + sInput + L"\r\n";
-    /** Change the input to lower-case:                                               */
-    std::transform(sInput.begin(), sInput.end(), sInput.begin(), ::tolower);
-    /** Check for output-formatting:                                                  */
-    if (sInput.substr(0,4) == L"hex(") {
-        /** It shall be hexadecimal:                                                  */
-        sInput = sInput.substr(3);
-        bOutputHex = true;
-    }else if (sInput.substr(0, 4) == L"bin(") {
-        sInput = sInput.substr(3);
-        bOutputBin = true;
-    }
-    /** Try to parse it:                                                              */
-    s32Result = m_TermMain.s32Parse(sInput);
-    if (s32Result == C_TERM_FuncOK      ) return (sOutput + L"  * Results in function!\r\n> ");
-    if (s32Result != C_TERM_NumOK       ) return (sOutput + L"  * Parsing Error!\r\n> ");
-    /** If we got here, the term can be calculated:                                   */
-    s32Result = m_TermMain.s32Execute(0, &dOutput);
-    if (s32Result == C_TERM_DivByZero   ) return (sOutput + L"  * Division by zero!\r\n> ");
-    if (s32Result == C_TERM_BoolTooLarge) return (sOutput + L"  * Boolean operator too large!\r\n> ");
-    /**                                                                               */
-    /** Build up the output:                                                          */
-    if (bOutputHex) {
-        /** Build as hex:                                                             */
-        if ((!isInteger(dOutput)) || (dOutput >= C_TERM_MAXINT)) {
-            sOutput += L"  = " + sOutputHexFloat(dOutput) + L"\r\n> ";
-        } else {
-            sOutput += L"  = " + sOutputHexInt(dOutput) + L"\r\n> ";
-        }
-        return sOutput;
-    }else if (bOutputBin) {
-        /** Build as binary:                                                        */
-        if (!isInteger(dOutput)) return (sOutput + L"  * Binary output only supported for integers!\r\n> ");
-        if (dOutput >= C_TERM_MAXINT) return (sOutput + L"  * Result too large for binary output!\r\n> ");
-        sOutput += L"  = " + sOutputBin(dOutput) + L"\r\n> ";
-        return sOutput;
-    }else if (isInteger(dOutput)) {
-        /** Build as usual integer:                                                   */
-        sOutput += L"  = " + sOutputInt(dOutput) + L"\r\n> ";
-        return sOutput;
+    const tHistoryEntry* pEntry;
+    UINT64               u64Serial;
+    DWORD                dwLen;
+    /** A new recall takes the typed text as prefix and starts behind the newest:     */
+    if (bRestart) {
+        vGetText(hEditBox, m_dwEditLastLF + 2, &m_sRecallPrefix);
+        m_u64RecallPos = m_pHistory->u64GetEnd();
     }
-    /** Build as some kind of float:                                                  */
-    sOutput += L"  = " + sOutputFloat(dOutput) + L"\r\n> ";
-    return sOutput;
+    /** Look up the next match:                                                       */
+    u64Serial = m_pHistory->u64Find(m_sRecallPrefix, m_u64RecallPos, bNewer);
+    if (u64Serial == C_HIST_NoEntry) return;
+    pEntry = m_pHistory->pGetEntry(u64Serial);
+    m_u64RecallPos = u64Serial;
+    /** Replace only the input-line, thus the colors of the results are kept:         */
+    SendMessage(hEditBox, EM_SETSEL, m_dwEditLastLF + 2, -1);
+    SendMessage(hEditBox, EM_REPLACESEL, 0, (LPARAM)pEntry->sInput.c_str());
+    dwLen = GetWindowTextLength(hEditBox);
+    SendMessage(hEditBox, EM_SETSEL, dwLen, dwLen);
+    SendMessage(hEditBox, EM_SCROLLCARET, 0, 0);
 }
 
-/** Small support-function to scan for CRs: *******************************************/
+/** Handler for ESC: ******************************************************************
+ *    Stops the running calculation at its next check, and drops the queued ones.     *
+ *    Each of them still gets its block, which tells that it was cancelled:           */
 
-DWORD CCommandHandler::dwFindNthLastCR(const WCHAR* pszwInput, int iCount) {
-    DWORD dwPos = wcslen(pszwInput);
-    while ((dwPos > 0) && (iCount>0)) {
-        dwPos--;
-        if (pszwInput[dwPos] == L'\n') iCount--;
+void CCommandHandler::vCancel(void) {
+    /** Variables:                                                                    */
+    bool bDropped;
+    {
+        std::unique_lock<std::mutex> Guard(m_Lock);
+        m_pCancel->vCancel();
+        bDropped = !m_Requests.empty();
+        for (tCalcJob& tJob : m_Requests) {
+            tJob.sResult = L"  * Cancelled!\r\n";
+            tJob.bFailed = true;
+            m_Results.push_back(tJob);
+        }
+        m_Requests.clear();
     }
-    return dwPos;
+    if (bDropped) PostMessage(m_hMain, WM_CALCDONE, 0, 0);
 }
 
-/** Formats an output as hex-int: *****************************************************/
+/** Tells, if the worker is busy, and describes its progress for the title: ***********/
 
-std::wstring CCommandHandler::sOutputHexInt(double dInput) {
-    WCHAR szwNumBuf[40];
-    INT64 s64Temp = (INT64) dInput;
-    swprintf(szwNumBuf, L"0x%I64X", s64Temp);
-    return std::wstring(szwNumBuf);
+bool CCommandHandler::bGetStatus(std::wstring* psStatus) {
+    /** Variables:                                                                    */
+    UINT32 u32Progress;
+    std::unique_lock<std::mutex> Guard(m_Lock);
+    psStatus->clear();
+    if (!m_bBusy && m_Requests.empty()) return false;
+    psStatus->assign(L" - calculating");
+    u32Progress = m_pCancel->u32GetProgress();
+    if (m_bBusy && (u32Progress != C_CANCEL_NoProgress)) psStatus->append(L" " + std::to_wstring(u32Progress / 10) + L"%");
+    if (!m_Requests.empty()) psStatus->append(L", " + std::to_wstring(m_Requests.size()) + L" queued");
+    psStatus->append(L" (ESC cancels)");
+    return true;
 }
 
-/** Formats an output as hex-float: ***************************************************/
+/** Cancels the calculations and joins the worker, before the window is gone: *********/
 
-std::wstring CCommandHandler::sOutputHexFloat(double dInput) {
-    tUnifNum num;
-    WCHAR    szwNumBuf[40];
-    num.f = (float) dInput;
-    swprintf(szwNumBuf, L"0x%02X%02X%02X%02X f", num.u[3], num.u[2], num.u[1], num.u[0]);
-    return std::wstring(szwNumBuf);
+void CCommandHandler::vStopWorker(void) {
+    {
+        std::unique_lock<std::mutex> Guard(m_Lock);
+        m_bStop = true;
+        m_pCancel->vCancel();
+    }
+    m_JobReady.notify_all();
+    if (m_Worker.joinable()) m_Worker.join();
 }
 
-/** Formats an output as binary: ******************************************************/
+/** Colorizes all the text of the editor, which is only needed, when it was set as a *
+ *  whole. Each calculation colorizes its own block with vColorizeBlock instead:      */
 
-std::wstring CCommandHandler::sOutputBin(double dInput) {
+void CCommandHandler::vColorizeText(HWND hEditBox) {
     /** Variables:                                                                    */
-    WCHAR   szwNumBuf[80];
-    INT64   s64Temp = (INT64)dInput;
-    uint8_t u8Pos = 4;
-    /** Find the right length:                                                        */
-    while (((INT64)1 << u8Pos) <= abs(s64Temp)) u8Pos += 4;
-    /** Build the according number of digits:                                         */
-    wcscpy(szwNumBuf, L"0b");
-    while (u8Pos>0) {
-        /** Put spaces before each 4th digit:                                         */
-        if (((u8Pos % 4) == 0) && (u8Pos>0)) wcscat(szwNumBuf, L" ");
-        /** Go one bit further:                                                       */
-        u8Pos--;
-        /** And add the digit:                                                        */
-        if (s64Temp & ((INT64)1 << u8Pos)) {
-            wcscat(szwNumBuf, L"1");
-        }else{
-            wcscat(szwNumBuf, L"0");
-        }
-    }
-    return std::wstring(szwNumBuf);
+    CHARFORMAT2W cfDef = { sizeof(CHARFORMAT2W) };
+    DWORD        cBg, cTxt, cRes;
+    DWORD        dwLen = GetWindowTextLength(hEditBox);
+    DWORD        dwEventMask;
+    /** Apply the default color to all text first:                                    */
+    m_pConfig->vGetColors(cBg, cTxt, cRes);
+    cfDef.dwMask      = CFM_COLOR;
+    cfDef.crTextColor = cTxt;
+    dwEventMask = dwSuspendRedraw(hEditBox);
+    SendMessage(hEditBox, EM_SETSEL, 0, -1);
+    SendMessage(hEditBox, EM_SETCHARFORMAT, SCF_SELECTION, (LPARAM)&cfDef);
+    /** Fetch the text, as the editor counts it, and colorize the results:            */
+    vGetText(hEditBox, 0, &m_sLine);
+    vColorizeBlock(hEditBox, 0, m_sLine);
+    /** Restore the selection to the end:                                             */
+    SendMessage(hEditBox, EM_SETSEL, dwLen, dwLen);
+    vResumeRedraw(hEditBox, dwEventMask);
 }
 
-/** Formats an output as decimal integer: *********************************************/
-
-std::wstring CCommandHandler::sOutputInt(double dInput) {
-    WCHAR szwNumBuf[40];
-    INT64 s64Temp = (INT64)dInput;
-    swprintf(szwNumBuf, L"%I64i", s64Temp);
-    return std::wstring(szwNumBuf);
-}
+/** Colorizes the result-lines of a block, which starts at the given character of the *
+ *  editor. Its text has the default color already. The editor counts a line-break as *
+ *  one character, thus a CR+LF within the block is counted once:                     */
 
-/** Formats an output as floating-point value: ****************************************/
-
-std::wstring CCommandHandler::sOutputFloat(double dInput) {
-    WCHAR  szwNumBuf[40];
-    WCHAR  szwFormat[40];
-    double dTemp = dInput/10;
-    int    iIntDigits = 1;
-    int    iDecimals  = m_pConfig->iPrecision;
-    /** Check, if the input is in the range for fixed-point:                          */
-    if ((abs(dInput) < 1000000) && (abs(dInput) > 0.09)) {
-        /** It is, so get the number of integer-digits:                               */
-        iIntDigits = 1;
-        while (abs(dTemp) > 1) {
-            dTemp = dTemp / 10;
-            iIntDigits++;
+void CCommandHandler::vColorizeBlock(HWND hEditBox, DWORD dwStart, const std::wstring& sBlock) {
+    /** Variables:                                                                    */
+    CHARFORMAT2W cfRes = { sizeof(CHARFORMAT2W) };
+    DWORD        cBg, cTxt, cRes;
+    DWORD        dwPos = dwStart;
+    DWORD        dwLineStart;
+    size_t       uIndex = 0;
+    bool         bResult;
+    m_pConfig->vGetColors(cBg, cTxt, cRes);
+    cfRes.dwMask      = CFM_COLOR;
+    cfRes.crTextColor = cRes;
+    /** Walk through the lines of the block:                                          */
+    while (uIndex < sBlock.length()) {
+        bResult     = (sBlock.compare(uIndex, 4, L"  = ") == 0);
+        dwLineStart = dwPos;
+        while ((uIndex < sBlock.length()) && (sBlock[uIndex] != L'\r') && (sBlock[uIndex] != L'\n')) {
+            uIndex++;
+            dwPos++;
+        }
+        if (bResult) {
+            SendMessage(hEditBox, EM_SETSEL, dwLineStart, dwPos);
+            SendMessage(hEditBox, EM_SETCHARFORMAT, SCF_SELECTION, (LPARAM)&cfRes);
+        }
+        if (uIndex < sBlock.length()) {
+            if ((sBlock[uIndex] == L'\r') && (uIndex + 1 < sBlock.length()) && (sBlock[uIndex + 1] == L'\n')) uIndex++;
+            uIndex++;
+            dwPos++;
         }
-        /** Make sure, that there's enough space for the precision:                   */
-        if ((iIntDigits + iDecimals) > CNF_MAX_PRECISION) iDecimals = CNF_MAX_PRECISION - iIntDigits + 1;
-        /** And build the output:                                                     */
-        swprintf(szwFormat, L"%%1.%df", iDecimals);
-        swprintf(szwNumBuf, szwFormat , dInput);
-        return std::wstring(szwNumBuf);
     }
-    /** It is not fixed-point, thus write it exponential style:                       */
-    swprintf(szwFormat, L"%%1.%dE", m_pConfig->iPrecision);
-    swprintf(szwNumBuf, szwFormat, dInput);
-    return std::wstring(szwNumBuf);
 }
 
-/** Small support-functions: **********************************************************/
+/** Fetches the text of the editor from the given character to its end. The buffer   *
+ *  keeps its storage for the next call. Line-breaks are single CRs, as the editor    *
+ *  counts them:                                                                      */
 
-bool CCommandHandler::isInteger(double dInput) {
-  double fractpart, intpart;
-  fractpart = modf (dInput , &intpart);
-  if (fractpart>0) return false;
-  return true;
-}
-
-void CCommandHandler::vRollback(WCHAR* pszwInput, WCHAR* pszwNewStart) {
-    while (*pszwNewStart != L'\0') {
-        *pszwInput = *pszwNewStart;
-        pszwInput++;
-        pszwNewStart++;
-    }
-    *pszwInput = L'\0';
+void CCommandHandler::vGetText(HWND hEditBox, DWORD dwStart, std::wstring* psText) {
+    /** Variables:                                                                    */
+    TEXTRANGEW tr;
+    DWORD      dwLen = GetWindowTextLength(hEditBox);
+    psText->clear();
+    if (dwLen <= dwStart) return;
+    /** The length of the window-text counts CR+LF twice, thus it is enough:          */
+    psText->resize(dwLen - dwStart + 1);
+    tr.chrg.cpMin = dwStart;
+    tr.chrg.cpMax = -1;
+    tr.lpstrText  = &(*psText)[0];
+    psText->resize((size_t) SendMessage(hEditBox, EM_GETTEXTRANGE, 0, (LPARAM)&tr));
 }
 
-/** Colorizes the text in the editor: *************************************************/
+/** Stops the editor from painting and notifying, while a block is changed. Returns   *
+ *  the event-mask for vResumeRedraw:                                                 */
 
-void CCommandHandler::vColorizeText(HWND hEditBox) {
-    /** Determine Colors:                                                             */
-    DWORD cBg, cTxt, cRes;
-    m_pConfig->vGetColors(cBg, cTxt, cRes);
-
-    /** Setup Formats:                                                                */
-    CHARFORMAT2W cfDef = { sizeof(CHARFORMAT2W) };
-    cfDef.cbSize = sizeof(CHARFORMAT2W);
-    cfDef.dwMask = CFM_COLOR;
-    cfDef.crTextColor = cTxt;
+DWORD CCommandHandler::dwSuspendRedraw(HWND hEditBox) {
+    SendMessage(hEditBox, WM_SETREDRAW, FALSE, 0);
+    return (DWORD) SendMessage(hEditBox, EM_SETEVENTMASK, 0, 0);
+}
 
-    CHARFORMAT2W cfRes = { sizeof(CHARFORMAT2W) };
-    cfRes.cbSize = sizeof(CHARFORMAT2W);
-    cfRes.dwMask = CFM_COLOR;
-    cfRes.crTextColor = cRes;
+/** Restores the events and paints all changes at once: *******************************/
 
-    /** Apply Default Color to ALL text first:                                        */
-    SendMessage(hEditBox, EM_SETSEL, 0, -1);
-    SendMessage(hEditBox, EM_SETCHARFORMAT, SCF_SELECTION, (LPARAM)&cfDef);
+void CCommandHandler::vResumeRedraw(HWND hEditBox, DWORD dwEventMask) {
+    SendMessage(hEditBox, EM_SETEVENTMASK, 0, dwEventMask);
+    SendMessage(hEditBox, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(hEditBox, NULL, FALSE);
+}
 
-    /** Scan text and colorize results:                                               */
-    DWORD dwLen = GetWindowTextLength(hEditBox);
-    if (dwLen == 0) return;
+/** Worker-Loop: **********************************************************************
+ *    Runs the queued inputs one after another. The token is reset under the lock,    *
+ *    so that ESC cancels either the queued input or the running one, never the next: */
 
-    // Use EM_GETTEXTRANGE to get exactly what RichEdit sees (no CRLF conversion issues)
-    WCHAR* pszText = new WCHAR[dwLen + 1];
-    TEXTRANGEW tr;
-    tr.chrg.cpMin = 0;
-    tr.chrg.cpMax = dwLen;
-    tr.lpstrText = pszText;
-    SendMessage(hEditBox, EM_GETTEXTRANGE, 0, (LPARAM)&tr);
-    
-    // Safety null terminate (though standard says it copies up to...)
-    // Wait, EM_GETTEXTRANGE doesn't promise NULL termination if full buffer used?
-    // It copies null usually. But let's be safe.
-    // Actually we can't be sure where it ended if it didn't copy NULL.
-    // But dwLen is length. So pszText[dwLen] = 0;
-    pszText[dwLen] = L'\0'; // Basic safety
-
-    DWORD dwPos = 0;
-    while (dwPos < dwLen) {
-        // Check if line starts with "  = "
-        // Logic: Start of buffer OR Previous char was \r or \n
-        bool bLineStart = (dwPos == 0) || (pszText[dwPos-1] == L'\r') || (pszText[dwPos-1] == L'\n');
-        
-        if (bLineStart) {
-             // Check for "  = "
-             // We need to look ahead
-             if ((dwPos + 4 <= dwLen)) {
-                  if (wcsncmp(&pszText[dwPos], L"  = ", 4) == 0) {
-                      // Found a result line!
-                      // Find end of this line
-                      DWORD dwEnd = dwPos;
-                      while (dwEnd < dwLen && pszText[dwEnd] != L'\r' && pszText[dwEnd] != L'\n') {
-                          dwEnd++;
-                      }
-                      
-                      // Apply Color
-                      SendMessage(hEditBox, EM_SETSEL, dwPos, dwEnd);
-                      SendMessage(hEditBox, EM_SETCHARFORMAT, SCF_SELECTION, (LPARAM)&cfRes);
-                      
-                      dwPos = dwEnd;
-                  }
-             }
+void CCommandHandler::vWorker(void) {
+    /** Variables:                                                                    */
+    tCalcJob tJob;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> Guard(m_Lock);
+            m_JobReady.wait(Guard, [this] { return (m_bStop || !m_Requests.empty()); });
+            if (m_bStop) return;
+            tJob = m_Requests.front();
+            m_Requests.pop_front();
+            m_pCancel->vReset();
+            m_bBusy = true;
+        }
+        tJob.sResult = m_pCalc->sProcMath(tJob.sInput);
+        tJob.bFailed = m_pCalc->bLastFailed();
+        {
+            std::unique_lock<std::mutex> Guard(m_Lock);
+            m_Results.push_back(tJob);
+            m_bBusy = false;
         }
-        dwPos++;
+        PostMessage(m_hMain, WM_CALCDONE, 0, 0);
     }
-    
-    delete[] pszText;
-    
-    /** Restore selection to end:                                                     */
-    SendMessage(hEditBox, EM_SETSEL, dwLen, dwLen);
 }
-
@@ -20,37 +20,66 @@
 
 #pragma once
 
-#include <cstdint>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define WM_CALCDONE           (WM_APP + 1)   // The worker has results for vProcResults
+#define C_TIMER_Progress      1
+#define C_PROGRESS_Interval   250            // Milliseconds between updates of the title
+
+class CCalculator;
+class CHistory;
+class CCancelToken;
 
 /** Type Definitions: *****************************************************************/
 
-typedef union {
-    float   f;
-    uint8_t u[4];
-} tUnifNum;
+typedef struct {
+    std::wstring sInput;         // Input without the prompt
+    std::wstring sResult;        // Result-lines of the calculator
+    bool         bFailed;        // The result is an error-message
+} tCalcJob;
 
-/** Class Definition: *****************************************************************/
+/** Class Definition: *****************************************************************
+ *    Calculations run on a worker-thread, thus the message-loop never waits for      *
+ *    them. Its results are posted back with WM_CALCDONE:                             */
 
 class CCommandHandler {
 public:
     DWORD           m_dwEditLastLF;
     CCommandHandler(CConfigHandler* Config);
     ~CCommandHandler();
-    void            vSetInfoText(WCHAR* pszwTextPtr);
+    void            vSetInfoText(const std::wstring& sText);
     void            vSetText(HWND hEditBox, const WCHAR* pszwNewText);
     void            vColorizeText(HWND hEditBox);
+    void            vColorizeBlock(HWND hEditBox, DWORD dwStart, const std::wstring& sBlock);
     void            vProcEnter(HWND hMain, HWND hEditBox);
-    std::wstring    vProcMath(std::wstring sInput);
-    DWORD           dwFindNthLastCR(const WCHAR* pszwInput, int iCount);
+    void            vProcResults(HWND hEditBox);
+    void            vProcTab(HWND hEditBox, bool bNewer, bool bRestart);
+    void            vCancel(void);
+    bool            bGetStatus(std::wstring* psStatus);
+    void            vStopWorker(void);
 private:
-    CTerm           m_TermMain;
     CConfigHandler* m_pConfig;
-    WCHAR*          m_pszwInfoText;
-    std::wstring    sOutputHexInt(double dInput);
-    std::wstring    sOutputHexFloat(double dInput);
-    std::wstring    sOutputBin(double dInput);
-    std::wstring    sOutputInt(double dInput);
-    std::wstring    sOutputFloat(double dInput);
-    bool            isInteger(double dInput);
-    void            vRollback(WCHAR* pszwInput, WCHAR* pszwNewStart);
+    CCalculator*    m_pCalc;
+    CHistory*       m_pHistory;
+    CCancelToken*   m_pCancel;
+    HWND            m_hMain;
+    std::thread     m_Worker;
+    std::mutex      m_Lock;
+    std::condition_variable m_JobReady;
+    std::deque<tCalcJob>    m_Requests;
+    std::deque<tCalcJob>    m_Results;
+    bool            m_bBusy;
+    bool            m_bStop;
+    std::wstring    m_sRecallPrefix;
+    UINT64          m_u64RecallPos;
+    std::wstring    m_sInfoText;
+    std::wstring    m_sLine;
+    void            vGetText(HWND hEditBox, DWORD dwStart, std::wstring* psText);
+    DWORD           dwSuspendRedraw(HWND hEditBox);
+    void            vResumeRedraw(HWND hEditBox, DWORD dwEventMask);
+    void            vWorker(void);
 };
@@ -147,6 +147,10 @@ bool CConfigHandler::bWriteToFile(const WCHAR* pszwFName) {
     fwprintf(fp, L"Precision=%d\n", iPrecision);
     fwprintf(fp, L"Lines=%d\n"            , iLines           );
     fwprintf(fp, L"ColorMode=%d\n"        , iColorMode       );
+    fwprintf(fp, L"CacheSize=%d\n"        , iCacheSize       );
+    fwprintf(fp, L"MaxNodes=%d\n"         , iMaxNodes        );
+    fwprintf(fp, L"MaxDepth=%d\n"         , iMaxDepth        );
+    fwprintf(fp, L"TimeLimit=%d\n"        , iTimeLimit       );
     fwprintf(fp, L"LightBg=%ls\n"          , sLightBg.c_str() );
     fwprintf(fp, L"LightTxt=%ls\n"         , sLightTxt.c_str());
     fwprintf(fp, L"DarkBg=%ls\n"           , sDarkBg.c_str()  );
@@ -233,6 +237,10 @@ bool CConfigHandler::bReadFromFile(const WCHAR* pszwFName) {
         else if (wcsncmp(buf, L"Precision=", 10) == 0) iPrecision = wcstol(buf + 10, NULL, 10);
         else if (wcsncmp(buf, L"Lines=", 6) == 0) iLines = wcstol(buf + 6, NULL, 10);
         else if (wcsncmp(buf, L"ColorMode=", 10) == 0) iColorMode = wcstol(buf + 10, NULL, 10);
+        else if (wcsncmp(buf, L"CacheSize=", 10) == 0) iCacheSize = wcstol(buf + 10, NULL, 10);
+        else if (wcsncmp(buf, L"MaxNodes=", 9) == 0) iMaxNodes = wcstol(buf + 9, NULL, 10);
+        else if (wcsncmp(buf, L"MaxDepth=", 9) == 0) iMaxDepth = wcstol(buf + 9, NULL, 10);
+        else if (wcsncmp(buf, L"TimeLimit=", 10) == 0) iTimeLimit = wcstol(buf + 10, NULL, 10);
         else if (wcsncmp(buf, L"LightBg=", 8) == 0) sLightBg = buf + 8;
         else if (wcsncmp(buf, L"LightTxt=", 9) == 0) sLightTxt = buf + 9;
         else if (wcsncmp(buf, L"DarkBg=", 7) == 0) sDarkBg = buf + 7;
@@ -242,6 +250,10 @@ bool CConfigHandler::bReadFromFile(const WCHAR* pszwFName) {
     }
 
     if ((iLines & 1)==0) iLines++;
+    if ((iCacheSize < 0) || (iCacheSize > CNF_MAX_CACHESIZE)) iCacheSize = CNF_DEF_CACHESIZE;
+    if ((iMaxNodes < 1) || (iMaxNodes > CNF_MAX_MAXNODES)) iMaxNodes = CNF_DEF_MAXNODES;
+    if ((iMaxDepth < 1) || (iMaxDepth > CNF_MAX_MAXDEPTH)) iMaxDepth = CNF_DEF_MAXDEPTH;
+    if ((iTimeLimit < 0) || (iTimeLimit > CNF_MAX_TIMELIMIT)) iTimeLimit = CNF_DEF_TIMELIMIT;
 
     if (bTextSection) {
         sText = L"";
@@ -273,6 +285,10 @@ void CConfigHandler::vSetDefaultData(void) {
     sText      = L"";
     
     iColorMode = CNF_DEF_COLORMODE;
+    iCacheSize = CNF_DEF_CACHESIZE;
+    iMaxNodes  = CNF_DEF_MAXNODES;
+    iMaxDepth  = CNF_DEF_MAXDEPTH;
+    iTimeLimit = CNF_DEF_TIMELIMIT;
     sLightBg   = L"FFFFFF";
     sLightTxt  = L"000000";
     sDarkBg    = L"000000";
@@ -28,6 +28,10 @@
 #define CNF_MAX_PRECISION 15
 #define CNF_MAX_LINES     255
 #define CNF_MAX_FONTSIZE  30
+#define CNF_MAX_CACHESIZE 4096
+#define CNF_MAX_MAXNODES  0x100000       // C_TERM_MaxNodes
+#define CNF_MAX_MAXDEPTH  100000
+#define CNF_MAX_TIMELIMIT 3600000        // Milliseconds
 
 #define CNF_DEF_TOP       CW_USEDEFAULT
 #define CNF_DEF_LEFT      CW_USEDEFAULT
@@ -38,17 +42,22 @@
 #define CNF_DEF_LINES     44
 #define CNF_DEF_FONTSIZE  25
 #define CNF_DEF_COLORMODE 0
+#define CNF_DEF_CACHESIZE 64
+#define CNF_DEF_MAXNODES  CNF_MAX_MAXNODES
+#define CNF_DEF_MAXDEPTH  1000
+#define CNF_DEF_TIMELIMIT 0                // No limit, ESC still cancels
 
 #define CNF_MAX_COLORMODE 2
 
-#define C_TEXTBUFSIZE 10000
+#define C_TEXTLIMIT   0x7FFFFFFE         // Characters of the edit-box
 
 /** Class Definition: *****************************************************************/
 
 class CConfigHandler {
 public:
     // Properties:
-    INT32        iTop, iLeft, iHeight, iWidth, iOpacity, iPrecision, iLines, iFontSize, iColorMode;
+    INT32        iTop, iLeft, iHeight, iWidth, iOpacity, iPrecision, iLines, iFontSize, iColorMode, iCacheSize;
+    INT32        iMaxNodes, iMaxDepth, iTimeLimit;
     std::wstring sText, sLightBg, sLightTxt, sDarkBg, sDarkTxt, sResultLightColor, sResultDarkColor;
     // Methods:
     CConfigHandler();
@@ -0,0 +1,38 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************
+ *    Basic types of the calculation core. It is included first by the sources of    *
+ *    the core instead of stdafx.h, thus the core builds without windows.h:           */
+
+#pragma once
+
+#include <stddef.h>
+#include <wchar.h>
+
+#if defined(_WIN32)
+#include <basetsd.h>
+#else
+#include <stdint.h>
+typedef int32_t  INT32;
+typedef uint32_t UINT32;
+typedef int64_t  INT64;
+typedef uint64_t UINT64;
+typedef uint8_t  UINT8;
+#endif
+typedef wchar_t  WCHAR;
@@ -0,0 +1,223 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <utility>
+#include "History.h"
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************/
+
+CHistory::CHistory(INT32 s32Capacity) {
+    m_uCapacity = 0;
+    m_u64End    = 0;
+    vClear();
+    vSetCapacity(s32Capacity);
+}
+
+/** Destructor: ***********************************************************************/
+
+CHistory::~CHistory() {
+}
+
+/** Set-Function of the capacity in entries, at least one is kept. Surplus entries    *
+ *  are dropped, oldest first, the others move to their slots in the new ring:        */
+
+void CHistory::vSetCapacity(INT32 s32Capacity) {
+    /** Variables:                                                                    */
+    std::vector<tHistoryEntry> Entries;
+    size_t                     uCapacity = (s32Capacity > 1) ? (size_t) s32Capacity : 1;
+    UINT64                     u64Serial;
+    while (m_u64End - m_u64First > uCapacity) vDropOldest();
+    Entries.resize(uCapacity);
+    for (u64Serial = m_u64First; u64Serial < m_u64End; u64Serial++) {
+        Entries[u64Serial % uCapacity] = std::move(m_Entries[u64Serial % m_uCapacity]);
+    }
+    m_Entries.swap(Entries);
+    m_uCapacity = uCapacity;
+}
+
+/** Drops all entries. The serials go on, thus they never refer to an old entry: ******/
+
+void CHistory::vClear(void) {
+    m_Entries.assign(m_uCapacity, tHistoryEntry());
+    m_Nodes.assign(1, tHistoryNode());
+    m_FreeNodes.clear();
+    m_u64First = m_u64End;
+}
+
+/** Appends an entry, which drops the oldest one, if the ring is full. Its serial     *
+ *  is added to the node of each prefix of the input:                                 */
+
+void CHistory::vAdd(const std::wstring& sInput, const std::wstring& sResult, bool bFailed) {
+    /** Variables:                                                                    */
+    tHistoryEntry* pEntry;
+    UINT32         u32Node = 0;
+    if (m_u64End - m_u64First >= m_uCapacity) vDropOldest();
+    pEntry = &m_Entries[m_u64End % m_uCapacity];
+    pEntry->sInput  = sInput;
+    pEntry->sResult = sResult;
+    pEntry->bFailed = bFailed;
+    m_Nodes[0].Serials.push_back(m_u64End);
+    for (WCHAR wc : sInput) {
+        u32Node = u32AddChild(u32Node, wc);
+        m_Nodes[u32Node].Serials.push_back(m_u64End);
+    }
+    m_u64End++;
+}
+
+/** Rebuilds the entries from the text of a former session. Inputs are the lines     *
+ *  indented by two spaces, the lines with = and * below them are their results:      */
+
+void CHistory::vLoad(const std::wstring& sText) {
+    /** Variables:                                                                    */
+    std::wstring sInput, sResult, sLine;
+    size_t       uStart = 0, uEnd;
+    bool         bInput = false;
+    bool         bFailed = false;
+    vClear();
+    while (uStart < sText.length()) {
+        uEnd = sText.find_first_of(L"\r\n", uStart);
+        if (uEnd == std::wstring::npos) uEnd = sText.length();
+        sLine.assign(sText, uStart, uEnd - uStart);
+        uStart = uEnd + (((uEnd + 1 < sText.length()) && (sText[uEnd] == L'\r') && (sText[uEnd + 1] == L'\n')) ? 2 : 1);
+        if ((sLine.compare(0, 3, L"  =") == 0) || (sLine.compare(0, 3, L"  *") == 0)) {
+            /** A result-line, which belongs to the input above, if there is one:     */
+            if (!bInput) continue;
+            if (sResult.empty()) bFailed = (sLine[2] == L'*');
+            sResult += sLine + L"\r\n";
+            continue;
+        }
+        if (bInput) vAdd(sInput, sResult, bFailed);
+        bInput = (sLine.compare(0, 2, L"  ") == 0);
+        if (bInput) sInput.assign(sLine, 2, std::wstring::npos);
+        sResult.clear();
+        bFailed = false;
+    }
+    if (bInput) vAdd(sInput, sResult, bFailed);
+}
+
+/** Get-Function of the serial behind the newest entry, where a recall starts: ********/
+
+UINT64 CHistory::u64GetEnd(void) const {
+    return m_u64End;
+}
+
+/** Prefix-Search: ********************************************************************
+ *    Returns the serial of the next entry before (or after, if bNewer) u64From,      *
+ *    whose input starts with the prefix. C_HIST_NoEntry, if there is none:           */
+
+UINT64 CHistory::u64Find(const std::wstring& sPrefix, UINT64 u64From, bool bNewer) const {
+    /** Variables:                                                                    */
+    UINT32                             u32Node = 0;
+    std::deque<UINT64>::const_iterator Pos;
+    for (WCHAR wc : sPrefix) {
+        u32Node = u32FindChild(u32Node, wc);
+        if (u32Node == C_HIST_NoNode) return C_HIST_NoEntry;
+    }
+    const std::deque<UINT64>& Serials = m_Nodes[u32Node].Serials;
+    if (bNewer) {
+        Pos = std::upper_bound(Serials.begin(), Serials.end(), u64From);
+        return (Pos == Serials.end()) ? C_HIST_NoEntry : *Pos;
+    }
+    Pos = std::lower_bound(Serials.begin(), Serials.end(), u64From);
+    return (Pos == Serials.begin()) ? C_HIST_NoEntry : *(--Pos);
+}
+
+/** Get-Function of an entry by its serial, NULL if it was dropped already: ***********/
+
+const tHistoryEntry* CHistory::pGetEntry(UINT64 u64Serial) const {
+    if ((u64Serial < m_u64First) || (u64Serial >= m_u64End)) return NULL;
+    return &m_Entries[u64Serial % m_uCapacity];
+}
+
+/** Private Functions: ****************************************************************/
+
+/** Looks up the child of a node for a character: *************************************/
+
+UINT32 CHistory::u32FindChild(UINT32 u32Node, WCHAR wc) const {
+    const std::vector<std::pair<WCHAR, UINT32>>& Children = m_Nodes[u32Node].Children;
+    auto Pos = std::lower_bound(Children.begin(), Children.end(), std::make_pair(wc, (UINT32) 0));
+    if ((Pos == Children.end()) || (Pos->first != wc)) return C_HIST_NoNode;
+    return Pos->second;
+}
+
+/** Looks up the child of a node for a character, which is created if needed: *********/
+
+UINT32 CHistory::u32AddChild(UINT32 u32Node, WCHAR wc) {
+    /** Variables:                                                                    */
+    UINT32 u32Child = u32FindChild(u32Node, wc);
+    if (u32Child != C_HIST_NoNode) return u32Child;
+    if (!m_FreeNodes.empty()) {
+        u32Child = m_FreeNodes.back();
+        m_FreeNodes.pop_back();
+    }else{
+        u32Child = (UINT32) m_Nodes.size();
+        m_Nodes.emplace_back();
+    }
+    std::vector<std::pair<WCHAR, UINT32>>& Children = m_Nodes[u32Node].Children;
+    Children.insert(std::lower_bound(Children.begin(), Children.end(), std::make_pair(wc, (UINT32) 0)), std::make_pair(wc, u32Child));
+    return u32Child;
+}
+
+/** Drops the oldest entry. Its serial is the first one in each node of its input,    *
+ *  and a node without serials is removed with everything below it:                   */
+
+void CHistory::vDropOldest(void) {
+    /** Variables:                                                                    */
+    tHistoryEntry* pEntry  = &m_Entries[m_u64First % m_uCapacity];
+    UINT32         u32Node = 0;
+    UINT32         u32Child;
+    m_Nodes[0].Serials.pop_front();
+    for (WCHAR wc : pEntry->sInput) {
+        u32Child = u32FindChild(u32Node, wc);
+        m_Nodes[u32Child].Serials.pop_front();
+        if (m_Nodes[u32Child].Serials.empty()) {
+            std::vector<std::pair<WCHAR, UINT32>>& Children = m_Nodes[u32Node].Children;
+            Children.erase(std::lower_bound(Children.begin(), Children.end(), std::make_pair(wc, (UINT32) 0)));
+            vFreeNode(u32Child);
+            break;
+        }
+        u32Node = u32Child;
+    }
+    pEntry->sInput.clear();
+    pEntry->sResult.clear();
+    m_u64First++;
+}
+
+/** Returns a node and all nodes below it to the free-list: ***************************/
+
+void CHistory::vFreeNode(UINT32 u32Node) {
+    std::vector<UINT32> Pending(1, u32Node);
+    while (!Pending.empty()) {
+        u32Node = Pending.back();
+        Pending.pop_back();
+        for (const std::pair<WCHAR, UINT32>& Child : m_Nodes[u32Node].Children) Pending.push_back(Child.second);
+        m_Nodes[u32Node].Children.clear();
+        m_Nodes[u32Node].Serials.clear();
+        m_FreeNodes.push_back(u32Node);
+    }
+}
@@ -0,0 +1,73 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+
+#define C_HIST_NoEntry           0xFFFFFFFFFFFFFFFFULL
+#define C_HIST_NoNode            0xFFFFFFFF
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct {
+    std::wstring sInput;         // Input as the user typed it
+    std::wstring sResult;        // Lines of the result, each with CR+LF
+    bool         bFailed;        // The calculation gave an error
+} tHistoryEntry;
+
+typedef struct {
+    std::vector<std::pair<WCHAR, UINT32>> Children;  // Sorted by the character
+    std::deque<UINT64>                    Serials;   // Entries with this prefix, oldest first
+} tHistoryNode;
+
+/** Class Definition: *****************************************************************
+ *    The inputs of a session with their results, for the recall with TAB. The        *
+ *    entries are kept in a ring and numbered by a serial, which grows forever. A     *
+ *    trie over the inputs holds the serials of all entries with its prefix, thus the *
+ *    next older or newer match of a prefix is a binary search at its node:           */
+
+class CHistory {
+public:
+    CHistory(INT32 s32Capacity);
+    ~CHistory();
+    void   vSetCapacity(INT32 s32Capacity);
+    void   vClear(void);
+    void   vAdd(const std::wstring& sInput, const std::wstring& sResult, bool bFailed);
+    void   vLoad(const std::wstring& sText);
+    UINT64 u64GetEnd(void) const;
+    UINT64 u64Find(const std::wstring& sPrefix, UINT64 u64From, bool bNewer) const;
+    const tHistoryEntry* pGetEntry(UINT64 u64Serial) const;
+private:
+    std::vector<tHistoryEntry> m_Entries;
+    std::vector<tHistoryNode>  m_Nodes;
+    std::vector<UINT32>        m_FreeNodes;
+    size_t                     m_uCapacity;
+    UINT64                     m_u64First;
+    UINT64                     m_u64End;
+    UINT32 u32FindChild(UINT32 u32Node, WCHAR wc) const;
+    UINT32 u32AddChild(UINT32 u32Node, WCHAR wc);
+    void   vDropOldest(void);
+    void   vFreeNode(UINT32 u32Node);
+};
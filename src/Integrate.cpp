@@ -0,0 +1,252 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string>
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include "Term.h"
+#include "WorkerPool.h"
+#include "Integrate.h"
+
+/** Local Variables: ******************************************************************
+ *    The nodes of the 15-point Kronrod-rule on one half of [-1, 1] and its weights,  *
+ *    the odd ones are the nodes of the embedded 7-point Gauss-rule:                  */
+
+static const double s_adNode[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000
+};
+
+static const double s_adKronrod[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+};
+
+static const double s_adGauss[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+};
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************/
+
+CIntegrate::CIntegrate(CWorkerPool* pPool, CCancelToken* pCancel) {
+    m_pPool      = pPool;
+    m_pCancel    = pCancel;
+    m_dResult    = 0;
+    m_dError     = 0;
+    m_dFailX     = 0;
+    m_uIntervals = 0;
+    m_bConverged = true;
+    m_dLength    = 0;
+    m_dDone      = 0;
+    m_dTolerance = 0;
+    m_uCount     = 0;
+}
+
+/** Destructor: ***********************************************************************/
+
+CIntegrate::~CIntegrate() {
+}
+
+/** Integrator: ***********************************************************************
+ *    Integrates the term from a to b. Each worker bisects its interval, keeps one    *
+ *    half and queues the other one, so idle workers take over the rest of a busy     *
+ *    region. Whether an interval is accepted only depends on itself, and the         *
+ *    leaves are summed from left to right, thus the result does not depend on the    *
+ *    number of threads. A cancelled token stops all workers at their next split:     */
+
+INT32 CIntegrate::s32Run(const CTerm& Term, double dA, double dB) {
+    /** Variables:                                                                    */
+    tIntegInterval tRoot = {};
+    double         dSum  = 0;
+    double         dComp = 0;
+    double         dNext;
+    bool           bNeg  = (dB < dA);
+    /** Check the range, a reversed one changes the sign:                             */
+    m_dResult    = 0;
+    m_dError     = 0;
+    m_uIntervals = 0;
+    m_bConverged = true;
+    if (!isfinite(dA) || !isfinite(dB)) return C_INTEG_InvalidRange;
+    if (bNeg) std::swap(dA, dB);
+    m_dLength = dB - dA;
+    if (!isfinite(m_dLength)) return C_INTEG_InvalidRange;
+    m_Leaves.clear();
+    m_dDone  = 0;
+    m_uCount = (m_dLength == 0) ? 0 : 1;
+    if (m_dLength == 0) return C_TERM_NumOK;
+    /** The whole range gives the scale of the tolerance:                             */
+    m_Terms.assign(m_pPool->u32GetThreads(), Term);
+    tRoot.dA       = dA;
+    tRoot.dB       = dB;
+    tRoot.u32Depth = 0;
+    vEvaluate(&m_Terms[0], &tRoot, 1);
+    /** Split until done:                                                             */
+    m_pPool->vSubmit([this, tRoot](UINT32 u32Worker) { vRunInterval(tRoot, u32Worker); });
+    m_pPool->vWait();
+    if (bCancelled()) return C_TERM_Cancelled;
+    /** Sum up the leaves from left to right, with compensation:                      */
+    std::sort(m_Leaves.begin(), m_Leaves.end(), [](const tIntegInterval& L, const tIntegInterval& R) { return L.dA < R.dA; });
+    m_uIntervals = m_Leaves.size();
+    for (const tIntegInterval& tLeaf : m_Leaves) {
+        if (tLeaf.bFailed) {
+            m_dFailX = tLeaf.dFailX;
+            return C_INTEG_NotIntegrable;
+        }
+        dNext  = dSum + tLeaf.dResult;
+        dComp += (fabs(dSum) >= fabs(tLeaf.dResult)) ? ((dSum - dNext) + tLeaf.dResult) : ((tLeaf.dResult - dNext) + dSum);
+        dSum   = dNext;
+        m_dError += tLeaf.dError;
+    }
+    m_dResult = bNeg ? -(dSum + dComp) : (dSum + dComp);
+    /** Leaves, which could not be split, do not matter, if the sum is good enough:   */
+    if (m_dError <= m_dTolerance) m_bConverged = true;
+    return C_TERM_NumOK;
+}
+
+/** Get-Function of the number of evaluated points: ***********************************/
+
+size_t CIntegrate::uGetPoints(void) {
+    return m_uCount * C_INTEG_Points;
+}
+
+/** Private Functions: ****************************************************************/
+
+/** Interval-Worker: ******************************************************************
+ *    Bisects the interval until it is accepted. Both halves are evaluated in one     *
+ *    batch, the right one goes back to the pool, the left one is kept:               */
+
+void CIntegrate::vRunInterval(tIntegInterval tInterval, UINT32 u32Worker) {
+    /** Variables:                                                                    */
+    tIntegInterval atHalf[2] = {};
+    tIntegInterval tRight;
+    double         dMid;
+    while (!bCancelled() && !bAccept(tInterval)) {
+        dMid = 0.5 * (tInterval.dA + tInterval.dB);
+        atHalf[0].dA       = tInterval.dA;
+        atHalf[0].dB       = dMid;
+        atHalf[1].dA       = dMid;
+        atHalf[1].dB       = tInterval.dB;
+        atHalf[0].u32Depth = atHalf[1].u32Depth = tInterval.u32Depth + 1;
+        vEvaluate(&m_Terms[u32Worker], atHalf, 2);
+        tRight = atHalf[1];
+        m_pPool->vSubmit([this, tRight](UINT32 u32Next) { vRunInterval(tRight, u32Next); });
+        tInterval = atHalf[0];
+    }
+    /** The progress is the part of the range, which is done:                         */
+    std::unique_lock<std::mutex> Guard(m_LeafLock);
+    m_Leaves.push_back(tInterval);
+    m_dDone += tInterval.dB - tInterval.dA;
+    if (m_pCancel != NULL) m_pCancel->vSetProgress(m_dDone / m_dLength);
+}
+
+/** Evaluates intervals with one batch of their Kronrod-points: ***********************
+ *    The error-estimate is the one of QUADPACK's qk15. It is raised to what the      *
+ *    rounding of the sum allows, so that smooth terms stop splitting:                */
+
+void CIntegrate::vEvaluate(CTerm* pTerm, tIntegInterval* pIntervals, size_t uCount) {
+    /** Variables:                                                                    */
+    double          adInput[2 * C_INTEG_Points] = {};
+    double          adOutput[2 * C_INTEG_Points];
+    UINT8           au8Status[2 * C_INTEG_Points];
+    double          dCenter, dHalf, dKronrod, dGauss, dAbs, dAsc, dMean;
+    double*         pdValue;
+    tIntegInterval* pInterval;
+    size_t          uInterval, uNode, uPos;
+    /** The points from left to right:                                                */
+    for (uInterval = 0; uInterval < uCount; uInterval++) {
+        dCenter = 0.5 * (pIntervals[uInterval].dA + pIntervals[uInterval].dB);
+        dHalf   = 0.5 * (pIntervals[uInterval].dB - pIntervals[uInterval].dA);
+        for (uNode = 0; uNode < 8; uNode++) {
+            adInput[uInterval * C_INTEG_Points + uNode]      = dCenter - dHalf * s_adNode[uNode];
+            adInput[uInterval * C_INTEG_Points + 14 - uNode] = dCenter + dHalf * s_adNode[uNode];
+        }
+    }
+    pTerm->s32ExecuteBatch(adInput, adOutput, au8Status, uCount * C_INTEG_Points);
+    /** Apply the rules:                                                              */
+    for (uInterval = 0; uInterval < uCount; uInterval++) {
+        pInterval = &pIntervals[uInterval];
+        pdValue = &adOutput[uInterval * C_INTEG_Points];
+        pInterval->bFailed = false;
+        pInterval->dFailX  = 0;
+        for (uPos = 0; uPos < C_INTEG_Points; uPos++) {
+            if ((au8Status[uInterval * C_INTEG_Points + uPos] == C_TERM_NumOK) && isfinite(pdValue[uPos])) continue;
+            pInterval->bFailed = true;
+            pInterval->dFailX  = adInput[uInterval * C_INTEG_Points + uPos];
+            break;
+        }
+        dHalf    = 0.5 * (pInterval->dB - pInterval->dA);
+        dKronrod = s_adKronrod[7] * pdValue[7];
+        dGauss   = s_adGauss[3] * pdValue[7];
+        dAbs     = fabs(dKronrod);
+        for (uNode = 0; uNode < 7; uNode++) {
+            dKronrod += s_adKronrod[uNode] * (pdValue[uNode] + pdValue[14 - uNode]);
+            dAbs     += s_adKronrod[uNode] * (fabs(pdValue[uNode]) + fabs(pdValue[14 - uNode]));
+            if (uNode & 1) dGauss += s_adGauss[uNode / 2] * (pdValue[uNode] + pdValue[14 - uNode]);
+        }
+        dMean = 0.5 * dKronrod;
+        dAsc  = s_adKronrod[7] * fabs(pdValue[7] - dMean);
+        for (uNode = 0; uNode < 7; uNode++) {
+            dAsc += s_adKronrod[uNode] * (fabs(pdValue[uNode] - dMean) + fabs(pdValue[14 - uNode] - dMean));
+        }
+        pInterval->dResult = dKronrod * dHalf;
+        pInterval->dError  = fabs((dKronrod - dGauss) * dHalf);
+        dAbs *= fabs(dHalf);
+        dAsc *= fabs(dHalf);
+        if ((dAsc != 0) && (pInterval->dError != 0)) {
+            pInterval->dError = dAsc * std::min(1.0, pow(200 * pInterval->dError / dAsc, 1.5));
+        }
+        if (dAbs > DBL_MIN / (50 * DBL_EPSILON)) pInterval->dError = std::max(50 * DBL_EPSILON * dAbs, pInterval->dError);
+        /** The first interval sets the tolerance of all:                             */
+        if (pInterval->u32Depth == 0) m_dTolerance = std::max(C_INTEG_AbsTol, C_INTEG_RelTol * dAbs);
+    }
+}
+
+/** Tells, if an interval needs no further bisection: *********************************
+ *    Failed ones, the ones within their share of the tolerance, and those which      *
+ *    cannot be split any further, the latter ones missing the tolerance:             */
+
+bool CIntegrate::bAccept(const tIntegInterval& tInterval) {
+    double dMid = 0.5 * (tInterval.dA + tInterval.dB);
+    if (tInterval.bFailed) return true;
+    if (tInterval.dError <= m_dTolerance * (tInterval.dB - tInterval.dA) / m_dLength) return true;
+    if ((tInterval.u32Depth < C_INTEG_MaxDepth) && (dMid > tInterval.dA) && (dMid < tInterval.dB)) {
+        /** Reserve the two halves:                                                   */
+        if (m_uCount.fetch_add(2) + 2 <= C_INTEG_MaxIntervals) return false;
+        m_uCount -= 2;
+    }
+    std::unique_lock<std::mutex> Guard(m_LeafLock);
+    m_bConverged = false;
+    return true;
+}
+
+/** Tells, if the token asks to stop: *************************************************/
+
+bool CIntegrate::bCancelled(void) {
+    return (m_pCancel != NULL) && m_pCancel->bIsCancelled();
+}
@@ -0,0 +1,77 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+#define C_INTEG_Points           15          // Kronrod-points of each interval
+#define C_INTEG_RelTol           1E-10       // Relative to the integral of |f|
+#define C_INTEG_AbsTol           1E-14
+#define C_INTEG_MaxDepth         40          // Bisections from the whole range
+#define C_INTEG_MaxIntervals     200000
+
+#define C_INTEG_InvalidRange     0x30
+#define C_INTEG_NotIntegrable    0x31
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct {
+    double dA;                   // Left end
+    double dB;                   // Right end
+    double dResult;              // Kronrod-estimate of the integral
+    double dError;               // Estimated absolute error
+    UINT32 u32Depth;             // Bisections from the whole range
+    bool   bFailed;              // A point was not defined or not finite
+    double dFailX;               // The first of these points
+} tIntegInterval;
+
+/** Class Definition: *****************************************************************
+ *    Adaptive Gauss-Kronrod quadrature over x, run on a worker-pool. The intervals   *
+ *    are bisected, until each one is within its share of the tolerance:              */
+
+class CIntegrate {
+public:
+    double m_dResult;
+    double m_dError;
+    double m_dFailX;
+    size_t m_uIntervals;
+    bool   m_bConverged;
+    CIntegrate(CWorkerPool* pPool, CCancelToken* pCancel = NULL);
+    ~CIntegrate();
+    INT32  s32Run(const CTerm& Term, double dA, double dB);
+    size_t uGetPoints(void);
+private:
+    CWorkerPool*                m_pPool;
+    CCancelToken*               m_pCancel;
+    double                      m_dLength;
+    double                      m_dDone;
+    double                      m_dTolerance;
+    std::vector<CTerm>          m_Terms;
+    std::vector<tIntegInterval> m_Leaves;
+    std::mutex                  m_LeafLock;
+    std::atomic<size_t>         m_uCount;
+    void   vRunInterval(tIntegInterval tInterval, UINT32 u32Worker);
+    void   vEvaluate(CTerm* pTerm, tIntegInterval* pIntervals, size_t uCount);
+    bool   bAccept(const tIntegInterval& tInterval);
+    bool   bCancelled(void);
+};
@@ -0,0 +1,211 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <cinttypes>
+#include <string>
+#include "Term.h"
+#include "NumFormat.h"
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************/
+
+CNumFormat::CNumFormat(INT32 s32Precision) {
+    vSetPrecision(s32Precision);
+}
+
+/** Destructor: ***********************************************************************/
+
+CNumFormat::~CNumFormat() {
+}
+
+/** Set-Function of the number of decimals for floats: ********************************/
+
+void CNumFormat::vSetPrecision(INT32 s32Precision) {
+    m_s32Precision = s32Precision;
+}
+
+/** Formats an output as integer or float, whatever fits: *****************************/
+
+std::wstring CNumFormat::sOutputNumber(double dInput) {
+    std::wstring sOutput;
+    vAppendNumber(dInput, &sOutput);
+    return sOutput;
+}
+
+/** Formats an output as hex-int: *****************************************************/
+
+std::wstring CNumFormat::sOutputHexInt(double dInput) {
+    std::wstring sOutput;
+    vAppendHexInt(dInput, &sOutput);
+    return sOutput;
+}
+
+/** Formats an output as hex-float: ***************************************************/
+
+std::wstring CNumFormat::sOutputHexFloat(double dInput) {
+    std::wstring sOutput;
+    vAppendHexFloat(dInput, &sOutput);
+    return sOutput;
+}
+
+/** Formats an output as binary: ******************************************************/
+
+std::wstring CNumFormat::sOutputBin(double dInput) {
+    std::wstring sOutput;
+    vAppendBin(dInput, &sOutput);
+    return sOutput;
+}
+
+/** Formats an output as decimal integer: *********************************************/
+
+std::wstring CNumFormat::sOutputInt(double dInput) {
+    std::wstring sOutput;
+    vAppendInt(dInput, &sOutput);
+    return sOutput;
+}
+
+/** Formats an output as floating-point value: ****************************************/
+
+std::wstring CNumFormat::sOutputFloat(double dInput) {
+    std::wstring sOutput;
+    vAppendFloat(dInput, &sOutput);
+    return sOutput;
+}
+
+/** Appending Formatters: *************************************************************
+ *    These do the work of the functions above. They append to a buffer of the        *
+ *    caller, thus a reused buffer does not allocate for each number:                 */
+
+void CNumFormat::vAppendNumber(double dInput, std::wstring* psOutput) {
+    if (isfinite(dInput) && isInteger(dInput) && (abs(dInput) < C_TERM_MAXINT)) {
+        vAppendInt(dInput, psOutput);
+    }else{
+        vAppendFloat(dInput, psOutput);
+    }
+}
+
+void CNumFormat::vAppendHexInt(double dInput, std::wstring* psOutput) {
+    vAppendHexInt((INT64) dInput, psOutput);
+}
+
+void CNumFormat::vAppendHexFloat(double dInput, std::wstring* psOutput) {
+    tUnifNum num;
+    char     szNumBuf[40];
+    num.f = (float) dInput;
+    snprintf(szNumBuf, sizeof(szNumBuf), "0x%02X%02X%02X%02X f", num.u[3], num.u[2], num.u[1], num.u[0]);
+    vWiden(szNumBuf, psOutput);
+}
+
+void CNumFormat::vAppendBin(double dInput, std::wstring* psOutput) {
+    vAppendBin((INT64) dInput, psOutput);
+}
+
+void CNumFormat::vAppendInt(double dInput, std::wstring* psOutput) {
+    /** Beyond INT64, the cast would not work, so keep the exponent:                  */
+    if (!(abs(dInput) < 9223372036854775808.0)) return vAppendFloat(dInput, psOutput);
+    vAppendInt((INT64) dInput, psOutput);
+}
+
+void CNumFormat::vAppendFloat(double dInput, std::wstring* psOutput) {
+    char   szNumBuf[40];
+    double dTemp = dInput/10;
+    int    iIntDigits = 1;
+    int    iDecimals  = m_s32Precision;
+    /** Check, if the input is in the range for fixed-point:                          */
+    if ((abs(dInput) < 1000000) && (abs(dInput) > 0.09)) {
+        /** It is, so get the number of integer-digits:                               */
+        iIntDigits = 1;
+        while (abs(dTemp) > 1) {
+            dTemp = dTemp / 10;
+            iIntDigits++;
+        }
+        /** Make sure, that there's enough space for the precision:                   */
+        if ((iIntDigits + iDecimals) > C_FMT_MaxPrecision) iDecimals = C_FMT_MaxPrecision - iIntDigits + 1;
+        /** And build the output:                                                     */
+        snprintf(szNumBuf, sizeof(szNumBuf), "%1.*f", iDecimals, dInput);
+        vWiden(szNumBuf, psOutput);
+        return;
+    }
+    /** It is not fixed-point, thus write it exponential style:                       */
+    snprintf(szNumBuf, sizeof(szNumBuf), "%1.*E", (int) m_s32Precision, dInput);
+    vWiden(szNumBuf, psOutput);
+}
+
+/** Exact Formatters: *****************************************************************
+ *    The integers of CTerm::s32ExecuteInt. Negative numbers are shown in hex and     *
+ *    binary as their 64-bit two's complement, unsigned patterns in decimal as such:  */
+
+void CNumFormat::vAppendHexInt(INT64 s64Input, std::wstring* psOutput) {
+    char szNumBuf[40];
+    snprintf(szNumBuf, sizeof(szNumBuf), "0x%" PRIX64, (UINT64) s64Input);
+    vWiden(szNumBuf, psOutput);
+}
+
+void CNumFormat::vAppendBin(INT64 s64Input, std::wstring* psOutput) {
+    /** Variables:                                                                    */
+    UINT64  u64Temp = (UINT64) s64Input;
+    uint8_t u8Pos   = 4;
+    psOutput->append(L"0b");
+    /** Find the right length:                                                        */
+    while ((u8Pos < 64) && (((UINT64)1 << u8Pos) <= u64Temp)) u8Pos += 4;
+    /** Build the according number of digits:                                         */
+    while (u8Pos>0) {
+        /** Put spaces before each 4th digit:                                         */
+        if ((u8Pos % 4) == 0) *psOutput += L' ';
+        /** Go one bit further:                                                       */
+        u8Pos--;
+        /** And add the digit:                                                        */
+        *psOutput += (u64Temp & ((UINT64)1 << u8Pos)) ? L'1' : L'0';
+    }
+}
+
+void CNumFormat::vAppendInt(INT64 s64Input, std::wstring* psOutput) {
+    char szNumBuf[40];
+    snprintf(szNumBuf, sizeof(szNumBuf), "%" PRId64, s64Input);
+    vWiden(szNumBuf, psOutput);
+}
+
+void CNumFormat::vAppendUInt(UINT64 u64Input, std::wstring* psOutput) {
+    char szNumBuf[40];
+    snprintf(szNumBuf, sizeof(szNumBuf), "%" PRIu64, u64Input);
+    vWiden(szNumBuf, psOutput);
+}
+
+/** Small support-functions: **********************************************************/
+
+bool CNumFormat::isInteger(double dInput) {
+  double fractpart, intpart;
+  fractpart = modf (dInput , &intpart);
+  if (fractpart>0) return false;
+  return true;
+}
+
+/** Private Functions: ****************************************************************/
+
+/** The formatted numbers are plain ASCII, thus they are just widened: ****************/
+
+void CNumFormat::vWiden(const char* pszInput, std::wstring* psOutput) {
+    while (*pszInput != '\0') *psOutput += (WCHAR) *pszInput++;
+}
@@ -0,0 +1,63 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#define C_FMT_MaxPrecision 15
+#define C_FMT_DefPrecision 5
+
+/** Type Definitions: *****************************************************************/
+
+typedef union {
+    float   f;
+    uint8_t u[4];
+} tUnifNum;
+
+/** Class Definition: *****************************************************************/
+
+class CNumFormat {
+public:
+    CNumFormat(INT32 s32Precision = C_FMT_DefPrecision);
+    ~CNumFormat();
+    void         vSetPrecision(INT32 s32Precision);
+    std::wstring sOutputNumber(double dInput);
+    std::wstring sOutputHexInt(double dInput);
+    std::wstring sOutputHexFloat(double dInput);
+    std::wstring sOutputBin(double dInput);
+    std::wstring sOutputInt(double dInput);
+    std::wstring sOutputFloat(double dInput);
+    void         vAppendNumber(double dInput, std::wstring* psOutput);
+    void         vAppendHexInt(double dInput, std::wstring* psOutput);
+    void         vAppendHexFloat(double dInput, std::wstring* psOutput);
+    void         vAppendBin(double dInput, std::wstring* psOutput);
+    void         vAppendInt(double dInput, std::wstring* psOutput);
+    void         vAppendFloat(double dInput, std::wstring* psOutput);
+    void         vAppendHexInt(INT64 s64Input, std::wstring* psOutput);
+    void         vAppendBin(INT64 s64Input, std::wstring* psOutput);
+    void         vAppendInt(INT64 s64Input, std::wstring* psOutput);
+    void         vAppendUInt(UINT64 u64Input, std::wstring* psOutput);
+    static bool  isInteger(double dInput);
+private:
+    INT32        m_s32Precision;
+    void         vWiden(const char* pszInput, std::wstring* psOutput);
+};
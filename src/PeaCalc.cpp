@@ -50,7 +50,7 @@ HWND            hWndMain;
 HWND            hWndEdit;
 WCHAR           szAppName[]    = TEXT("PeaCalc Portable");
 const WCHAR     cszwHelpText[] = TEXT("  * This program comes with ABSOLUTELY NO WARRANTY.\r\n  * It is free software; you can redistribute it and/or modify it\r\n  * under the terms of the GNU General Public License version 3,\r\n  * or (at your option) any later version; type 'license' for details.\r\n  * Type 'info' for this notification.\r\n  * Type 'help' for the user-manual.\r\n> ");
-WCHAR           pszwInfoText[C_TEXTBUFSIZE];
+std::wstring    sInfoText;
 WNDPROC         lpfnEditBoxLowProc;
 CConfigHandler  Config;
 CCommandHandler Command(&Config);
@@ -59,9 +59,9 @@ CCommandHandler Command(&Config);
 
 LRESULT CALLBACK WndProc        (HWND, UINT, WPARAM, LPARAM);
 LRESULT CALLBACK EditBoxProc    (HWND, UINT, WPARAM, LPARAM);
-void vDoTabScan(bool bDir, bool bReScan);
-void vCreateInfoText (WCHAR* pszwOutput);
-void vAddVersionInfo (WCHAR* pszwOutput, const WCHAR* pszwEntry);
+void vCreateInfoText (std::wstring* psOutput);
+void vAddVersionInfo (std::wstring* psOutput, const WCHAR* pszwEntry);
+void vShowProgress   (HWND hwnd);
 
 /** Helper Functions for Colors: ******************************************************/
 
@@ -84,9 +84,9 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
     /** Change the application-title if portable:                                     */
     if (!Config.bIsPortable()) szAppName[7] = 0;
     /** Create the info-text and make it available to the command-handler:            */
-    vCreateInfoText(pszwInfoText);
+    vCreateInfoText(&sInfoText);
     UpdateColorSettings(); // Initialize colors
-    Command.vSetInfoText(pszwInfoText);
+    Command.vSetInfoText(sInfoText);
     /** Prepare Window-Class:                                                         */
 	wndclass.cbSize        = sizeof(WNDCLASSEX);
     wndclass.style = CS_HREDRAW | CS_VREDRAW;
@@ -142,6 +142,8 @@ HWND CreateEditBox(HWND hOwner, WPARAM wParam, LPARAM lParam) {
          MessageBox(hOwner, L"Could not create RichEdit control.", L"Error", MB_OK);
          return NULL;
     }
+    /** Lift the limit of 32767 characters, thus long sessions are not cut off:       */
+    SendMessage(hWndEdit, EM_EXLIMITTEXT, 0, C_TEXTLIMIT);
     /** Overwrite its message-procedure and conserve the low-level one:               */
     lpfnEditBoxLowProc = (WNDPROC)SetWindowLongPtr(hWndEdit,GWLP_WNDPROC,(LONG_PTR)EditBoxProc );
     /** Set the font of the edit-box:                                                 */
@@ -171,7 +173,7 @@ HWND CreateEditBox(HWND hOwner, WPARAM wParam, LPARAM lParam) {
 void CloseMain(HWND hwnd, WPARAM wParam, LPARAM lParam) {
     /** Variables:                                                                    */
     RECT         rcWind;
-    TCHAR        buffer[C_TEXTBUFSIZE];
+    int          iLength;
     /** Get the windo-dimensions and store them:                                      */
     GetWindowRect(hwnd    , &rcWind);
     Config.iTop    = rcWind.top;
@@ -179,8 +181,11 @@ void CloseMain(HWND hwnd, WPARAM wParam, LPARAM lParam) {
     Config.iHeight = (rcWind.bottom - rcWind.top);
     Config.iWidth  = (rcWind.right - rcWind.left);
     /** Get the edit-text and store it:                                               */
-    GetWindowText(hWndEdit, buffer, sizeof(buffer));
-    Config.sText   = std::wstring(buffer);
+    iLength = GetWindowTextLength(hWndEdit);
+    Config.sText.resize(iLength + 1);
+    Config.sText.resize(GetWindowText(hWndEdit, &Config.sText[0], iLength + 1));
+    /** Stop a running calculation, its result would have no window anymore:          */
+    Command.vStopWorker();
     /** And send a quit message to the application:                                   */
     PostQuitMessage(0);
 }
@@ -235,6 +240,14 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
             }
         }
         break;
+    case WM_CALCDONE:
+        /** The worker has finished inputs, show them and update the title:           */
+        Command.vProcResults(hWndEdit);
+        vShowProgress(hwnd);
+        return 0;
+    case WM_TIMER:
+        if (wParam == C_TIMER_Progress) vShowProgress(hwnd);
+        return 0;
     case WM_CTLCOLOREDIT:
     case WM_CTLCOLORSTATIC:
         SetTextColor((HDC)wParam, cTxtColor);
@@ -248,6 +261,16 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
     return DefWindowProc(hwnd, message, wParam, lParam);
 }
 
+/** Shows the progress of the worker in the title: ************************************
+ *    The timer runs while there is work left, the title is restored afterwards:      */
+
+void vShowProgress(HWND hwnd) {
+    /** Variables:                                                                    */
+    std::wstring sStatus;
+    if (!Command.bGetStatus(&sStatus)) KillTimer(hwnd, C_TIMER_Progress);
+    SetWindowText(hwnd, (szAppName + sStatus).c_str());
+}
+
 /** Edit-Box Message-Handler: *********************************************************/
 
 LRESULT CALLBACK EditBoxProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
@@ -265,12 +288,17 @@ LRESULT CALLBACK EditBoxProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lPar
             /** It is, so check if there has been scanning before:                    */
             if (!bScanActive) {
                 bScanActive = true;
-                vDoTabScan((GetKeyState(VK_SHIFT) < 0), true);
+                Command.vProcTab(hwnd, (GetKeyState(VK_SHIFT) < 0), true);
             } else {
-                vDoTabScan((GetKeyState(VK_SHIFT) < 0), false);
+                Command.vProcTab(hwnd, (GetKeyState(VK_SHIFT) < 0), false);
             }
             return 0;
         }
+        /** Check if it was ESC, which cancels the calculations:                      */
+        if (wParam == VK_ESCAPE) {
+            Command.vCancel();
+            return 0;
+        }
         /** Check if it was Enter:                                                    */
         if (wParam == VK_RETURN) {
             Command.vProcEnter(hWndMain, hwnd);
@@ -349,105 +377,22 @@ LRESULT CALLBACK EditBoxProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lPar
     return CallWindowProc(lpfnEditBoxLowProc, hwnd, message, wParam, lParam);
 }
 
-/** Support-function to handle the scanning with tab: *********************************/
-
-void vDoTabScan(bool bDir, bool bReScan) {
-    /** Variables: */
-    static WCHAR szwBoxText [C_TEXTBUFSIZE];
-    static WCHAR szwScanText[C_TEXTBUFSIZE];
-    static DWORD dwScanLen;
-    static DWORD dwSafeLine;
-    DWORD        dwScanLine;
-    DWORD        dwScanPos;
-    WCHAR        buffer[C_TEXTBUFSIZE];
-    DWORD        dwIndex;
-    /** Check, if rescan has to be done:                                              */
-    if (bReScan) {
-        /** It has to, so fetch the text and prepare the scan:                        */
-        GetWindowText(hWndEdit, szwBoxText, sizeof(szwBoxText));
-        /** Create the scan-string:                                                   */
-        dwIndex = Command.dwFindNthLastCR(szwBoxText, 1);
-        wcscpy(szwScanText, L"  ");
-        wcscat(szwScanText, &szwBoxText[dwIndex + 2]);
-        /** ... and init the numbers:                                                 */
-        dwScanLen = wcslen(szwScanText);
-        dwSafeLine = 1;
-    }
-    /** Scan according to parsing direction:                                          */
-    if (!bDir) {
-        /**                                                                           */
-        /** Scan Backwards:                                                           */
-        dwScanLine = dwSafeLine;
-        dwScanPos  = Command.dwFindNthLastCR(szwBoxText, dwScanLine);
-        /** Move to the character after the CR:                                       */
-        if (dwScanPos > 0) dwScanPos++;
-        /** Scan as long as not at the start yet:                                     */
-        do {
-            /** Search for the next CR up:                                            */
-            if (dwScanPos > 1) dwScanLine++;
-            dwScanPos = Command.dwFindNthLastCR(szwBoxText, dwScanLine);
-            /** Move to the character after the CR:                                   */
-            if (dwScanPos > 0) dwScanPos++;
-            /** ... and check:                                                        */
-        } while ((dwScanPos > 0) &&
-                 ((wcsncmp(&szwBoxText[dwScanPos], szwScanText, dwScanLen) != 0) ||
-                  (wcsncmp(&szwBoxText[dwScanPos], L"  =", 3) == 0) ||
-                  (wcsncmp(&szwBoxText[dwScanPos], L"  *", 3) == 0)));
-    }else {
-        /**                                                                           */
-        /** Scan Forwards:                                                            */
-        dwScanLine = dwSafeLine;
-        /** Scan as long as not at the last CR yet:                                   */
-        do {
-            /** Search for the next CR down:                                          */
-            if (dwScanLine > 1) dwScanLine--;
-            dwScanPos = Command.dwFindNthLastCR(szwBoxText, dwScanLine);
-            /** Move to the character after the CR:                                   */
-            if (dwScanPos > 0) dwScanPos++;
-            /** ... and check:                                                        */
-        } while ((dwScanLine > 1) &&
-                 ((wcsncmp(&szwBoxText[dwScanPos], szwScanText, dwScanLen) != 0) ||
-                  (wcsncmp(&szwBoxText[dwScanPos], L"  =", 3) == 0) ||
-                  (wcsncmp(&szwBoxText[dwScanPos], L"  *", 3) == 0)));
-    }
-    /**                                                                               */
-    /** Check, if something was found:                                                */
-    if (wcsncmp(&szwBoxText[dwScanPos], szwScanText, dwScanLen) == 0) {
-        /** Fetch the text from the found position onward:                            */
-        wcscpy(buffer, &szwBoxText[dwScanPos]);
-        /** Terminate it at the CR:                                                   */
-        dwIndex = 0;
-        while (buffer[dwIndex] != L'\r') dwIndex++;
-        buffer[dwIndex] = 0;
-        /** Copy it INTO the box-text:                                                */
-        dwIndex = Command.dwFindNthLastCR(szwBoxText, 1);
-        wcscpy(&szwBoxText[dwIndex + 2], &buffer[2]);
-        SetWindowText(hWndEdit, szwBoxText);
-        /** Set the selection after the last character:                               */
-        SendMessage(hWndEdit, EM_SETSEL, wcslen(szwBoxText), wcslen(szwBoxText));
-        /** Trigger a scroll:                                                         */
-        SendMessage(hWndEdit, EM_SCROLLCARET, 0, 0);
-        /** And store the newly found position for the next run:                      */
-        dwSafeLine = dwScanLine;
-    }
-}
-
 /** Support-function to build the info-text: ******************************************/
 
-void vCreateInfoText(WCHAR* pszwOutput) {
-    wcscpy(pszwOutput, L"  * ");
-    vAddVersionInfo(pszwOutput, L"InternalName");
-    wcscat(pszwOutput, L" ");
-    vAddVersionInfo(pszwOutput, L"FileVersion");
-    wcscat(pszwOutput, L", ");
-    vAddVersionInfo(pszwOutput, L"LegalCopyright");
-    wcscat(pszwOutput, L"\r\n");
-    wcscat(pszwOutput, cszwHelpText);
+void vCreateInfoText(std::wstring* psOutput) {
+    *psOutput = L"  * ";
+    vAddVersionInfo(psOutput, L"InternalName");
+    *psOutput += L" ";
+    vAddVersionInfo(psOutput, L"FileVersion");
+    *psOutput += L", ";
+    vAddVersionInfo(psOutput, L"LegalCopyright");
+    *psOutput += L"\r\n";
+    *psOutput += cszwHelpText;
 }
 
 /** Support-function to fetch info from the version-resource: *************************/
 
-void vAddVersionInfo(WCHAR* pszwOutput, const WCHAR* pszwEntry) {
+void vAddVersionInfo(std::wstring* psOutput, const WCHAR* pszwEntry) {
     /** Variables:                                                                    */
     DWORD   vLen, langD;
     BOOL    retVal;
@@ -479,7 +424,7 @@ void vAddVersionInfo(WCHAR* pszwOutput, const WCHAR* pszwEntry) {
                         GetUserDefaultLangID(), pszwEntry);
                 }
                 if (VerQueryValue(versionInfo, fileEntry, &retbuf, (UINT *)&vLen)) {
-                    wcscat(pszwOutput, (WCHAR*)retbuf);
+                    *psOutput += (WCHAR*)retbuf;
                 }
             }
         }
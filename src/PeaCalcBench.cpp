@@ -0,0 +1,377 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <new>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Term.h"
+#include "NumFormat.h"
+#include "Calculator.h"
+
+/** Used Defines: *********************************************************************/
+
+#define C_BENCH_Format      1            // Version of the JSON-layout
+#define C_BENCH_Seed        0x5EA5EEDULL
+#define C_BENCH_CorpusSize  256          // Expressions per corpus
+#define C_BENCH_SweepLen    4096         // Points per sample of a sweep
+#define C_BENCH_MinSamples  50
+#define C_BENCH_MaxSamples  200000
+#define C_BENCH_DefTimeMs   250          // Minimum time per benchmark
+
+#if defined(__clang__)
+#define C_BENCH_Compiler    "clang " __clang_version__
+#elif defined(__GNUC__)
+#define C_BENCH_Compiler    "gcc " __VERSION__
+#elif defined(_MSC_VER)
+#define C_BENCH_Compiler    "msvc"
+#else
+#define C_BENCH_Compiler    "unknown"
+#endif
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct {
+    std::string sName;
+    UINT64      u64Ops;
+    size_t      uSamples;
+    double      dNsPerOp;
+    double      dP50, dP90, dP99, dMin;
+    double      dAllocsPerOp;
+} tBenchResult;
+
+typedef struct {
+    std::string               sName;
+    std::vector<std::wstring> Func;          // Expressions in x, for CTerm
+    std::vector<std::wstring> Input;         // Constant inputs, for the calculator
+} tBenchCorpus;
+
+/** Allocation-Counter: ***************************************************************
+ *    Replaces the global operators, thus every allocation of the library and the     *
+ *    standard containers is counted. The benchmark is single-threaded:               */
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static UINT64 g_u64Allocs = 0;
+
+void* operator new(size_t uSize) {
+    void* pMem = malloc((uSize != 0) ? uSize : 1);
+    if (pMem == NULL) throw std::bad_alloc();
+    g_u64Allocs++;
+    return pMem;
+}
+void* operator new[](size_t uSize) {
+    return operator new(uSize);
+}
+void operator delete(void* pMem) noexcept {
+    free(pMem);
+}
+void operator delete[](void* pMem) noexcept {
+    free(pMem);
+}
+void operator delete(void* pMem, size_t) noexcept {
+    free(pMem);
+}
+void operator delete[](void* pMem, size_t) noexcept {
+    free(pMem);
+}
+
+/** Random-Generator: *****************************************************************
+ *    SplitMix64, which gives the same corpora with every compiler and platform:      */
+
+class CBenchRandom {
+public:
+    CBenchRandom(UINT64 u64Seed) { m_u64State = u64Seed; }
+    UINT32 u32Next(UINT32 u32Range) {
+        UINT64 u64Z = (m_u64State += 0x9E3779B97F4A7C15ULL);
+        u64Z = (u64Z ^ (u64Z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        u64Z = (u64Z ^ (u64Z >> 27)) * 0x94D049BB133111EBULL;
+        return (UINT32) ((u64Z ^ (u64Z >> 31)) % u32Range);
+    }
+private:
+    UINT64 m_u64State;
+};
+
+/** Local Functions: ******************************************************************/
+
+/** Corpus-Builders: ******************************************************************
+ *    Each builder takes the text used for x, thus the same shapes serve as function  *
+ *    for CTerm and as constant input for the calculator:                             */
+
+static std::wstring sNumber(CBenchRandom& Rnd) {
+    if (Rnd.u32Next(3) == 0) return std::to_wstring(Rnd.u32Next(1000)) + L"." + std::to_wstring(Rnd.u32Next(100));
+    return std::to_wstring(1 + Rnd.u32Next(99));
+}
+
+static std::wstring sOperand(CBenchRandom& Rnd, const std::wstring& sVar) {
+    return (Rnd.u32Next(3) == 0) ? sVar : sNumber(Rnd);
+}
+
+static std::wstring sOperator(CBenchRandom& Rnd) {
+    static const WCHAR* apszwOps[] = { L"+", L"-", L"*", L"/" };
+    return apszwOps[Rnd.u32Next(4)];
+}
+
+static std::wstring sBuildShort(CBenchRandom& Rnd, const std::wstring& sVar) {
+    std::wstring sExpr = sOperand(Rnd, sVar) + sOperator(Rnd) + sOperand(Rnd, sVar);
+    if (Rnd.u32Next(2) == 0) sExpr += sOperator(Rnd) + sNumber(Rnd);
+    return sExpr;
+}
+
+static std::wstring sBuildLong(CBenchRandom& Rnd, const std::wstring& sVar) {
+    std::wstring sExpr = sOperand(Rnd, sVar);
+    for (int iTerm = 0; iTerm < 60; iTerm++) sExpr += sOperator(Rnd) + sOperand(Rnd, sVar);
+    return sExpr;
+}
+
+static std::wstring sBuildNested(CBenchRandom& Rnd, const std::wstring& sVar) {
+    std::wstring sExpr = sOperand(Rnd, sVar);
+    for (int iDepth = 0; iDepth < 40; iDepth++) {
+        sExpr = L"(" + sExpr + sOperator(Rnd) + sOperand(Rnd, sVar) + L")";
+    }
+    return sExpr;
+}
+
+static std::wstring sBuildTrig(CBenchRandom& Rnd, const std::wstring& sVar) {
+    static const WCHAR* apszwFuncs[] = { L"sin", L"cos", L"tan", L"atan", L"log" };
+    std::wstring sExpr;
+    for (int iTerm = 0; iTerm < 4; iTerm++) {
+        if (iTerm > 0) sExpr += sOperator(Rnd);
+        sExpr += apszwFuncs[Rnd.u32Next(5)] + std::wstring(L"(") + sVar + L"*" + sNumber(Rnd) + L"+1)";
+        if (Rnd.u32Next(3) == 0) sExpr += L"^2";
+    }
+    return sExpr;
+}
+
+static std::wstring sBuildBool(CBenchRandom& Rnd, const std::wstring& sVar) {
+    static const WCHAR* apszwOps[] = { L"&", L"|" };
+    std::wstring sExpr = std::to_wstring(Rnd.u32Next(1 << 20));
+    for (int iTerm = 0; iTerm < 5; iTerm++) {
+        sExpr += apszwOps[Rnd.u32Next(2)];
+        if (Rnd.u32Next(3) == 0) sExpr += L"~";
+        sExpr += (Rnd.u32Next(4) == 0) ? sVar : std::to_wstring(Rnd.u32Next(1 << 20));
+    }
+    return sExpr;
+}
+
+static std::wstring sBuildHexBin(CBenchRandom& Rnd, const std::wstring& sVar) {
+    WCHAR szwHex[16];
+    swprintf(szwHex, 16, L"0x%X", Rnd.u32Next(1 << 16));
+    return std::wstring(szwHex) + L"+0b1011*" + sVar + L"-" + std::to_wstring(Rnd.u32Next(100));
+}
+
+/** Builds a corpus from a builder. Hex/bin inputs get their output-format: ***********/
+
+static tBenchCorpus tBuildCorpus(const char* pszName, std::wstring (*pBuild)(CBenchRandom&, const std::wstring&), bool bFormat) {
+    tBenchCorpus tCorpus;
+    CBenchRandom RndFunc(C_BENCH_Seed);
+    CBenchRandom RndInput(C_BENCH_Seed);
+    tCorpus.sName = pszName;
+    for (size_t uIndex = 0; uIndex < C_BENCH_CorpusSize; uIndex++) {
+        tCorpus.Func.push_back(pBuild(RndFunc, L"x"));
+        std::wstring sInput = pBuild(RndInput, L"3");
+        if (bFormat) sInput = ((uIndex & 1) ? L"bin(" : L"hex(") + sInput + L")";
+        tCorpus.Input.push_back(sInput);
+    }
+    return tCorpus;
+}
+
+/** Measurement: **********************************************************************
+ *    Runs samples of uOpsPerSample operations, until the time is used up. The        *
+ *    percentiles are taken over the per-operation times of the samples:              */
+
+template <typename tFunc>
+static tBenchResult tMeasure(const std::string& sName, size_t uOpsPerSample, UINT32 u32TimeMs, tFunc Func) {
+    typedef std::chrono::steady_clock tClock;
+    tBenchResult        tResult;
+    std::vector<double> Samples;
+    UINT64              u64AllocStart;
+    double              dTotalNs = 0;
+    size_t              uSample;
+    /** Warm up the caches and the branch-predictor:                                  */
+    for (uSample = 0; uSample < 3; uSample++) Func(uSample);
+    Samples.reserve(C_BENCH_MaxSamples);
+    u64AllocStart = g_u64Allocs;
+    for (uSample = 0; uSample < C_BENCH_MaxSamples; uSample++) {
+        tClock::time_point tStart = tClock::now();
+        Func(uSample);
+        double dNs = std::chrono::duration<double, std::nano>(tClock::now() - tStart).count();
+        Samples.push_back(dNs / uOpsPerSample);
+        dTotalNs += dNs;
+        if ((uSample >= C_BENCH_MinSamples) && (dTotalNs >= u32TimeMs * 1e6)) break;
+    }
+    tResult.sName        = sName;
+    tResult.uSamples     = Samples.size();
+    tResult.u64Ops       = (UINT64) Samples.size() * uOpsPerSample;
+    tResult.dNsPerOp     = dTotalNs / tResult.u64Ops;
+    tResult.dAllocsPerOp = (double) (g_u64Allocs - u64AllocStart) / tResult.u64Ops;
+    std::sort(Samples.begin(), Samples.end());
+    tResult.dMin = Samples.front();
+    tResult.dP50 = Samples[(Samples.size() - 1) * 50 / 100];
+    tResult.dP90 = Samples[(Samples.size() - 1) * 90 / 100];
+    tResult.dP99 = Samples[(Samples.size() - 1) * 99 / 100];
+    return tResult;
+}
+
+/** Output: ***************************************************************************/
+
+static void vPrintResult(const tBenchResult& tResult) {
+    printf("%-26s %10.1f %10.1f %10.1f %10.1f %8.2f\n", tResult.sName.c_str(), tResult.dNsPerOp,
+           tResult.dP50, tResult.dP90, tResult.dP99, tResult.dAllocsPerOp);
+    fflush(stdout);
+}
+
+static bool bWriteJson(const char* pszFileName, const std::vector<tBenchResult>& Results) {
+    FILE* fp = fopen(pszFileName, "w");
+    if (fp == NULL) return false;
+    fprintf(fp, "{\n  \"format\": %d,\n  \"compiler\": \"%s\",\n  \"seed\": %llu,\n  \"results\": [\n",
+            C_BENCH_Format, C_BENCH_Compiler, (unsigned long long) C_BENCH_Seed);
+    for (size_t uIndex = 0; uIndex < Results.size(); uIndex++) {
+        const tBenchResult& tRes = Results[uIndex];
+        fprintf(fp, "    {\"name\": \"%s\", \"ops\": %llu, \"samples\": %u, \"ns_per_op\": %.2f, "
+                    "\"p50_ns\": %.2f, \"p90_ns\": %.2f, \"p99_ns\": %.2f, \"min_ns\": %.2f, \"allocs_per_op\": %.3f}%s\n",
+                tRes.sName.c_str(), (unsigned long long) tRes.u64Ops, (unsigned) tRes.uSamples, tRes.dNsPerOp,
+                tRes.dP50, tRes.dP90, tRes.dP99, tRes.dMin, tRes.dAllocsPerOp,
+                (uIndex + 1 < Results.size()) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return true;
+}
+
+/** Main Function: ********************************************************************
+ *    peacalc-bench [--json file] [--filter text] [--time ms] [--no-jit]              */
+
+int main(int argc, char** argv) {
+    /** Variables:                                                                    */
+    std::vector<tBenchCorpus> Corpora;
+    std::vector<tBenchResult> Results;
+    const char*               pszJson   = NULL;
+    const char*               pszFilter = "";
+    UINT32                    u32TimeMs = C_BENCH_DefTimeMs;
+    bool                      bJit      = true;
+    int                       iArg;
+    /** Read the options:                                                             */
+    for (iArg = 1; iArg < argc; iArg++) {
+        if ((strcmp(argv[iArg], "--json") == 0) && (iArg + 1 < argc)) {
+            pszJson = argv[++iArg];
+        }else if ((strcmp(argv[iArg], "--filter") == 0) && (iArg + 1 < argc)) {
+            pszFilter = argv[++iArg];
+        }else if ((strcmp(argv[iArg], "--time") == 0) && (iArg + 1 < argc)) {
+            u32TimeMs = (UINT32) atoi(argv[++iArg]);
+        }else if (strcmp(argv[iArg], "--no-jit") == 0) {
+            bJit = false;
+        }else{
+            fprintf(stderr, "Usage: peacalc-bench [--json file] [--filter text] [--time ms] [--no-jit]\n");
+            return 2;
+        }
+    }
+    Corpora.push_back(tBuildCorpus("short",  sBuildShort,  false));
+    Corpora.push_back(tBuildCorpus("long",   sBuildLong,   false));
+    Corpora.push_back(tBuildCorpus("nested", sBuildNested, false));
+    Corpora.push_back(tBuildCorpus("trig",   sBuildTrig,   false));
+    Corpora.push_back(tBuildCorpus("bool",   sBuildBool,   false));
+    Corpora.push_back(tBuildCorpus("hexbin", sBuildHexBin, true));
+    printf("%-26s %10s %10s %10s %10s %8s\n", "benchmark", "ns/op", "p50", "p90", "p99", "allocs");
+    auto bSelected = [&](const std::string& sName) { return sName.find(pszFilter) != std::string::npos; };
+    auto vAdd      = [&](const tBenchResult& tResult) { vPrintResult(tResult); Results.push_back(tResult); };
+    /** Parser and executors for each corpus:                                         */
+    for (const tBenchCorpus& tCorpus : Corpora) {
+        std::vector<CTerm> Terms(tCorpus.Func.size());
+        std::vector<double> Input(C_BENCH_SweepLen), Output(C_BENCH_SweepLen);
+        std::vector<UINT8>  Status(C_BENCH_SweepLen);
+        for (size_t uIndex = 0; uIndex < Terms.size(); uIndex++) {
+            Terms[uIndex].vSetJit(bJit);
+            Terms[uIndex].s32Parse(tCorpus.Func[uIndex]);
+        }
+        for (size_t uIndex = 0; uIndex < Input.size(); uIndex++) Input[uIndex] = 0.5 + uIndex * 0.01;
+        CTerm TermParse;
+        std::string sName = "parse/" + tCorpus.sName;
+        if (bSelected(sName)) vAdd(tMeasure(sName, 16, u32TimeMs, [&](size_t uSample) {
+            for (size_t uOp = 0; uOp < 16; uOp++) TermParse.s32Parse(tCorpus.Func[(uSample * 16 + uOp) % tCorpus.Func.size()]);
+        }));
+        sName = "execute/" + tCorpus.sName;
+        if (bSelected(sName)) vAdd(tMeasure(sName, 256, u32TimeMs, [&](size_t uSample) {
+            CTerm& Term = Terms[uSample % Terms.size()];
+            for (size_t uOp = 0; uOp < 256; uOp++) Term.s32Execute(Input[uOp], &Output[uOp]);
+        }));
+        sName = "sweep/" + tCorpus.sName;
+        if (bSelected(sName)) vAdd(tMeasure(sName, C_BENCH_SweepLen, u32TimeMs, [&](size_t uSample) {
+            Terms[uSample % Terms.size()].s32ExecuteBatch(Input.data(), Output.data(), Status.data(), C_BENCH_SweepLen);
+        }));
+        sName = "procmath/" + tCorpus.sName;
+        CCalculator  Calc(64, C_FMT_DefPrecision);
+        std::wstring sResult;
+        if (bSelected(sName)) vAdd(tMeasure(sName, 16, u32TimeMs, [&](size_t uSample) {
+            for (size_t uOp = 0; uOp < 16; uOp++) {
+                sResult.clear();
+                Calc.vProcMath(tCorpus.Input[(uSample * 16 + uOp) % tCorpus.Input.size()], &sResult);
+            }
+        }));
+    }
+    /** The arbitrary precision at interactive sizes:                                 */
+    CCalculator CalcPrec(64, C_FMT_DefPrecision);
+    for (const char* pszDigits : { "50", "500" }) {
+        std::string  sName = std::string("prec/") + pszDigits;
+        std::wstring sInput, sResult;
+        sInput = L"prec(" + std::wstring(pszDigits, pszDigits + strlen(pszDigits)) + L", sin(1) + e^2 / 3 + log(7) + atan(0.5) + √2)";
+        if (bSelected(sName)) vAdd(tMeasure(sName, 1, u32TimeMs, [&](size_t) {
+            sResult.clear();
+            CalcPrec.vProcMath(sInput, &sResult);
+        }));
+    }
+    /** The formatters, each on its own:                                              */
+    CNumFormat Format(C_FMT_DefPrecision);
+    std::vector<double> Values(256);
+    CBenchRandom Rnd(C_BENCH_Seed);
+    for (double& dValue : Values) dValue = (double) Rnd.u32Next(1 << 30) / (1 + Rnd.u32Next(1000));
+    struct {
+        const char*  pszName;
+        std::wstring (*pFormat)(CNumFormat&, double);
+    } aFormats[] = {
+        { "format/int",      [](CNumFormat& F, double d) { return F.sOutputInt(floor(d)); }    },
+        { "format/float",    [](CNumFormat& F, double d) { return F.sOutputFloat(d); }         },
+        { "format/number",   [](CNumFormat& F, double d) { return F.sOutputNumber(d); }        },
+        { "format/hexint",   [](CNumFormat& F, double d) { return F.sOutputHexInt(floor(d)); } },
+        { "format/hexfloat", [](CNumFormat& F, double d) { return F.sOutputHexFloat(d); }      },
+        { "format/bin",      [](CNumFormat& F, double d) { return F.sOutputBin(floor(d)); }    },
+    };
+    for (const auto& tFormat : aFormats) {
+        if (!bSelected(tFormat.pszName)) continue;
+        vAdd(tMeasure(tFormat.pszName, 64, u32TimeMs, [&](size_t uSample) {
+            for (size_t uOp = 0; uOp < 64; uOp++) {
+                tFormat.pFormat(Format, Values[(uSample * 64 + uOp) % Values.size()]);
+            }
+        }));
+    }
+    if ((pszJson != NULL) && (!bWriteJson(pszJson, Results))) {
+        fprintf(stderr, "Cannot write %s\n", pszJson);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Term.h"
+#include "NumFormat.h"
+#include "Calculator.h"
+#include "WorkerPool.h"
+#include "StreamEval.h"
+
+/** Used Defines: *********************************************************************/
+
+#define C_CLI_CacheSize   64
+
+/** Local Functions: ******************************************************************/
+
+static void vUsage(void) {
+    fprintf(stderr, "Usage: peacalc-cli [-p precision] [-j threads] [-n nodes] [-d depth] [-t ms] [-x|-b] [-f file]... [expression]\n");
+    fprintf(stderr, "  Without an expression, each line of the files or of stdin is calculated.\n");
+    fprintf(stderr, "  -j  worker threads for the lines, default is one per core\n");
+    fprintf(stderr, "  -n  maximum nodes of a term, -d its maximum nesting-depth\n");
+    fprintf(stderr, "  -t  time limit of each input in milliseconds, default 0 is none\n");
+    fprintf(stderr, "  -x  print integer results as hex(, -b as bin(\n");
+    fprintf(stderr, "  -f  file with one expression per line, - is stdin\n");
+}
+
+/** Main Function: ********************************************************************
+ *    Calculates the expression given on the command-line, or each line of the        *
+ *    files or of stdin. Returns 1, if any of the inputs failed:                      */
+
+int main(int argc, char** argv) {
+    /** Variables:                                                                    */
+    std::vector<const char*> Files;
+    std::string              sExpression;
+    INT32                    s32Precision = C_FMT_DefPrecision;
+    UINT32                   u32Format    = C_CALC_FormatAuto;
+    UINT32                   u32Threads   = 0;
+    tTermBudget              tBudget      = {C_TERM_DefMaxNodes, C_TERM_DefMaxDepth, 0};
+    bool                     bFailed      = false;
+    int                      iArg;
+    /** Read the options, all the rest is the expression:                             */
+    for (iArg = 1; iArg < argc; iArg++) {
+        if ((strcmp(argv[iArg], "-p") == 0) && (iArg + 1 < argc)) {
+            s32Precision = atoi(argv[++iArg]);
+            if ((s32Precision < 1) || (s32Precision > C_FMT_MaxPrecision + 1)) {
+                vUsage();
+                return 2;
+            }
+        }else if ((strcmp(argv[iArg], "-j") == 0) && (iArg + 1 < argc)) {
+            if (atoi(argv[++iArg]) < 1) {
+                vUsage();
+                return 2;
+            }
+            u32Threads = (UINT32) atoi(argv[iArg]);
+        }else if ((strcmp(argv[iArg], "-n") == 0) && (iArg + 1 < argc)) {
+            if ((atoi(argv[++iArg]) < 1) || (atoi(argv[iArg]) > C_TERM_MaxNodes)) {
+                vUsage();
+                return 2;
+            }
+            tBudget.u32MaxNodes = (UINT32) atoi(argv[iArg]);
+        }else if ((strcmp(argv[iArg], "-d") == 0) && (iArg + 1 < argc)) {
+            if (atoi(argv[++iArg]) < 1) {
+                vUsage();
+                return 2;
+            }
+            tBudget.u32MaxDepth = (UINT32) atoi(argv[iArg]);
+        }else if ((strcmp(argv[iArg], "-t") == 0) && (iArg + 1 < argc)) {
+            if (atoi(argv[++iArg]) < 0) {
+                vUsage();
+                return 2;
+            }
+            tBudget.u32TimeLimit = (UINT32) atoi(argv[iArg]);
+        }else if ((strcmp(argv[iArg], "-f") == 0) && (iArg + 1 < argc)) {
+            Files.push_back(argv[++iArg]);
+        }else if (strcmp(argv[iArg], "-x") == 0) {
+            u32Format = C_CALC_FormatHex;
+        }else if (strcmp(argv[iArg], "-b") == 0) {
+            u32Format = C_CALC_FormatBin;
+        }else if ((strcmp(argv[iArg], "-h") == 0) || (strcmp(argv[iArg], "--help") == 0)) {
+            vUsage();
+            return 0;
+        }else{
+            if (!sExpression.empty()) sExpression += ' ';
+            sExpression += argv[iArg];
+        }
+    }
+    /** A single expression from the command-line:                                    */
+    if (!sExpression.empty()) {
+        CCalculator  Calc(C_CLI_CacheSize, s32Precision);
+        std::wstring sInput;
+        std::wstring sResult;
+        std::string  sOutput;
+        if (!Files.empty()) {
+            vUsage();
+            return 2;
+        }
+        Calc.vSetFormat(u32Format);
+        Calc.vSetBudget(tBudget);
+        CStreamEval::vFromUtf8(sExpression.data(), sExpression.length(), &sInput);
+        Calc.vProcMath(sInput, &sResult);
+        CStreamEval::vToUtf8(sResult, &sOutput);
+        fputs(sOutput.c_str(), stdout);
+        return Calc.bLastFailed() ? 1 : 0;
+    }
+    /** Otherwise stream through the files, or stdin:                                 */
+    if (Files.empty()) Files.push_back("-");
+    CStreamEval Stream(u32Threads, C_CLI_CacheSize, s32Precision, u32Format);
+    Stream.vSetBudget(tBudget);
+    for (const char* pszFile : Files) {
+        FILE* pInput = (strcmp(pszFile, "-") == 0) ? stdin : fopen(pszFile, "rb");
+        if (pInput == NULL) {
+            fprintf(stderr, "peacalc-cli: cannot open %s\n", pszFile);
+            bFailed = true;
+            continue;
+        }
+        if (!Stream.bRun(pInput, stdout)) {
+            fprintf(stderr, "peacalc-cli: i/o error on %s\n", pszFile);
+            bFailed = true;
+        }
+        if (pInput != stdin) fclose(pInput);
+    }
+    return (bFailed || (Stream.u64GetFailed() > 0)) ? 1 : 0;
+}
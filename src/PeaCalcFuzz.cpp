@@ -0,0 +1,459 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include "Term.h"
+#include "TermSymbols.h"
+#include "BigFloat.h"
+#include "NumFormat.h"
+#include "Calculator.h"
+#include "WorkerPool.h"
+#include "StreamEval.h"
+
+/** Used Defines: *********************************************************************/
+
+#define C_FUZZ_Seed         0xF0221EEDULL
+#define C_FUZZ_DefCount     20000        // Generated terms without input-files
+#define C_FUZZ_MaxInput     4096         // Longer inputs are cut, they only slow down
+#define C_FUZZ_MaxDepth     5            // Nesting of the generated terms
+#define C_FUZZ_BigDigits    60           // Enough for any product of two INT64
+#define C_FUZZ_RandomInputs 128          // Random values of x besides the special ones
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct {
+    UINT64 u64Magnitude;
+    bool   bNeg;
+    bool   bValid;                // The magnitude fits into 64 bits
+} tFuzzInt;
+
+/** Random-Generator: *****************************************************************
+ *    SplitMix64 like in peacalc-bench, thus a seed gives the same terms everywhere:  */
+
+class CFuzzRandom {
+public:
+    CFuzzRandom(UINT64 u64Seed) { m_u64State = u64Seed; }
+    UINT64 u64Next(void) {
+        UINT64 u64Z = (m_u64State += 0x9E3779B97F4A7C15ULL);
+        u64Z = (u64Z ^ (u64Z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        u64Z = (u64Z ^ (u64Z >> 27)) * 0x94D049BB133111EBULL;
+        return u64Z ^ (u64Z >> 31);
+    }
+    UINT32 u32Next(UINT32 u32Range) { return (UINT32) (u64Next() % u32Range); }
+private:
+    UINT64 m_u64State;
+};
+
+/** Variables: ************************************************************************/
+
+static CTermSymbols*       g_pSymbols = NULL;
+static std::vector<double> g_Inputs;
+static std::vector<double> g_Warmup;
+static UINT64              g_u64Checked = 0;
+static UINT64              g_u64Parsed  = 0;
+
+/** Local Functions: ******************************************************************/
+
+/** Sets up the symbols and the values of x, which every term is checked with. The    *
+ *  values include the edges of the boolean operators and of the integers. The        *
+ *  random ones have random bits, thus any exponent, half of them are around 1:       */
+
+static void vInit(void) {
+    /** Variables:                                                                    */
+    static const WCHAR* apszDefinitions[] = { L"a = 3", L"b = a * 2 - 0.5", L"f(u) = u * u + a", L"g(u, v) = u / v - x" };
+    static const double adSpecial[] = { 0.7, 0, -0.0, 3, -2.5, 1e300, -1e300, NAN, INFINITY, -INFINITY, 1, -1, 0.5, 2,
+                                        1e-310, 4503599627370496.0, -4503599627370495.0, 123456.75, 1e16, -7, 10 };
+    std::vector<UINT32> Updated;
+    UINT32              u32Symbol;
+    UINT32              u32Input;
+    UINT64              u64Bits;
+    double              dInput;
+    CFuzzRandom         Rnd(C_FUZZ_Seed);
+    if (g_pSymbols != NULL) return;
+    g_pSymbols = new CTermSymbols();
+    for (const WCHAR* pszDefinition : apszDefinitions) g_pSymbols->s32Define(pszDefinition, &u32Symbol, &Updated);
+    g_Inputs.assign(adSpecial, adSpecial + sizeof(adSpecial) / sizeof(adSpecial[0]));
+    for (INT32 s32Step = -50; s32Step <= 50; s32Step++) g_Inputs.push_back(s32Step * 0.173);
+    for (u32Input = 0; u32Input < C_FUZZ_RandomInputs; u32Input++) {
+        u64Bits = Rnd.u64Next();
+        if (u32Input % 2) u64Bits = (u64Bits & 0x800FFFFFFFFFFFFFULL) | ((UINT64) (1023 - 32 + Rnd.u32Next(64)) << 52);
+        memcpy(&dInput, &u64Bits, sizeof(double));
+        g_Inputs.push_back(dInput);
+    }
+    g_Warmup.assign(C_TERM_JitThreshold, 0.25);
+}
+
+/** Compares a result with the one of the reference. Both have to fail the same way,  *
+ *  or give the same bits. NaNs need the same sign, which is printed, their payload   *
+ *  is not defined:                                                                   */
+
+static bool bSame(INT32 s32Ref, double dRef, INT32 s32Res, double dRes) {
+    if (s32Ref != s32Res) return false;
+    if (s32Ref != C_TERM_NumOK) return true;
+    if (isnan(dRef) && isnan(dRes)) return signbit(dRef) == signbit(dRes);
+    return memcmp(&dRef, &dRes, sizeof(double)) == 0;
+}
+
+/** Reports a disagreement and aborts, thus every fuzzer keeps the input: *************/
+
+static void vFail(const std::wstring& sInput, const char* pszExecutor, double dX, INT32 s32Ref, double dRef, INT32 s32Res, double dRes) {
+    std::string sText;
+    CStreamEval::vToUtf8(sInput, &sText);
+    fprintf(stderr, "Mismatch of %s for \"%s\" at x = %.17g:\n", pszExecutor, sText.c_str(), dX);
+    fprintf(stderr, "  reference %d %.17g, got %d %.17g\n", (int) s32Ref, dRef, (int) s32Res, dRes);
+    abort();
+}
+
+/** Integer-Reference: ****************************************************************
+ *    Walks the parse-tree on sign and magnitude, independent of the 64-bit wrapping  *
+ *    of s32ExecuteInt. The boolean operators take the operands as 64-bit patterns,   *
+ *    from 2^63 on as unsigned ones, and give an unsigned result, if one of them      *
+ *    was unsigned and the top bit is set. Returns false, if the term is not          *
+ *    integer-typed. pbExact tells, if + - * stayed within INT64, thus if             *
+ *    s32ExecuteInt has to succeed:                                                   */
+
+static void vFuzzFromPattern(UINT64 u64Pattern, bool bUnsigned, tFuzzInt* pValue) {
+    pValue->bValid       = true;
+    pValue->bNeg         = (!bUnsigned) && (u64Pattern >> 63);
+    pValue->u64Magnitude = pValue->bNeg ? (0 - u64Pattern) : u64Pattern;
+}
+
+static bool bFuzzFitsInt64(const tFuzzInt& tValue) {
+    if (!tValue.bValid) return false;
+    return tValue.bNeg ? (tValue.u64Magnitude <= 0x8000000000000000ULL) : (tValue.u64Magnitude < 0x8000000000000000ULL);
+}
+
+static void vFuzzAdd(const tFuzzInt& tPar1, const tFuzzInt& tPar2, tFuzzInt* pResult) {
+    pResult->bValid = tPar1.bValid && tPar2.bValid;
+    if (tPar1.bNeg == tPar2.bNeg) {
+        pResult->u64Magnitude = tPar1.u64Magnitude + tPar2.u64Magnitude;
+        pResult->bNeg         = tPar1.bNeg;
+        if (pResult->u64Magnitude < tPar1.u64Magnitude) pResult->bValid = false;
+    }else if (tPar1.u64Magnitude >= tPar2.u64Magnitude) {
+        pResult->u64Magnitude = tPar1.u64Magnitude - tPar2.u64Magnitude;
+        pResult->bNeg         = tPar1.bNeg;
+    }else{
+        pResult->u64Magnitude = tPar2.u64Magnitude - tPar1.u64Magnitude;
+        pResult->bNeg         = tPar2.bNeg;
+    }
+    if (pResult->u64Magnitude == 0) pResult->bNeg = false;
+}
+
+static double dFuzzValue(const tFuzzInt& tValue) {
+    return tValue.bNeg ? -(double) tValue.u64Magnitude : (double) tValue.u64Magnitude;
+}
+
+static bool bFuzzIntegerTerm(const std::vector<tTermNode>& Body, tFuzzInt* pValue, bool* pbExact) {
+    /** Variables:                                                                    */
+    std::vector<tFuzzInt> Values(Body.size());
+    tFuzzInt              tPar1, tPar2;
+    UINT64                u64Par1, u64Par2, u64Result;
+    double                dValue;
+    bool                  bUnsigned;
+    size_t                uNode;
+    *pbExact = true;
+    /** Operands precede their operations in the arena:                               */
+    for (uNode = 0; uNode < Body.size(); uNode++) {
+        const tTermNode& tNode = Body[uNode];
+        tFuzzInt*        pNode = &Values[uNode];
+        switch (tNode.u32Operator) {
+        case C_TERM_CmdConstant:
+        case C_TERM_CmdVariable:
+            /** Integer-literals are exact, other integers up to 2^53:                */
+            if (tNode.bInteger) {
+                vFuzzFromPattern((UINT64) tNode.s64Var, true, pNode);
+                break;
+            }
+            dValue = (tNode.u32Operator == C_TERM_CmdVariable) ? g_pSymbols->dGetValue((UINT32) tNode.s64Var) : tNode.dVar;
+            if (!((fabs(dValue) <= C_TERM_ExactInt) && (dValue == trunc(dValue)))) return false;
+            pNode->bValid       = true;
+            pNode->bNeg         = (dValue < 0);
+            pNode->u64Magnitude = (UINT64) fabs(dValue);
+            break;
+        case C_TERM_CmdAddition:
+        case C_TERM_CmdSubstraction:
+        case C_TERM_CmdMultiplication:
+            tPar1 = Values[tNode.u32Sub1];
+            tPar2 = Values[tNode.u32Sub2];
+            if (!bFuzzFitsInt64(tPar1) || !bFuzzFitsInt64(tPar2)) *pbExact = false;
+            if (tNode.u32Operator == C_TERM_CmdMultiplication) {
+                pNode->u64Magnitude = tPar1.u64Magnitude * tPar2.u64Magnitude;
+                pNode->bNeg         = (tPar1.bNeg != tPar2.bNeg) && (pNode->u64Magnitude != 0);
+                pNode->bValid       = tPar1.bValid && tPar2.bValid &&
+                                      ((tPar1.u64Magnitude == 0) || (pNode->u64Magnitude / tPar1.u64Magnitude == tPar2.u64Magnitude));
+            }else{
+                if (tNode.u32Operator == C_TERM_CmdSubstraction) tPar2.bNeg = (!tPar2.bNeg) && (tPar2.u64Magnitude != 0);
+                vFuzzAdd(tPar1, tPar2, pNode);
+            }
+            if (!bFuzzFitsInt64(*pNode)) *pbExact = false;
+            break;
+        case C_TERM_CmdOr:
+        case C_TERM_CmdAnd:
+        case C_TERM_CmdNeg:
+            /** Operands from -2^63 up to below 2^64, ~ only takes the second one:    */
+            tPar1 = Values[tNode.u32Sub1];
+            tPar2 = Values[tNode.u32Sub2];
+            if ((!tPar2.bValid) || (tPar2.bNeg && (tPar2.u64Magnitude > 0x8000000000000000ULL))) {
+                *pbExact = false;
+                pNode->bValid = false;
+                break;
+            }
+            u64Par2 = tPar2.bNeg ? (0 - tPar2.u64Magnitude) : tPar2.u64Magnitude;
+            if (tNode.u32Operator == C_TERM_CmdNeg) {
+                vFuzzFromPattern(~u64Par2, false, pNode);
+                break;
+            }
+            if ((!tPar1.bValid) || (tPar1.bNeg && (tPar1.u64Magnitude > 0x8000000000000000ULL))) {
+                *pbExact = false;
+                pNode->bValid = false;
+                break;
+            }
+            u64Par1   = tPar1.bNeg ? (0 - tPar1.u64Magnitude) : tPar1.u64Magnitude;
+            u64Result = (tNode.u32Operator == C_TERM_CmdOr) ? (u64Par1 | u64Par2) : (u64Par1 & u64Par2);
+            bUnsigned = (!bFuzzFitsInt64(tPar1) || !bFuzzFitsInt64(tPar2)) && (u64Result >> 63);
+            vFuzzFromPattern(u64Result, bUnsigned, pNode);
+            break;
+        default:
+            return false;
+        }
+    }
+    if (Body.empty()) return false;
+    *pValue = Values.back();
+    return true;
+}
+
+/** Differential Test: ****************************************************************
+ *    Parses the input and runs every executor on it. The tree-walker over the parsed *
+ *    nodes is the reference, before vOptimize changed them. The postfix-interpreter, *
+ *    the batches, the machine-code and the values of the dual numbers run on the     *
+ *    optimized code and have to give exactly the same bits. The integer-path is      *
+ *    checked against bFuzzIntegerTerm and CBigMath. The fast kernels are             *
+ *    approximations by design and not checked:                                       */
+
+static void vCheckTerm(const std::wstring& sInput) {
+    /** Variables:                                                                    */
+    CTerm               Reference, Term, Jit, Scratch;
+    std::vector<tTermNode>    Body;
+    std::vector<std::wstring> NoArguments;
+    std::vector<double> RefOutput(g_Inputs.size()), Output(g_Inputs.size()), Warmup(g_Warmup.size());
+    std::vector<INT32>  RefStatus(g_Inputs.size());
+    std::vector<UINT8>  Status(g_Inputs.size()), WarmupStatus(g_Warmup.size());
+    double              dOutput, dSlope;
+    tTermInt            tOutput;
+    tFuzzInt            tExpect, tValue;
+    bool                bExact;
+    INT32               s32Res;
+    size_t              uIndex;
+    g_u64Checked++;
+    Reference.vSetJit(false);
+    Reference.vSetOptimize(false);
+    Reference.vSetSymbols(g_pSymbols);
+    s32Res = Reference.s32Parse(sInput);
+    if ((s32Res != C_TERM_NumOK) && (s32Res != C_TERM_FuncOK)) return;
+    g_u64Parsed++;
+    Term.vSetJit(false);
+    Term.vSetSymbols(g_pSymbols);
+    Term.s32Parse(sInput);
+    Scratch.vSetSymbols(g_pSymbols);
+    /** The reference and the scalar interpreter:                                     */
+    for (uIndex = 0; uIndex < g_Inputs.size(); uIndex++) {
+        RefOutput[uIndex] = 0;
+        RefStatus[uIndex] = Reference.s32ExecuteTree(g_Inputs[uIndex], &RefOutput[uIndex]);
+        dOutput = 0;
+        s32Res  = Term.s32Execute(g_Inputs[uIndex], &dOutput);
+        if (!bSame(RefStatus[uIndex], RefOutput[uIndex], s32Res, dOutput)) {
+            vFail(sInput, "s32Execute", g_Inputs[uIndex], RefStatus[uIndex], RefOutput[uIndex], s32Res, dOutput);
+        }
+        dOutput = 0;
+        s32Res  = Term.s32ExecuteDual(g_Inputs[uIndex], &dOutput, &dSlope);
+        if (!bSame(RefStatus[uIndex], RefOutput[uIndex], s32Res, dOutput)) {
+            vFail(sInput, "s32ExecuteDual", g_Inputs[uIndex], RefStatus[uIndex], RefOutput[uIndex], s32Res, dOutput);
+        }
+    }
+    /** The batches of the interpreter:                                               */
+    Term.s32ExecuteBatch(g_Inputs.data(), Output.data(), Status.data(), g_Inputs.size());
+    for (uIndex = 0; uIndex < g_Inputs.size(); uIndex++) {
+        if (!bSame(RefStatus[uIndex], RefOutput[uIndex], Status[uIndex], Output[uIndex])) {
+            vFail(sInput, "s32ExecuteBatch", g_Inputs[uIndex], RefStatus[uIndex], RefOutput[uIndex], Status[uIndex], Output[uIndex]);
+        }
+    }
+    /** The same term once more, until it runs as machine-code:                       */
+    Jit.vSetSymbols(g_pSymbols);
+    Jit.s32Parse(sInput);
+    Jit.s32ExecuteBatch(g_Warmup.data(), Warmup.data(), WarmupStatus.data(), g_Warmup.size());
+    Jit.s32ExecuteBatch(g_Inputs.data(), Output.data(), Status.data(), g_Inputs.size());
+    for (uIndex = 0; uIndex < g_Inputs.size(); uIndex++) {
+        if (!bSame(RefStatus[uIndex], RefOutput[uIndex], Status[uIndex], Output[uIndex])) {
+            vFail(sInput, "machine-code batch", g_Inputs[uIndex], RefStatus[uIndex], RefOutput[uIndex], Status[uIndex], Output[uIndex]);
+        }
+        dOutput = 0;
+        s32Res  = Jit.s32Execute(g_Inputs[uIndex], &dOutput);
+        if (!bSame(RefStatus[uIndex], RefOutput[uIndex], s32Res, dOutput)) {
+            vFail(sInput, "machine-code", g_Inputs[uIndex], RefStatus[uIndex], RefOutput[uIndex], s32Res, dOutput);
+        }
+    }
+    /** An integer-term has to give the result of the reference and of CBigMath:      */
+    if (Scratch.s32ParseBody(sInput, NoArguments, &Body) != C_TERM_NumOK) return;
+    if (!bFuzzIntegerTerm(Body, &tExpect, &bExact)) return;
+    if (!Term.bIsInteger()) vFail(sInput, "vCompileInteger", 0, C_TERM_NumOK, dFuzzValue(tExpect), C_TERM_ParsingError, 0);
+    s32Res = Term.s32ExecuteInt(&tOutput);
+    if (s32Res != C_TERM_NumOK) {
+        if (bExact) vFail(sInput, "s32ExecuteInt", 0, C_TERM_NumOK, dFuzzValue(tExpect), s32Res, 0);
+        return;
+    }
+    vFuzzFromPattern((UINT64) tOutput.s64Value, tOutput.bUnsigned, &tValue);
+    if ((!bExact) || (tValue.bNeg != tExpect.bNeg) || (tValue.u64Magnitude != tExpect.u64Magnitude)) {
+        vFail(sInput, "s32ExecuteInt", 0, C_TERM_NumOK, dFuzzValue(tExpect), C_TERM_NumOK, dFuzzValue(tValue));
+    }
+    CTerm     Big;
+    CBigMath  Math(C_FUZZ_BigDigits);
+    tBigFloat tBig;
+    Big.vSetBig(true);
+    Big.vSetSymbols(g_pSymbols);
+    if ((Big.s32Parse(sInput) != C_TERM_NumOK) || (Big.s32ExecuteBig(&Math, &tBig) != C_TERM_NumOK) ||
+        (!Math.bToMagnitude(tBig, &tValue.u64Magnitude, &tValue.bNeg)) ||
+        (tValue.bNeg != tExpect.bNeg) || (tValue.u64Magnitude != tExpect.u64Magnitude)) {
+        vFail(sInput, "s32ExecuteBig", 0, C_TERM_NumOK, dFuzzValue(tExpect), C_TERM_NumOK, dFuzzValue(tValue));
+    }
+}
+
+/** Term-Generator: *******************************************************************
+ *    Builds mostly valid terms from all tokens, which the lexer knows, with some     *
+ *    defects thrown in, so the error-paths of the parser are taken as well:          */
+
+static std::wstring sGenerate(CFuzzRandom& Rnd, UINT32 u32Depth) {
+    /** Variables:                                                                    */
+    static const WCHAR* apszLeaves[]    = { L"x", L"e", L"pi", L"a", L"b", L"0", L"1", L"2", L"0.5", L"1e3", L"1E-3", L"30o",
+                                            L"0xFF", L"0b1011", L"4503599627370496", L"9223372036854775807", L".25",
+                                            L"0xFFFFFFFFFFFFFFFF", L"0x8000000000000000", L"3.0" };
+    static const WCHAR* apszOps[]       = { L"+", L"-", L"*", L"/", L"÷", L"√", L"^", L"&", L"|", L" log" };
+    static const WCHAR* apszFunctions[] = { L"sin", L"cos", L"tan", L"asin", L"acos", L"atan", L"log", L"f" };
+    static const WCHAR* apszDefects[]   = { L"(", L")", L",", L"", L"--", L"~", L"g(x)", L"1..2", L"#", L" " };
+    std::wstring sTerm;
+    UINT32       u32Kind = (u32Depth >= C_FUZZ_MaxDepth) ? 0 : Rnd.u32Next(8);
+    switch (u32Kind) {
+    case 0:
+    case 1:
+        sTerm = apszLeaves[Rnd.u32Next(sizeof(apszLeaves) / sizeof(apszLeaves[0]))];
+        break;
+    case 2:
+    case 3:
+    case 4:
+        sTerm = sGenerate(Rnd, u32Depth + 1) + apszOps[Rnd.u32Next(sizeof(apszOps) / sizeof(apszOps[0]))] + sGenerate(Rnd, u32Depth + 1);
+        break;
+    case 5:
+        sTerm = std::wstring(apszFunctions[Rnd.u32Next(sizeof(apszFunctions) / sizeof(apszFunctions[0]))]) + L"(" + sGenerate(Rnd, u32Depth + 1) + L")";
+        break;
+    case 6:
+        sTerm = std::wstring((Rnd.u32Next(2) == 0) ? L"-" : L"~") + sGenerate(Rnd, u32Depth + 1);
+        break;
+    default:
+        sTerm = L"(" + sGenerate(Rnd, u32Depth + 1) + L")";
+        break;
+    }
+    if (Rnd.u32Next(64) == 0) sTerm.insert(Rnd.u32Next((UINT32) sTerm.length() + 1), apszDefects[Rnd.u32Next(sizeof(apszDefects) / sizeof(apszDefects[0]))]);
+    return sTerm;
+}
+
+/** Checks one input of a fuzzer, which are bytes in UTF-8: ***************************/
+
+static void vCheckBytes(const UINT8* pu8Data, size_t uSize) {
+    std::wstring sInput;
+    if (uSize > C_FUZZ_MaxInput) uSize = C_FUZZ_MaxInput;
+    CStreamEval::vFromUtf8((const char*) pu8Data, uSize, &sInput);
+    vCheckTerm(sInput);
+}
+
+/** Public Functions: *****************************************************************/
+
+/** Entry-Point of libFuzzer: *********************************************************/
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* pu8Data, size_t uSize) {
+    vInit();
+    vCheckBytes(pu8Data, uSize);
+    return 0;
+}
+
+/** Main Function: ********************************************************************
+ *    peacalc-fuzz [--count n] [--seed n] [--lines] [file]...                         *
+ *    Without files, it checks generated terms. Each file is one input, like AFL and  *
+ *    the crash-files of libFuzzer give it, with --lines each line is one:            */
+
+#if !defined(C_FUZZ_LibFuzzer)
+int main(int argc, char** argv) {
+    /** Variables:                                                                    */
+    std::vector<const char*> Files;
+    std::vector<UINT8>       Data;
+    UINT64                   u64Seed  = C_FUZZ_Seed;
+    UINT32                   u32Count = C_FUZZ_DefCount;
+    bool                     bLines   = false;
+    size_t                   uStart, uEnd;
+    int                      iArg, iChar;
+    /** Read the options:                                                             */
+    for (iArg = 1; iArg < argc; iArg++) {
+        if ((strcmp(argv[iArg], "--count") == 0) && (iArg + 1 < argc)) {
+            u32Count = (UINT32) strtoul(argv[++iArg], NULL, 0);
+        }else if ((strcmp(argv[iArg], "--seed") == 0) && (iArg + 1 < argc)) {
+            u64Seed = strtoull(argv[++iArg], NULL, 0);
+        }else if (strcmp(argv[iArg], "--lines") == 0) {
+            bLines = true;
+        }else if ((argv[iArg][0] == '-') && (argv[iArg][1] != 0)) {
+            fprintf(stderr, "Usage: peacalc-fuzz [--count n] [--seed n] [--lines] [file]...\n");
+            return 2;
+        }else{
+            Files.push_back(argv[iArg]);
+        }
+    }
+    vInit();
+    /** Check the files, - is stdin:                                                  */
+    for (const char* pszFile : Files) {
+        FILE* fp = (strcmp(pszFile, "-") == 0) ? stdin : fopen(pszFile, "rb");
+        if (fp == NULL) {
+            fprintf(stderr, "Cannot open %s\n", pszFile);
+            return 2;
+        }
+        Data.clear();
+        while ((iChar = fgetc(fp)) != EOF) Data.push_back((UINT8) iChar);
+        if (fp != stdin) fclose(fp);
+        if (!bLines) {
+            vCheckBytes(Data.data(), Data.size());
+            continue;
+        }
+        for (uStart = 0; uStart < Data.size(); uStart = uEnd + 1) {
+            for (uEnd = uStart; (uEnd < Data.size()) && (Data[uEnd] != '\n'); uEnd++);
+            vCheckBytes(Data.data() + uStart, ((uEnd > uStart) && (Data[uEnd - 1] == '\r')) ? uEnd - uStart - 1 : uEnd - uStart);
+        }
+    }
+    /** Or the generated terms:                                                       */
+    if (Files.empty()) {
+        CFuzzRandom Rnd(u64Seed);
+        for (UINT32 u32Term = 0; u32Term < u32Count; u32Term++) vCheckTerm(sGenerate(Rnd, 0));
+    }
+    printf("%llu terms checked, %llu parsed, no mismatches\n", (unsigned long long) g_u64Checked, (unsigned long long) g_u64Parsed);
+    return 0;
+}
+#endif
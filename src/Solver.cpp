@@ -0,0 +1,233 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string>
+#include <math.h>
+#include <float.h>
+#include <utility>
+#include "Term.h"
+#include "WorkerPool.h"
+#include "Solver.h"
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************/
+
+CSolver::CSolver(CTerm* pTerm, CCancelToken* pCancel) {
+    m_pTerm    = pTerm;
+    m_pCancel  = pCancel;
+    m_dX       = 0;
+    m_dY       = 0;
+    m_u32Evals = 0;
+}
+
+/** Destructor: ***********************************************************************/
+
+CSolver::~CSolver() {
+}
+
+/** Root-Finder: **********************************************************************
+ *    Newton-iteration from x0, with steps halved while they make |f| grow. Once      *
+ *    a sign-change is passed, or Newton gets stuck, the root is bracketed and        *
+ *    s32Bracketed takes over, thus a root is found, whenever the search comes        *
+ *    across a sign-change:                                                           */
+
+INT32 CSolver::s32Solve(double dX0) {
+    /** Variables:                                                                    */
+    double dX, dY, dSlope;
+    double dNextX, dNextY, dNextSlope;
+    double dStep;
+    UINT32 u32Iter, u32Damping;
+    m_u32Evals = 0;
+    if (!isfinite(dX0) || !bEval(dX0, &dY, &dSlope)) return C_SOLVE_NoRoot;
+    dX = dX0;
+    /** Newton, as long as it makes progress:                                         */
+    for (u32Iter = 0; u32Iter < C_SOLVE_MaxIter; u32Iter++) {
+        if (dY == 0) {
+            m_dX = dX;
+            m_dY = dY;
+            return C_TERM_NumOK;
+        }
+        if ((dSlope == 0) || !isfinite(dSlope)) break;
+        dStep = dY / dSlope;
+        for (u32Damping = 0; u32Damping < C_SOLVE_MaxDamping; u32Damping++) {
+            dNextX = dX - dStep;
+            if (bEval(dNextX, &dNextY, &dNextSlope)) {
+                /** Passing a sign-change brackets the root:                          */
+                if ((dNextY < 0) != (dY < 0)) return s32Bracketed(dX, dY, dNextX, dNextY);
+                if (fabs(dNextY) < fabs(dY)) break;
+            }
+            dStep *= 0.5;
+        }
+        if (u32Damping == C_SOLVE_MaxDamping) break;
+        dX     = dNextX;
+        dY     = dNextY;
+        dSlope = dNextSlope;
+        if (bConverged(dStep, dX)) {
+            m_dX = dX;
+            m_dY = dY;
+            return C_TERM_NumOK;
+        }
+    }
+    /** Look for a sign-change around x0 in growing distances:                        */
+    if (!bEval(dX0, &dY, &dSlope)) return C_SOLVE_NoRoot;
+    dStep = 0.01 * ((fabs(dX0) > 1) ? fabs(dX0) : 1);
+    for (u32Iter = 0; u32Iter < C_SOLVE_MaxExpand; u32Iter++, dStep *= 2) {
+        for (dNextX = dX0 - dStep; dNextX <= dX0 + dStep; dNextX += 2 * dStep) {
+            if (!bEval(dNextX, &dNextY, &dNextSlope)) continue;
+            if ((dNextY < 0) != (dY < 0)) return s32Bracketed(dX0, dY, dNextX, dNextY);
+        }
+    }
+    return C_SOLVE_NoRoot;
+}
+
+/** Minimizer: ************************************************************************
+ *    Scans the range in sections for a slope going from negative to positive. The    *
+ *    slope's root within each of them is a local minimum, which competes with the    *
+ *    scanned points, thus with both ends of the range as well:                       */
+
+INT32 CSolver::s32Minimize(double dA, double dB) {
+    /** Variables:                                                                    */
+    double dX, dY, dSlope;
+    double dLastX     = 0;
+    double dLastSlope = 0;
+    double dBestX     = 0;
+    double dBestY     = 0;
+    bool   bLast      = false;
+    bool   bFound     = false;
+    UINT32 u32Section;
+    m_u32Evals = 0;
+    if (!isfinite(dA) || !isfinite(dB) || !isfinite(dB - dA)) return C_SOLVE_NoMinimum;
+    if (dB < dA) std::swap(dA, dB);
+    for (u32Section = 0; u32Section <= C_SOLVE_Sections; u32Section++) {
+        dX = (u32Section == C_SOLVE_Sections) ? dB : (dA + (dB - dA) * u32Section / C_SOLVE_Sections);
+        if (!bEval(dX, &dY, &dSlope)) {
+            bLast = false;
+            continue;
+        }
+        if (!bFound || (dY < dBestY)) {
+            dBestX = dX;
+            dBestY = dY;
+            bFound = true;
+        }
+        /** A local minimum within the section:                                       */
+        if (bLast && (dLastSlope < 0) && (dSlope > 0) && bSlopeRoot(dLastX, dLastSlope, dX, dSlope) && (m_dY < dBestY)) {
+            dBestX = m_dX;
+            dBestY = m_dY;
+        }
+        dLastX     = dX;
+        dLastSlope = dSlope;
+        bLast      = isfinite(dSlope);
+    }
+    if (!bFound) return C_SOLVE_NoMinimum;
+    m_dX = dBestX;
+    m_dY = dBestY;
+    return C_TERM_NumOK;
+}
+
+/** Private Functions: ****************************************************************/
+
+/** Evaluates the term with its derivative, only finite values count. Once the token  *
+ *  is cancelled, all points fail, thus the searches end within their bounds:         */
+
+bool CSolver::bEval(double dX, double* pdY, double* pdSlope) {
+    if ((m_pCancel != NULL) && m_pCancel->bIsCancelled()) return false;
+    m_u32Evals++;
+    if (m_pTerm->s32ExecuteDual(dX, pdY, pdSlope) != C_TERM_NumOK) return false;
+    return isfinite(*pdY);
+}
+
+/** Tells, if a step is within the rounding of x: *************************************/
+
+bool CSolver::bConverged(double dStep, double dX) {
+    return fabs(dStep) <= 4 * DBL_EPSILON * fabs(dX) + DBL_MIN;
+}
+
+/** Bracketed Root-Finder: ************************************************************
+ *    Newton-steps within the bracket, and bisections, where Newton would leave it    *
+ *    or does not halve the bracket. Where |f| ends up larger than at both ends,      *
+ *    the sign-change was a pole rather than a root:                                  */
+
+INT32 CSolver::s32Bracketed(double dLow, double dYLow, double dHigh, double dYHigh) {
+    /** Variables:                                                                    */
+    double dLimit = (fabs(dYLow) > fabs(dYHigh)) ? fabs(dYLow) : fabs(dYHigh);
+    double dX, dY, dSlope;
+    double dStep, dLastStep;
+    UINT32 u32Iter;
+    /** Orient the bracket, so that f(low) < 0 < f(high):                             */
+    if (dYLow > 0) std::swap(dLow, dHigh);
+    dX        = 0.5 * (dLow + dHigh);
+    dLastStep = fabs(dHigh - dLow);
+    if (!bEval(dX, &dY, &dSlope)) return C_SOLVE_NoRoot;
+    for (u32Iter = 0; u32Iter < C_SOLVE_MaxIter; u32Iter++) {
+        if (dY == 0) break;
+        if (dY < 0) dLow = dX;
+        else        dHigh = dX;
+        /** Newton, if it stays inside and converges fast enough, or bisection:       */
+        dStep = (dSlope != 0) ? (dY / dSlope) : HUGE_VAL;
+        if (!isfinite(dStep) || (((dX - dStep) - dLow) * ((dX - dStep) - dHigh) > 0) || (fabs(2 * dStep) > dLastStep)) {
+            dStep = dX - 0.5 * (dLow + dHigh);
+        }
+        dLastStep = fabs(dStep);
+        if (bConverged(dStep, dX) || (dX - dStep == dX)) break;
+        dX -= dStep;
+        if (!bEval(dX, &dY, &dSlope)) return C_SOLVE_NoRoot;
+    }
+    if (fabs(dY) > dLimit) return C_SOLVE_NoRoot;
+    m_dX = dX;
+    m_dY = dY;
+    return C_TERM_NumOK;
+}
+
+/** Slope-Root: ***********************************************************************
+ *    Finds, where the slope between a negative and a positive one gets zero, by      *
+ *    the Illinois-variant of the regula falsi. The location and the value of the     *
+ *    term there are left in m_dX and m_dY:                                           */
+
+bool CSolver::bSlopeRoot(double dLow, double dSlopeLow, double dHigh, double dSlopeHigh) {
+    /** Variables:                                                                    */
+    double dX = dLow;
+    double dY, dSlope;
+    INT32  s32Side = 0;
+    UINT32 u32Iter;
+    for (u32Iter = 0; u32Iter < C_SOLVE_MaxIter; u32Iter++) {
+        dX = (dLow * dSlopeHigh - dHigh * dSlopeLow) / (dSlopeHigh - dSlopeLow);
+        if (!(dX > dLow) || !(dX < dHigh)) dX = 0.5 * (dLow + dHigh);
+        if (!bEval(dX, &dY, &dSlope) || !isfinite(dSlope)) return false;
+        if (dSlope == 0) break;
+        /** Keep the sign-change, and halve the slope at an end kept twice:          */
+        if (dSlope < 0) {
+            dLow      = dX;
+            dSlopeLow = dSlope;
+            if (s32Side < 0) dSlopeHigh *= 0.5;
+            s32Side   = -1;
+        }else{
+            dHigh      = dX;
+            dSlopeHigh = dSlope;
+            if (s32Side > 0) dSlopeLow *= 0.5;
+            s32Side    = 1;
+        }
+        if (bConverged(dHigh - dLow, dX)) break;
+    }
+    m_dX = dX;
+    m_dY = dY;
+    return true;
+}
@@ -0,0 +1,51 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#define C_SOLVE_MaxIter          100
+#define C_SOLVE_MaxDamping       30          // Halvings of a Newton-step, which overshoots
+#define C_SOLVE_MaxExpand        64          // Doublings of the search for a sign-change
+#define C_SOLVE_Sections         64          // Sections of the range, which minimize scans
+
+#define C_SOLVE_NoRoot           0x40
+#define C_SOLVE_NoMinimum        0x41
+
+/** Class Definition: *****************************************************************
+ *    Root-finding and minimization over x, based on the derivatives, which           *
+ *    CTerm::s32ExecuteDual provides along with the values:                           */
+
+class CSolver {
+public:
+    double m_dX;                 // The root or the location of the minimum
+    double m_dY;                 // The term at m_dX
+    UINT32 m_u32Evals;           // Evaluations of the term
+    CSolver(CTerm* pTerm, CCancelToken* pCancel = NULL);
+    ~CSolver();
+    INT32  s32Solve(double dX0);
+    INT32  s32Minimize(double dA, double dB);
+private:
+    CTerm*        m_pTerm;
+    CCancelToken* m_pCancel;
+    bool   bEval(double dX, double* pdY, double* pdSlope);
+    bool   bConverged(double dStep, double dX);
+    INT32  s32Bracketed(double dLow, double dYLow, double dHigh, double dYHigh);
+    bool   bSlopeRoot(double dLow, double dSlopeLow, double dHigh, double dSlopeHigh);
+};
@@ -0,0 +1,246 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Term.h"
+#include "NumFormat.h"
+#include "Calculator.h"
+#include "WorkerPool.h"
+#include "StreamEval.h"
+
+/** Local Functions: ******************************************************************/
+
+static inline bool bIsBlank(char c) {
+    return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************
+ *    Starts the workers, each one with a calculator of its own. Without a given      *
+ *    count of threads, there's one per core:                                         */
+
+CStreamEval::CStreamEval(UINT32 u32Threads, INT32 s32CacheSize, INT32 s32Precision, UINT32 u32Format) {
+    m_pPool     = new CWorkerPool(u32Threads);
+    m_u64Lines  = 0;
+    m_u64Failed = 0;
+    m_Workers.resize(m_pPool->u32GetThreads());
+    for (tStreamWorker& tWorker : m_Workers) {
+        tWorker.pCalc = new CCalculator(s32CacheSize, s32Precision);
+        tWorker.pCalc->vSetFormat(u32Format);
+    }
+    m_Batches.resize(m_Workers.size() * C_STREAM_Backlog);
+    for (tStreamBatch& tBatch : m_Batches) {
+        tBatch.bBusy = false;
+        tBatch.bDone = false;
+    }
+}
+
+/** Destructor: ***********************************************************************/
+
+CStreamEval::~CStreamEval() {
+    delete m_pPool;
+    for (tStreamWorker& tWorker : m_Workers) delete tWorker.pCalc;
+}
+
+/** Set-Function of the budget of each line. Untrusted input thus cannot stall a      *
+ *  worker for longer than the time limit:                                            */
+
+void CStreamEval::vSetBudget(const tTermBudget& tBudget) {
+    for (tStreamWorker& tWorker : m_Workers) tWorker.pCalc->vSetBudget(tBudget);
+}
+
+/** Stream-Runner: ********************************************************************
+ *    Evaluates each line of the input and writes the results to the output. Empty    *
+ *    lines are skipped. Returns false, if reading or writing failed:                 */
+
+bool CStreamEval::bRun(FILE* pInput, FILE* pOutput) {
+    /** Variables:                                                                    */
+    std::vector<char> Buffer(C_STREAM_ReadSize);
+    tStreamBatch*     pBatch;
+    size_t            uSubmitted = 0;
+    size_t            uWritten   = 0;
+    size_t            uRead, uPos;
+    const char*       pcBreak;
+    bool              bOk = true;
+    /** The first batch to fill:                                                      */
+    pBatch = &m_Batches[0];
+    pBatch->sInput.clear();
+    pBatch->Ends.clear();
+    while ((uRead = fread(Buffer.data(), 1, Buffer.size(), pInput)) > 0) {
+        /** Cut the block into lines, a partial line continues with the next block:   */
+        for (uPos = 0; uPos < uRead; ) {
+            pcBreak = (const char*) memchr(&Buffer[uPos], '\n', uRead - uPos);
+            if (pcBreak == NULL) {
+                pBatch->sInput.append(&Buffer[uPos], uRead - uPos);
+                break;
+            }
+            pBatch->sInput.append(&Buffer[uPos], pcBreak - &Buffer[uPos]);
+            pBatch->Ends.push_back(pBatch->sInput.size());
+            uPos = (size_t) (pcBreak - Buffer.data()) + 1;
+            if (pBatch->Ends.size() < C_STREAM_BatchLines) continue;
+            /** The batch is full, so hand it out and get the next free one:          */
+            bSubmit(pBatch);
+            uSubmitted++;
+            if (uSubmitted - uWritten == m_Batches.size()) {
+                if (!bFlush(&m_Batches[uWritten % m_Batches.size()], pOutput)) bOk = false;
+                uWritten++;
+            }
+            pBatch = &m_Batches[uSubmitted % m_Batches.size()];
+            pBatch->sInput.clear();
+            pBatch->Ends.clear();
+        }
+    }
+    if (ferror(pInput)) bOk = false;
+    /** The last line may lack its line-break:                                        */
+    if ((!pBatch->sInput.empty()) && (pBatch->Ends.empty() || (pBatch->Ends.back() != pBatch->sInput.size()))) {
+        pBatch->Ends.push_back(pBatch->sInput.size());
+    }
+    if (!pBatch->Ends.empty()) {
+        bSubmit(pBatch);
+        uSubmitted++;
+    }
+    /** Write the rest in order:                                                      */
+    for (; uWritten < uSubmitted; uWritten++) {
+        if (!bFlush(&m_Batches[uWritten % m_Batches.size()], pOutput)) bOk = false;
+    }
+    if (fflush(pOutput) != 0) bOk = false;
+    return bOk;
+}
+
+/** Get-Function of the number of evaluated lines: ************************************/
+
+UINT64 CStreamEval::u64GetLines(void) {
+    return m_u64Lines;
+}
+
+/** Get-Function of the number of lines, which ended with an error-message: ***********/
+
+UINT64 CStreamEval::u64GetFailed(void) {
+    return m_u64Failed;
+}
+
+/** Decodes UTF-8, as the operators like √ and ÷ are not ASCII: ***********************
+ *    The result is appended. Everything invalid becomes a replacement-character:     */
+
+void CStreamEval::vFromUtf8(const char* pszInput, size_t uLength, std::wstring* psOutput) {
+    size_t uPos = 0;
+    UINT32 u32Char;
+    while (uPos < uLength) {
+        UINT8 u8Lead = (UINT8) pszInput[uPos++];
+        if (u8Lead < 0x80) {
+            *psOutput += (WCHAR) u8Lead;
+            continue;
+        }
+        /** Multi-byte sequence:                                                      */
+        size_t uMore = (u8Lead >= 0xF0) ? 3 : (u8Lead >= 0xE0) ? 2 : (u8Lead >= 0xC0) ? 1 : 0;
+        u32Char = u8Lead & (0x3F >> uMore);
+        if ((uMore == 0) || (uPos + uMore > uLength)) {
+            *psOutput += (WCHAR) 0xFFFD;
+            continue;
+        }
+        while (uMore-- > 0) u32Char = (u32Char << 6) | ((UINT8) pszInput[uPos++] & 0x3F);
+        *psOutput += (u32Char <= 0xFFFF) ? (WCHAR) u32Char : (WCHAR) 0xFFFD;
+    }
+}
+
+/** Encodes to UTF-8 and drops the CRs of the GUI's line-endings: *********************
+ *    The result is appended:                                                         */
+
+void CStreamEval::vToUtf8(const std::wstring& sInput, std::string* psOutput) {
+    for (WCHAR wc : sInput) {
+        UINT32 u32Char = (UINT32) wc;
+        if (u32Char == L'\r') continue;
+        if (u32Char < 0x80) {
+            *psOutput += (char) u32Char;
+        }else if (u32Char < 0x800) {
+            *psOutput += (char) (0xC0 | (u32Char >> 6));
+            *psOutput += (char) (0x80 | (u32Char & 0x3F));
+        }else{
+            *psOutput += (char) (0xE0 | ((u32Char >> 12) & 0x0F));
+            *psOutput += (char) (0x80 | ((u32Char >> 6) & 0x3F));
+            *psOutput += (char) (0x80 | (u32Char & 0x3F));
+        }
+    }
+}
+
+/** Private Functions: ****************************************************************/
+
+/** Batch-Worker: *********************************************************************
+ *    Evaluates all lines of a batch with the calculator of this worker. All          *
+ *    buffers are reused, thus a line does not allocate, unless its term is new:      */
+
+void CStreamEval::vProcBatch(tStreamBatch* pBatch, UINT32 u32Worker) {
+    /** Variables:                                                                    */
+    tStreamWorker* pWorker = &m_Workers[u32Worker];
+    const char*    pcLine  = pBatch->sInput.data();
+    size_t         uStart  = 0;
+    size_t         uEnd;
+    pBatch->sOutput.clear();
+    pBatch->uLines  = 0;
+    pBatch->uFailed = 0;
+    for (size_t uLineEnd : pBatch->Ends) {
+        /** Trim the line and skip it, if nothing is left:                            */
+        uEnd = uLineEnd;
+        while ((uStart < uEnd) && bIsBlank(pcLine[uStart])) uStart++;
+        while ((uEnd > uStart) && bIsBlank(pcLine[uEnd - 1])) uEnd--;
+        if (uStart < uEnd) {
+            pWorker->sLine.clear();
+            pWorker->sResult.clear();
+            vFromUtf8(pcLine + uStart, uEnd - uStart, &pWorker->sLine);
+            pWorker->pCalc->vProcMath(pWorker->sLine, &pWorker->sResult);
+            vToUtf8(pWorker->sResult, &pBatch->sOutput);
+            pBatch->uLines++;
+            if (pWorker->pCalc->bLastFailed()) pBatch->uFailed++;
+        }
+        uStart = uLineEnd;
+    }
+    /** Tell the writer:                                                              */
+    std::unique_lock<std::mutex> Guard(m_Lock);
+    pBatch->bDone = true;
+    m_BatchDone.notify_all();
+}
+
+/** Hands a filled batch to the workers: **********************************************/
+
+bool CStreamEval::bSubmit(tStreamBatch* pBatch) {
+    pBatch->bBusy = true;
+    pBatch->bDone = false;
+    m_pPool->vSubmit([this, pBatch](UINT32 u32Worker) { vProcBatch(pBatch, u32Worker); });
+    return true;
+}
+
+/** Waits for a batch and writes its results: *****************************************/
+
+bool CStreamEval::bFlush(tStreamBatch* pBatch, FILE* pOutput) {
+    {
+        std::unique_lock<std::mutex> Guard(m_Lock);
+        m_BatchDone.wait(Guard, [pBatch] { return pBatch->bDone; });
+    }
+    pBatch->bBusy = false;
+    m_u64Lines  += pBatch->uLines;
+    m_u64Failed += pBatch->uFailed;
+    if (pBatch->sOutput.empty()) return true;
+    return (fwrite(pBatch->sOutput.data(), 1, pBatch->sOutput.size(), pOutput) == pBatch->sOutput.size());
+}
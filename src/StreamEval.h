@@ -0,0 +1,79 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#define C_STREAM_ReadSize    (1 << 20)   // Bytes per read
+#define C_STREAM_BatchLines  1024        // Lines per job of a worker
+#define C_STREAM_Backlog     4           // Batches in flight per worker
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct {
+    std::string         sInput;          // Raw lines, without their line-breaks
+    std::vector<size_t> Ends;            // End of each line within sInput
+    std::string         sOutput;         // UTF-8 results of all lines
+    size_t              uLines;          // Lines, which were evaluated
+    size_t              uFailed;         // ... and ended with an error-message
+    bool                bBusy;           // Submitted and not yet written
+    bool                bDone;           // Evaluated by a worker
+} tStreamBatch;
+
+typedef struct {
+    CCalculator* pCalc;
+    std::wstring sLine;                  // Decoded input
+    std::wstring sResult;                // Result of the calculator
+} tStreamWorker;
+
+/** Class Definition: *****************************************************************
+ *    Evaluates newline-delimited expressions, as the CLI does for single lines.      *
+ *    The input is read in large blocks and cut into batches of lines, which the      *
+ *    workers evaluate with a calculator each. The batches are recycled in a ring,    *
+ *    which bounds the memory and lets the reader wait for slow workers. Results are  *
+ *    written in the order of the input:                                              */
+
+class CStreamEval {
+public:
+    CStreamEval(UINT32 u32Threads, INT32 s32CacheSize, INT32 s32Precision, UINT32 u32Format);
+    ~CStreamEval();
+    void   vSetBudget(const tTermBudget& tBudget);
+    bool   bRun(FILE* pInput, FILE* pOutput);
+    UINT64 u64GetLines(void);
+    UINT64 u64GetFailed(void);
+    static void vFromUtf8(const char* pszInput, size_t uLength, std::wstring* psOutput);
+    static void vToUtf8(const std::wstring& sInput, std::string* psOutput);
+private:
+    CWorkerPool*               m_pPool;
+    std::vector<tStreamWorker> m_Workers;
+    std::vector<tStreamBatch>  m_Batches;
+    std::mutex                 m_Lock;
+    std::condition_variable    m_BatchDone;
+    UINT64                     m_u64Lines;
+    UINT64                     m_u64Failed;
+    void   vProcBatch(tStreamBatch* pBatch, UINT32 u32Worker);
+    bool   bSubmit(tStreamBatch* pBatch);
+    bool   bFlush(tStreamBatch* pBatch, FILE* pOutput);
+};
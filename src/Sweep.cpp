@@ -0,0 +1,163 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string>
+#include <math.h>
+#include "Term.h"
+#include "WorkerPool.h"
+#include "Sweep.h"
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************/
+
+CSweep::CSweep(CWorkerPool* pPool, CCancelToken* pCancel) {
+    m_pPool   = pPool;
+    m_pCancel = pCancel;
+    m_uDone   = 0;
+    m_dX0     = 0;
+    m_dStep   = 0;
+    m_Summary.dMin    = m_Summary.dArgMin = 0;
+    m_Summary.dMax    = m_Summary.dArgMax = 0;
+    m_Summary.dSum    = 0;
+    m_Summary.uValid  = 0;
+    m_Summary.uFailed = 0;
+}
+
+/** Destructor: ***********************************************************************/
+
+CSweep::~CSweep() {
+}
+
+/** Sweep-Runner: *********************************************************************
+ *    Evaluates the term from x0 to x1 in steps. The range is cut into chunks of      *
+ *    fixed size, which the workers evaluate in parallel on their own copy of the     *
+ *    term. The results are stored in order, and the partial summaries are merged     *
+ *    in chunk-order, thus the outcome does not depend on the number of threads.      *
+ *    A cancelled token skips the remaining chunks:                                   */
+
+INT32 CSweep::s32Run(const CTerm& Term, double dX0, double dX1, double dStep) {
+    /** Variables:                                                                    */
+    double dSteps;
+    size_t uCount, uChunks, uChunk;
+    /** Check the range:                                                              */
+    if ((dStep == 0) || !isfinite(dStep) || !isfinite(dX0) || !isfinite(dX1)) return C_SWEEP_InvalidRange;
+    dSteps = (dX1 - dX0) / dStep;
+    if (dSteps < 0) return C_SWEEP_InvalidRange;
+    if (dSteps >= C_SWEEP_MaxPoints) return C_SWEEP_TooManyPoints;
+    uCount  = (size_t) floor(dSteps + 1E-9) + 1;
+    uChunks = (uCount + C_SWEEP_ChunkSize - 1) / C_SWEEP_ChunkSize;
+    m_dX0   = dX0;
+    m_dStep = dStep;
+    /** Prepare the storage and one copy of the term per worker:                      */
+    m_Results.resize(uCount);
+    m_Status.resize(uCount);
+    m_Partial.resize(uChunks);
+    m_Terms.assign(m_pPool->u32GetThreads(), Term);
+    m_uDone = 0;
+    /** Hand out the chunks and wait for them:                                        */
+    for (uChunk = 0; uChunk < uChunks; uChunk++) {
+        m_pPool->vSubmit([this, uChunk](UINT32 u32Worker) { vRunChunk(uChunk, u32Worker); });
+    }
+    m_pPool->vWait();
+    if ((m_pCancel != NULL) && m_pCancel->bIsCancelled()) return C_TERM_Cancelled;
+    /** Merge the partial summaries:                                                  */
+    m_Summary = m_Partial[0];
+    for (uChunk = 1; uChunk < uChunks; uChunk++) vMerge(&m_Summary, &m_Partial[uChunk]);
+    return C_TERM_NumOK;
+}
+
+/** Get-Function of the number of points: *********************************************/
+
+size_t CSweep::uGetCount(void) {
+    return m_Results.size();
+}
+
+/** Get-Function of the x-value at a point: *******************************************
+ *    It is calculated from the index, so that there's no accumulated error:          */
+
+double CSweep::dGetX(size_t uIndex) {
+    return m_dX0 + (double) uIndex * m_dStep;
+}
+
+/** Private Functions: ****************************************************************/
+
+/** Chunk-Worker: *********************************************************************
+ *    Evaluates one chunk with the batch-executor and builds its summary:             */
+
+void CSweep::vRunChunk(size_t uChunk, UINT32 u32Worker) {
+    /** Variables:                                                                    */
+    double         adInput[C_SWEEP_ChunkSize];
+    size_t         uStart = uChunk * C_SWEEP_ChunkSize;
+    size_t         uLen   = m_Results.size() - uStart;
+    size_t         uPos;
+    double         dValue;
+    tSweepSummary* pSum   = &m_Partial[uChunk];
+    if (uLen > C_SWEEP_ChunkSize) uLen = C_SWEEP_ChunkSize;
+    pSum->dMin    = pSum->dArgMin = 0;
+    pSum->dMax    = pSum->dArgMax = 0;
+    pSum->dSum    = 0;
+    pSum->uValid  = 0;
+    pSum->uFailed = 0;
+    if (m_pCancel != NULL) {
+        if (m_pCancel->bIsCancelled()) return;
+        m_pCancel->vSetProgress((double) m_uDone++ / m_Partial.size());
+    }
+    /** Evaluate the whole chunk at once:                                             */
+    for (uPos = 0; uPos < uLen; uPos++) adInput[uPos] = dGetX(uStart + uPos);
+    m_Terms[u32Worker].s32ExecuteBatch(adInput, &m_Results[uStart], &m_Status[uStart], uLen);
+    /** Build the summary of this chunk:                                              */
+    for (uPos = 0; uPos < uLen; uPos++) {
+        dValue = m_Results[uStart + uPos];
+        if ((m_Status[uStart + uPos] != C_TERM_NumOK) || isnan(dValue)) {
+            pSum->uFailed++;
+            continue;
+        }
+        if ((pSum->uValid == 0) || (dValue < pSum->dMin)) {
+            pSum->dMin    = dValue;
+            pSum->dArgMin = adInput[uPos];
+        }
+        if ((pSum->uValid == 0) || (dValue > pSum->dMax)) {
+            pSum->dMax    = dValue;
+            pSum->dArgMax = adInput[uPos];
+        }
+        pSum->dSum += dValue;
+        pSum->uValid++;
+    }
+}
+
+/** Merges the summary of a following chunk: ******************************************/
+
+void CSweep::vMerge(tSweepSummary* pInto, const tSweepSummary* pFrom) {
+    if (pFrom->uValid > 0) {
+        if ((pInto->uValid == 0) || (pFrom->dMin < pInto->dMin)) {
+            pInto->dMin    = pFrom->dMin;
+            pInto->dArgMin = pFrom->dArgMin;
+        }
+        if ((pInto->uValid == 0) || (pFrom->dMax > pInto->dMax)) {
+            pInto->dMax    = pFrom->dMax;
+            pInto->dArgMax = pFrom->dArgMax;
+        }
+        pInto->dSum += pFrom->dSum;
+    }
+    pInto->uValid  += pFrom->uValid;
+    pInto->uFailed += pFrom->uFailed;
+}
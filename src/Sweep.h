@@ -0,0 +1,66 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+
+#define C_SWEEP_ChunkSize        4096
+#define C_SWEEP_MaxPoints        10000000
+
+#define C_SWEEP_InvalidRange     0x20
+#define C_SWEEP_TooManyPoints    0x21
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct {
+    double dMin;                 // Smallest result
+    double dArgMin;              // x of the smallest result
+    double dMax;                 // Largest result
+    double dArgMax;              // x of the largest result
+    double dSum;                 // Sum of all valid results
+    size_t uValid;               // Number of valid results
+    size_t uFailed;              // Number of failed or undefined results
+} tSweepSummary;
+
+/** Class Definition: *****************************************************************/
+
+class CSweep {
+public:
+    std::vector<double> m_Results;
+    std::vector<UINT8>  m_Status;
+    tSweepSummary       m_Summary;
+    CSweep(CWorkerPool* pPool, CCancelToken* pCancel = NULL);
+    ~CSweep();
+    INT32  s32Run(const CTerm& Term, double dX0, double dX1, double dStep);
+    size_t uGetCount(void);
+    double dGetX(size_t uIndex);
+private:
+    CWorkerPool*               m_pPool;
+    CCancelToken*              m_pCancel;
+    std::atomic<size_t>        m_uDone;
+    double                     m_dX0;
+    double                     m_dStep;
+    std::vector<CTerm>         m_Terms;
+    std::vector<tSweepSummary> m_Partial;
+    void   vRunChunk(size_t uChunk, UINT32 u32Worker);
+    void   vMerge(tSweepSummary* pInto, const tSweepSummary* pFrom);
+};
@@ -18,87 +18,1122 @@
 
 /** Global Includes: ******************************************************************/
 
-#include "stdafx.h"
-#include <winuser.h>
+#include "CoreTypes.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string>
+#include <string.h>
+#include <stdint.h>
 #include <math.h>
-#include "ConfigHandler.h"
+#include <unordered_map>
+#include <utility>
+#include <memory>
 #include "Term.h"
+#include "TermJit.h"
+#include "BigFloat.h"
+#include "TermSymbols.h"
+#include "WorkerPool.h"
+
+/** Local Types: **********************************************************************/
+
+/** Identity of a node for the hash-consing. Constants compare by their bit-pattern,  *
+ *  thus -0 and +0 stay different. Variables compare by their symbol:                 */
+
+typedef struct tNodeKey {
+    UINT32 u32Operator;
+    UINT32 u32Sub1;
+    UINT32 u32Sub2;
+    UINT64 u64Var;
+    INT64  s64Var;
+    bool operator==(const tNodeKey& Other) const {
+        return (u32Operator == Other.u32Operator) && (u32Sub1 == Other.u32Sub1) &&
+               (u32Sub2 == Other.u32Sub2) && (u64Var == Other.u64Var) && (s64Var == Other.s64Var);
+    }
+} tNodeKey;
+
+struct tNodeKeyHash {
+    size_t operator()(const tNodeKey& Key) const {
+        UINT64 u64Hash = Key.u64Var ^ (UINT64) Key.s64Var;
+        u64Hash = (u64Hash ^ Key.u32Operator) * 0x100000001B3ULL;
+        u64Hash = (u64Hash ^ Key.u32Sub1) * 0x100000001B3ULL;
+        u64Hash = (u64Hash ^ Key.u32Sub2) * 0x100000001B3ULL;
+        return (size_t) (u64Hash ^ (u64Hash >> 29));
+    }
+};
+
+/** Keyword-Table: ********************************************************************
+ *    All names and operator-characters, which the lexer knows, with everything the   *
+ *    parser needs to know about them. The constants keep their value in dValue, the  *
+ *    functions and prefix-forms their implicit first operand:                        */
+
+static constexpr tTermKeyword atKeywords[] = {
+    { L"x",    C_TERM_TokParameter, C_TERM_CmdEmpty,          C_TERM_LvlPrimary, false, 0            },
+    { L"e",    C_TERM_TokNumber,    C_TERM_CmdEmpty,          C_TERM_LvlPrimary, false, C_TERM_ValE  },
+    { L"pi",   C_TERM_TokNumber,    C_TERM_CmdEmpty,          C_TERM_LvlPrimary, false, C_TERM_ValPi },
+    { L"log",  C_TERM_TokFunction,  C_TERM_CmdLog,            C_TERM_LvlLog,     false, C_TERM_ValE  },
+    { L"asin", C_TERM_TokFunction,  C_TERM_CmdArcSin,         C_TERM_LvlPrimary, false, 0            },
+    { L"acos", C_TERM_TokFunction,  C_TERM_CmdArcCos,         C_TERM_LvlPrimary, false, 0            },
+    { L"atan", C_TERM_TokFunction,  C_TERM_CmdArcTan,         C_TERM_LvlPrimary, false, 0            },
+    { L"sin",  C_TERM_TokFunction,  C_TERM_CmdSin,            C_TERM_LvlPrimary, false, 0            },
+    { L"cos",  C_TERM_TokFunction,  C_TERM_CmdCos,            C_TERM_LvlPrimary, false, 0            },
+    { L"tan",  C_TERM_TokFunction,  C_TERM_CmdTan,            C_TERM_LvlPrimary, false, 0            },
+    { L"(",    C_TERM_TokOpenBrk,   C_TERM_CmdEmpty,          C_TERM_LvlPrimary, false, 0            },
+    { L")",    C_TERM_TokCloseBrk,  C_TERM_CmdEmpty,          C_TERM_LvlPrimary, false, 0            },
+    { L",",    C_TERM_TokComma,     C_TERM_CmdEmpty,          C_TERM_LvlPrimary, false, 0            },
+    { L"|",    C_TERM_TokOperator,  C_TERM_CmdOr,             C_TERM_LvlOr,      false, 0            },
+    { L"&",    C_TERM_TokOperator,  C_TERM_CmdAnd,            C_TERM_LvlAnd,     false, 0            },
+    { L"~",    C_TERM_TokOperator,  C_TERM_CmdNeg,            C_TERM_LvlPrimary, false, 0            },
+    { L"+",    C_TERM_TokOperator,  C_TERM_CmdAddition,       C_TERM_LvlAdd,     true,  0            },
+    { L"-",    C_TERM_TokOperator,  C_TERM_CmdSubstraction,   C_TERM_LvlSub,     false, 0            },
+    { L"*",    C_TERM_TokOperator,  C_TERM_CmdMultiplication, C_TERM_LvlMul,     true,  0            },
+    { L"÷",    C_TERM_TokOperator,  C_TERM_CmdDivision,       C_TERM_LvlDiv,     false, 0            },
+    { L"/",    C_TERM_TokOperator,  C_TERM_CmdDivision,       C_TERM_LvlSlash,   false, 0            },
+    { L"√",    C_TERM_TokOperator,  C_TERM_CmdRoot,           C_TERM_LvlRoot,    true,  2            },
+    { L"^",    C_TERM_TokOperator,  C_TERM_CmdPower,          C_TERM_LvlPow,     true,  0            }
+};
+
+/** Perfect Hash: *********************************************************************
+ *    FNV-1a over the characters, started with a seed. The compiler searches for the  *
+ *    first seed, which gives every keyword a slot of its own, thus the lexer finds   *
+ *    a keyword with one hash and one compare, regardless of their number:            */
+
+static constexpr size_t uKeywordLength(const WCHAR* pszName) {
+    size_t uLength = 0;
+    while (pszName[uLength] != 0) uLength++;
+    return uLength;
+}
+
+static constexpr UINT32 u32KeywordHash(const WCHAR* pwcName, size_t uLength, UINT32 u32Seed) {
+    UINT32 u32Hash = 0x811C9DC5 ^ u32Seed;
+    for (size_t uPos = 0; uPos < uLength; uPos++) u32Hash = (u32Hash ^ (UINT32) pwcName[uPos]) * 0x01000193;
+    return (u32Hash ^ (u32Hash >> 16)) % C_TERM_KeywordSlots;
+}
+
+static constexpr bool bKeywordSeedFits(UINT32 u32Seed) {
+    bool abUsed[C_TERM_KeywordSlots] = {};
+    for (const tTermKeyword& tKeyword : atKeywords) {
+        UINT32 u32Slot = u32KeywordHash(tKeyword.pszName, uKeywordLength(tKeyword.pszName), u32Seed);
+        if (abUsed[u32Slot]) return false;
+        abUsed[u32Slot] = true;
+    }
+    return true;
+}
+
+static constexpr UINT32 u32KeywordSeed(void) {
+    for (UINT32 u32Seed = 0; u32Seed < 0x10000; u32Seed++) {
+        if (bKeywordSeedFits(u32Seed)) return u32Seed;
+    }
+    return C_TERM_NoNode;
+}
+
+typedef struct {
+    UINT8 au8Keyword[C_TERM_KeywordSlots];  // Index within atKeywords plus one, 0 for free slots
+} tKeywordSlots;
+
+static constexpr tKeywordSlots tKeywordTable(UINT32 u32Seed) {
+    tKeywordSlots tSlots = {};
+    for (size_t uIndex = 0; uIndex < sizeof(atKeywords) / sizeof(atKeywords[0]); uIndex++) {
+        tSlots.au8Keyword[u32KeywordHash(atKeywords[uIndex].pszName, uKeywordLength(atKeywords[uIndex].pszName), u32Seed)] = (UINT8) (uIndex + 1);
+    }
+    return tSlots;
+}
+
+static constexpr UINT32        u32Seed = u32KeywordSeed();
+static_assert(u32Seed != C_TERM_NoNode, "No perfect hash for the keywords, enlarge C_TERM_KeywordSlots");
+static constexpr tKeywordSlots tSlots  = tKeywordTable(u32Seed);
+
+/** Local Functions: ******************************************************************/
+
+/** Looks up a keyword by the perfect hash, NULL if it is none: ***********************/
+
+static const tTermKeyword* pFindKeyword(const WCHAR* pwcName, size_t uLength) {
+    /** Variables:                                                                    */
+    const tTermKeyword* pKeyword;
+    UINT8               u8Index = tSlots.au8Keyword[u32KeywordHash(pwcName, uLength, u32Seed)];
+    if (u8Index == 0) return NULL;
+    pKeyword = &atKeywords[u8Index - 1];
+    if ((wcsncmp(pKeyword->pszName, pwcName, uLength) != 0) || (pKeyword->pszName[uLength] != 0)) return NULL;
+    return pKeyword;
+}
+
+/** Converts the digits of a number-token exactly. Decimals have to fit into INT64,  *
+ *  hex and binary numbers are taken as 64-bit pattern. Returns false for points,     *
+ *  exponents and anything larger:                                                    */
+
+static bool bParseInteger(const WCHAR* pszwStart, const WCHAR* pwszEnd, INT64* ps64Value) {
+    /** Variables:                                                                    */
+    const WCHAR* pwszPos  = pszwStart;
+    UINT64       u64Base  = 10;
+    UINT64       u64Value = 0;
+    UINT64       u64Digit;
+    /** Get the base from the prefix:                                                 */
+    if ((pwszPos[0] == L'0') && ((pwszPos[1] == L'x') || (pwszPos[1] == L'X'))) {
+        u64Base  = 16;
+        pwszPos += 2;
+    }else if ((pwszPos[0] == L'0') && (pwszPos[1] == L'b')) {
+        u64Base  = 2;
+        pwszPos += 2;
+    }
+    if (pwszPos >= pwszEnd) return false;
+    /** Collect the digits:                                                           */
+    for (; pwszPos < pwszEnd; pwszPos++) {
+        if      ((*pwszPos >= L'0') && (*pwszPos <= L'9')) u64Digit = *pwszPos - L'0';
+        else if ((*pwszPos >= L'a') && (*pwszPos <= L'f')) u64Digit = *pwszPos - L'a' + 10;
+        else if ((*pwszPos >= L'A') && (*pwszPos <= L'F')) u64Digit = *pwszPos - L'A' + 10;
+        else return false;
+        if (u64Digit >= u64Base) return false;
+        if (u64Value > (UINT64_MAX - u64Digit) / u64Base) return false;
+        u64Value = u64Value * u64Base + u64Digit;
+    }
+    if ((u64Base == 10) && (u64Value > (UINT64) INT64_MAX)) return false;
+    *ps64Value = (INT64) u64Value;
+    return true;
+}
 
 /** Public Functions: *****************************************************************/
 
 CTerm::CTerm() {
-    m_pSubT1 = NULL;
-    m_pSubT2 = NULL;
+    m_u32Root      = C_TERM_NoNode;
+    m_bFastKernels = false;
+    m_u64Runs      = 0;
+    m_bJit         = true;
+    m_bJitFailed   = false;
+    m_bOptimize    = true;
+    m_bBig         = false;
+    m_pSymbols     = NULL;
+    m_pArguments   = NULL;
+    m_tBudget.u32MaxNodes  = C_TERM_DefMaxNodes;
+    m_tBudget.u32MaxDepth  = C_TERM_DefMaxDepth;
+    m_tBudget.u32TimeLimit = 0;
 }
 
 CTerm::~CTerm() {
-    vReset();
 }
 
 void CTerm::vReset(void) {
-    if (m_pSubT1 != NULL) {
-        delete m_pSubT1;
-        m_pSubT1 = NULL;
+    /** Clearing keeps the storage, thus a re-parse does not allocate again:          */
+    m_Nodes.clear();
+    m_Code.clear();
+    m_IntCode.clear();
+    m_BigCode.clear();
+    m_BigLiterals.clear();
+    m_Variables.clear();
+    m_Uses.clear();
+    m_u32Root = C_TERM_NoNode;
+    m_Jit.reset();
+    m_u64Runs    = 0;
+    m_bJitFailed = false;
+}
+
+/** Selects the polynomial kernels of TermKernels.h for s32ExecuteBatch. They are    *
+ *  faster, but not bit-identical to s32Execute:                                      */
+
+void CTerm::vSetFastKernels(bool bFast) {
+    if (bFast == m_bFastKernels) return;
+    m_bFastKernels = bFast;
+    m_Jit.reset();
+    m_bJitFailed   = false;
+}
+
+/** Keeps the literals for s32ExecuteBig, when the next terms are parsed: *************/
+
+void CTerm::vSetBig(bool bEnable) {
+    m_bBig = bEnable;
+}
+
+/** Enables the translation into machine-code, see bUseJit. It is on by default: ******/
+
+void CTerm::vSetJit(bool bEnable) {
+    m_bJit = bEnable;
+    if (!bEnable) m_Jit.reset();
+}
+
+/** Keeps the tree as it was parsed, when the next terms are parsed. PeaCalcFuzz      *
+ *  takes it as reference for the optimized code. vOptimize is on by default:         */
+
+void CTerm::vSetOptimize(bool bEnable) {
+    m_bOptimize = bEnable;
+}
+
+/** Resolves names against the symbol-table, when the next terms are parsed. Their   *
+ *  variables are read from it by each execution:                                     */
+
+void CTerm::vSetSymbols(CTermSymbols* pSymbols) {
+    m_pSymbols = pSymbols;
+}
+
+/** Set-Function of the budget of the next terms. The nodes include the copies of     *
+ *  inlined functions, the depth counts the nested brackets and pending operations.   *
+ *  Both are checked by the parser, which fails with C_TERM_BudgetExceeded. The time  *
+ *  limit is up to the caller, it goes into the deadline of its cancel-token:         */
+
+void CTerm::vSetBudget(const tTermBudget& tBudget) {
+    m_tBudget = tBudget;
+    if ((m_tBudget.u32MaxNodes == 0) || (m_tBudget.u32MaxNodes > C_TERM_MaxNodes)) m_tBudget.u32MaxNodes = C_TERM_MaxNodes;
+}
+
+INT32 CTerm::s32Parse(const std::wstring& sInput) {
+    /** Variables:                                                                    */
+    INT32  s32Res;
+    vReset();
+    /** Split the input into tokens in one pass:                                      */
+    s32Res = s32Tokenize(sInput);
+    if (s32Res != C_TERM_NumOK) return s32Res;
+    /** Build the tree, starting with the lowest priority:                            */
+    m_uTokPos       = 0;
+    m_bHasParameter = false;
+    s32Res = s32ParseTree(&m_u32Root);
+    /** Check, that all of the input was consumed:                                    */
+    if (s32Res == C_TERM_NumOK) {
+        if (m_Tokens[m_uTokPos].u32Type == C_TERM_TokCloseBrk) s32Res = C_TERM_MissingBrk;
+        else if (m_Tokens[m_uTokPos].u32Type != C_TERM_TokEnd) s32Res = C_TERM_MissingOperator;
     }
-    if (m_pSubT2 != NULL) {
-        delete m_pSubT2;
-        m_pSubT2 = NULL;
+    if ((s32Res == C_TERM_NumOK) && m_bBig) vCompileBig(sInput);
+    m_Tokens.clear();
+    if (s32Res != C_TERM_NumOK) {
+        vReset();
+        return s32Res;
     }
-    m_u32Operator = C_TERM_CmdEmpty;
+    /** Integer-trees get exact code of their own, before folding rounds anything:    */
+    vCompileInteger();
+    /** Simplify and flatten the tree for the execution:                              */
+    if (m_bOptimize) vOptimize();
+    vCompile();
+    /** Check the result and be gone:                                                 */
+    if (m_bHasParameter) return C_TERM_FuncOK;
+    return C_TERM_NumOK;
 }
 
-INT32 CTerm::s32Parse(std::wstring sInput) {
+/** Function-Parser: ******************************************************************
+ *    Parses the body of a user-function, where the given names are its arguments.    *
+ *    The parse-tree is copied out as it is, thus in postfix-order with the root      *
+ *    last, and each call of the function inlines it with s32InlineCall:              */
+
+INT32 CTerm::s32ParseBody(const std::wstring& sInput, const std::vector<std::wstring>& Arguments, std::vector<tTermNode>* pBody) {
+    /** Variables:                                                                    */
+    INT32  s32Res;
     vReset();
-    return s32Declare(sInput);
+    m_pArguments = &Arguments;
+    s32Res       = s32Tokenize(sInput);
+    m_pArguments = NULL;
+    if (s32Res != C_TERM_NumOK) return s32Res;
+    m_uTokPos       = 0;
+    m_bHasParameter = false;
+    s32Res = s32ParseTree(&m_u32Root);
+    if (s32Res == C_TERM_NumOK) {
+        if (m_Tokens[m_uTokPos].u32Type == C_TERM_TokCloseBrk) s32Res = C_TERM_MissingBrk;
+        else if (m_Tokens[m_uTokPos].u32Type != C_TERM_TokEnd) s32Res = C_TERM_MissingOperator;
+        else if (m_u32Root + 1 != m_Nodes.size()) s32Res = C_TERM_ParsingError;
+    }
+    m_Tokens.clear();
+    if (s32Res != C_TERM_NumOK) return s32Res;
+    /** The tokens are gone, so are the texts of the literals:                        */
+    pBody->assign(m_Nodes.begin(), m_Nodes.end());
+    for (tTermNode& tNode : *pBody) tNode.u32Token = C_TERM_NoNode;
+    if (m_bHasParameter) return C_TERM_FuncOK;
+    return C_TERM_NumOK;
+}
+
+/** Get-Function of the symbols, which the last parsed input refers to: ***************/
+
+void CTerm::vGetSymbols(std::vector<UINT32>* pSymbols) {
+    pSymbols->assign(m_Uses.begin(), m_Uses.end());
+}
+
+/** Stack-Machine: ********************************************************************
+ *    Runs the compiled postfix-code without any recursion. Operands are pushed,      *
+ *    operations replace their operands on the stack by the result:                   */
+
+INT32 CTerm::s32Execute(const double dInput, double* pdOutput) {
+    /** Variables:                                                                    */
+    const tTermInstr* pInstr = m_Code.data();
+    const tTermInstr* pEnd   = pInstr + m_Code.size();
+    double*           pdSp   = m_Stack.data();
+    double*           pdSlot = m_Slots.data();
+    double            dPar1, dPar2;
+    INT32             s32Res;
+    UINT8             u8Status;
+    if (pInstr == pEnd) return C_TERM_ParsingError;
+    /** Hot terms run as machine-code:                                                */
+    if (bUseJit(1)) {
+        if (!m_Variables.empty()) vLoadVariables(m_JitFrame.data(), 2, 2);
+        m_Jit->vRun(&dInput, &dPar1, &u8Status, 1, m_JitFrame.data());
+        if (u8Status == C_TERM_NumOK) *pdOutput = dPar1;
+        return u8Status;
+    }
+    if (!m_Variables.empty()) vLoadVariables(pdSlot, 1, 1);
+    /** Run through the code:                                                         */
+    for (; pInstr < pEnd; pInstr++) {
+        switch (pInstr->u32OpCode) {
+        case C_TERM_CmdConstant:
+            *pdSp++ = pInstr->dVar;
+            break;
+        case C_TERM_CmdParameter:
+            *pdSp++ = dInput;
+            break;
+        case C_TERM_CmdStore:
+            pdSlot[pInstr->u32Arg] = pdSp[-1];
+            break;
+        case C_TERM_CmdLoad:
+            *pdSp++ = pdSlot[pInstr->u32Arg];
+            break;
+        case C_TERM_CmdAddition:
+            pdSp--;
+            pdSp[-1] = pdSp[-1] + pdSp[0];
+            break;
+        case C_TERM_CmdSubstraction:
+            pdSp--;
+            pdSp[-1] = pdSp[-1] - pdSp[0];
+            break;
+        case C_TERM_CmdMultiplication:
+            pdSp--;
+            pdSp[-1] = pdSp[-1] * pdSp[0];
+            break;
+        case C_TERM_CmdMinus:
+            pdSp[-1] = 0.0 - pdSp[-1];
+            break;
+        case C_TERM_CmdDivision:
+            pdSp--;
+            if (pdSp[0] == 0) return C_TERM_DivByZero;
+            pdSp[-1] = pdSp[-1] / pdSp[0];
+            break;
+        case C_TERM_CmdPower:
+            pdSp--;
+            pdSp[-1] = pow(pdSp[-1], pdSp[0]);
+            break;
+        case C_TERM_CmdRoot:
+            pdSp--;
+            pdSp[-1] = pow(pdSp[0], 1 / pdSp[-1]);
+            break;
+        case C_TERM_CmdLog:
+            pdSp--;
+            pdSp[-1] = log(pdSp[0]) / log(pdSp[-1]);
+            break;
+        case C_TERM_CmdLogConst:
+            pdSp[-1] = log(pdSp[-1]) / pInstr->dVar;
+            break;
+        case C_TERM_CmdOr:
+        case C_TERM_CmdAnd:
+            pdSp--;
+            s32Res = s32Boolean(pInstr->u32OpCode, pdSp[-1], pdSp[0], &pdSp[-1]);
+            if (s32Res != C_TERM_NumOK) return s32Res;
+            break;
+        case C_TERM_CmdNeg:
+            s32Res = s32Boolean(C_TERM_CmdNeg, 0, pdSp[-1], &pdSp[-1]);
+            if (s32Res != C_TERM_NumOK) return s32Res;
+            break;
+        case C_TERM_CmdArcSin:
+            pdSp[-1] = asin(pdSp[-1]);
+            break;
+        case C_TERM_CmdArcCos:
+            pdSp[-1] = acos(pdSp[-1]);
+            break;
+        case C_TERM_CmdArcTan:
+            pdSp[-1] = atan(pdSp[-1]);
+            break;
+        case C_TERM_CmdSin:
+            pdSp[-1] = sin(pdSp[-1]);
+            break;
+        case C_TERM_CmdCos:
+            pdSp[-1] = cos(pdSp[-1]);
+            break;
+        case C_TERM_CmdTan:
+            pdSp[-1] = tan(pdSp[-1]);
+            break;
+        case C_TERM_CmdSinCos:
+        case C_TERM_CmdCosSin:
+            /** The compiler fuses both into one sincos, where the libm has one:      */
+            dPar1 = sin(pdSp[-1]);
+            dPar2 = cos(pdSp[-1]);
+            pdSp[-1] = (pInstr->u32OpCode == C_TERM_CmdSinCos) ? dPar1 : dPar2;
+            pdSlot[pInstr->u32Arg] = (pInstr->u32OpCode == C_TERM_CmdSinCos) ? dPar2 : dPar1;
+            break;
+        }
+    }
+    *pdOutput = pdSp[-1];
+    return C_TERM_NumOK;
+}
+
+/** Integer-Executor: *****************************************************************
+ *    Runs the code of vCompileInteger on 64-bit integers, thus big values stay       *
+ *    exact. The boolean operators follow vBoolean, like in all executors. An         *
+ *    overflow of + - * is reported, and the caller falls back to s32Execute. This    *
+ *    includes unsigned patterns as operands, which are beyond the signed range, and  *
+ *    variables, which are not integer-typed at the moment:                           */
+
+INT32 CTerm::s32ExecuteInt(tTermInt* pOutput) {
+    /** Variables:                                                                    */
+    const tTermIntInstr* pInstr = m_IntCode.data();
+    const tTermIntInstr* pEnd   = pInstr + m_IntCode.size();
+    tTermInt*            pSp    = m_IntStack.data();
+    INT64                s64Par1, s64Par2;
+    UINT64               u64Result;
+    if (pInstr == pEnd) return C_TERM_ParsingError;
+    /** Run through the code, the arithmetic wraps and is checked afterwards:         */
+    for (; pInstr < pEnd; pInstr++) {
+        if (pInstr->u32OpCode == C_TERM_CmdConstant) {
+            pSp->s64Value  = pInstr->s64Var;
+            pSp->bUnsigned = pInstr->bUnsigned;
+            pSp++;
+            continue;
+        }
+        if (pInstr->u32OpCode == C_TERM_CmdVariable) {
+            /** The variable may have got a fraction since the parsing:               */
+            if (!m_pSymbols->bGetInteger((UINT32) pInstr->s64Var, pSp)) return C_TERM_IntOverflow;
+            pSp++;
+            continue;
+        }
+        if (pInstr->u32OpCode == C_TERM_CmdNeg) {
+            vBoolean(C_TERM_CmdNeg, pSp[-1], pSp[-1], &pSp[-1]);
+            continue;
+        }
+        pSp--;
+        if ((pInstr->u32OpCode == C_TERM_CmdOr) || (pInstr->u32OpCode == C_TERM_CmdAnd)) {
+            vBoolean(pInstr->u32OpCode, pSp[-1], pSp[0], &pSp[-1]);
+            continue;
+        }
+        if (pSp[-1].bUnsigned || pSp[0].bUnsigned) return C_TERM_IntOverflow;
+        s64Par1 = pSp[-1].s64Value;
+        s64Par2 = pSp[0].s64Value;
+        switch (pInstr->u32OpCode) {
+        case C_TERM_CmdAddition:
+            u64Result = (UINT64) s64Par1 + (UINT64) s64Par2;
+            if (((s64Par1 < 0) == (s64Par2 < 0)) && (((INT64) u64Result < 0) != (s64Par1 < 0))) return C_TERM_IntOverflow;
+            break;
+        case C_TERM_CmdSubstraction:
+            u64Result = (UINT64) s64Par1 - (UINT64) s64Par2;
+            if (((s64Par1 < 0) != (s64Par2 < 0)) && (((INT64) u64Result < 0) != (s64Par1 < 0))) return C_TERM_IntOverflow;
+            break;
+        default:
+            u64Result = (UINT64) s64Par1 * (UINT64) s64Par2;
+            if (s64Par1 != 0) {
+                if ((s64Par1 == -1) && (s64Par2 == INT64_MIN)) return C_TERM_IntOverflow;
+                if ((s64Par2 == -1) && (s64Par1 == INT64_MIN)) return C_TERM_IntOverflow;
+                if (((s64Par1 != -1) && ((INT64) u64Result / s64Par1 != s64Par2))) return C_TERM_IntOverflow;
+            }
+            break;
+        }
+        pSp[-1].s64Value = (INT64) u64Result;
+    }
+    *pOutput = pSp[-1];
+    return C_TERM_NumOK;
+}
+
+/** Tells, if the term has integer-code for s32ExecuteInt: ****************************/
+
+bool CTerm::bIsInteger(void) {
+    return !m_IntCode.empty();
+}
+
+/** Boolean Semantics: ****************************************************************
+ *    & | ~ work on 64-bit patterns in all executors. Operands are truncated to an    *
+ *    integer from -2^63 up to below 2^64. From 2^63 on, they are unsigned patterns,  *
+ *    thus 0xFFFFFFFFFFFFFFFF stays positive. The result of & and | is unsigned, if   *
+ *    one operand was and the top bit is still set. ~ is always signed, thus ~5 is    *
+ *    -6 and ~0 is -1. The same value gives the same result, however it was written:  */
+
+bool CTerm::bToPattern(double dValue, tTermInt* pPattern) {
+    /** NaN fails both comparisons:                                                   */
+    if (!((dValue >= -C_TERM_BoolSign) && (dValue < C_TERM_BoolMax))) return false;
+    if (dValue >= C_TERM_BoolSign) {
+        pPattern->s64Value  = (INT64) (UINT64) dValue;
+        pPattern->bUnsigned = true;
+    }else{
+        pPattern->s64Value  = (INT64) dValue;
+        pPattern->bUnsigned = false;
+    }
+    return true;
+}
+
+double CTerm::dFromPattern(const tTermInt& tPattern) {
+    if (tPattern.bUnsigned) return (double) (UINT64) tPattern.s64Value;
+    return (double) tPattern.s64Value;
+}
+
+void CTerm::vBoolean(UINT32 u32OpCode, const tTermInt& tPar1, const tTermInt& tPar2, tTermInt* pResult) {
+    /** Variables:                                                                    */
+    bool bUnsigned = tPar1.bUnsigned || tPar2.bUnsigned;
+    switch (u32OpCode) {
+    case C_TERM_CmdOr:
+        pResult->s64Value = tPar1.s64Value | tPar2.s64Value;
+        break;
+    case C_TERM_CmdAnd:
+        pResult->s64Value = tPar1.s64Value & tPar2.s64Value;
+        break;
+    default:
+        pResult->s64Value = ~tPar2.s64Value;
+        bUnsigned         = false;
+        break;
+    }
+    pResult->bUnsigned = bUnsigned && (pResult->s64Value < 0);
+}
+
+/** The same on doubles, as used by the other executors. ~ ignores its first operand: */
+
+INT32 CTerm::s32Boolean(UINT32 u32OpCode, double dPar1, double dPar2, double* pdResult) {
+    /** Variables:                                                                    */
+    tTermInt tPar1 = { 0, false };
+    tTermInt tPar2;
+    tTermInt tResult;
+    if (!bToPattern(dPar2, &tPar2)) return C_TERM_BoolTooLarge;
+    if ((u32OpCode != C_TERM_CmdNeg) && !bToPattern(dPar1, &tPar1)) return C_TERM_BoolTooLarge;
+    vBoolean(u32OpCode, tPar1, tPar2, &tResult);
+    *pdResult = dFromPattern(tResult);
+    return C_TERM_NumOK;
+}
+
+/** Chops a big value to the 64-bit pattern of the boolean operators: *****************/
+
+static bool bBigToPattern(CBigMath* pMath, const tBigFloat& A, tTermInt* pPattern) {
+    /** Variables:                                                                    */
+    tBigFloat tTrunc;
+    UINT64    u64Value;
+    bool      bNeg;
+    pMath->vTrunc(A, &tTrunc);
+    if (!pMath->bToMagnitude(tTrunc, &u64Value, &bNeg)) return false;
+    if (bNeg && (u64Value > (UINT64) INT64_MAX + 1)) return false;
+    pPattern->s64Value  = bNeg ? (INT64) (0 - u64Value) : (INT64) u64Value;
+    pPattern->bUnsigned = !bNeg && (u64Value > (UINT64) INT64_MAX);
+    return true;
+}
+
+/** Arbitrary-Precision-Executor: *****************************************************
+ *    Runs the code of vCompileBig with the given CBigMath, thus with its digits.     *
+ *    Literals are converted from their text and pi and e are the cached constants,   *
+ *    so nothing went through a double before. Boolean operators work on the 64-bit   *
+ *    patterns of vBoolean, like all executors. With a token, it stops between two    *
+ *    operations, once the token was cancelled:                                       */
+
+INT32 CTerm::s32ExecuteBig(CBigMath* pMath, tBigFloat* pOutput, CCancelToken* pCancel) {
+    /** Variables:                                                                    */
+    std::vector<tBigFloat> Stack;
+    tBigFloat              tPar1;
+    tBigFloat              tPar2;
+    tBigFloat*             pResult;
+    std::wstring           sLiteral;
+    tTermInt               tBool1 = { 0, false };
+    tTermInt               tBool2;
+    bool                   bDegree;
+    size_t                 uDone = 0;
+    if (m_BigCode.empty()) return C_TERM_ParsingError;
+    for (const tTermInstr& tInstr : m_BigCode) {
+        if (pCancel != NULL) {
+            if (pCancel->bIsCancelled()) return C_TERM_Cancelled;
+            pCancel->vSetProgress((double) uDone++ / m_BigCode.size());
+        }
+        /** Operands are pushed, variables with the precision of their double:        */
+        if (tInstr.u32OpCode == C_TERM_CmdVariable) {
+            Stack.emplace_back();
+            pMath->vFromDouble(m_pSymbols->dGetValue(tInstr.u32Arg), &Stack.back());
+            continue;
+        }
+        if (tInstr.u32OpCode == C_TERM_CmdConstant) {
+            Stack.emplace_back();
+            if (tInstr.u32Arg == C_TERM_NoNode) {
+                /** Implicit ones, the base of log() is e:                            */
+                if (tInstr.dVar == C_TERM_ValE) pMath->vConstant(C_BIG_ConstE, &Stack.back());
+                else pMath->vFromDouble(tInstr.dVar, &Stack.back());
+                continue;
+            }
+            sLiteral = m_BigLiterals[tInstr.u32Arg];
+            bDegree  = (sLiteral.back() == L'o');
+            if (bDegree) sLiteral.pop_back();
+            if      (sLiteral == L"pi") pMath->vConstant(C_BIG_ConstPi, &Stack.back());
+            else if (sLiteral == L"e" ) pMath->vConstant(C_BIG_ConstE, &Stack.back());
+            else if (!pMath->bParse(sLiteral, &Stack.back())) pMath->vFromDouble(tInstr.dVar, &Stack.back());
+            if (bDegree) {
+                /** The double has the degree applied already, the text has not:      */
+                if (pMath->bParse(sLiteral, &tPar1)) {
+                    pMath->vConstant(C_BIG_ConstPi, &tPar2);
+                    pMath->vMul(tPar1, tPar2, &tPar1);
+                    pMath->vFromInt(180, &tPar2);
+                    pMath->bDiv(tPar1, tPar2, &Stack.back());
+                }
+            }
+            continue;
+        }
+        /** Operations replace their operands, unary ones have only the second:       */
+        tPar2 = std::move(Stack.back());
+        Stack.pop_back();
+        if (!bIsUnary(tInstr.u32OpCode)) {
+            tPar1 = std::move(Stack.back());
+            Stack.pop_back();
+        }
+        Stack.emplace_back();
+        pResult = &Stack.back();
+        switch (tInstr.u32OpCode) {
+        case C_TERM_CmdAddition:
+            pMath->vAdd(tPar1, tPar2, pResult);
+            break;
+        case C_TERM_CmdSubstraction:
+            pMath->vSub(tPar1, tPar2, pResult);
+            break;
+        case C_TERM_CmdMultiplication:
+            pMath->vMul(tPar1, tPar2, pResult);
+            break;
+        case C_TERM_CmdDivision:
+            if (!pMath->bDiv(tPar1, tPar2, pResult)) return C_TERM_DivByZero;
+            break;
+        case C_TERM_CmdPower:
+            pMath->vPow(tPar1, tPar2, pResult);
+            break;
+        case C_TERM_CmdRoot:
+            /** a√b = b^(1/a):                                                        */
+            pMath->vFromInt(1, pResult);
+            if (!pMath->bDiv(*pResult, tPar1, &tPar1)) return C_TERM_DivByZero;
+            pMath->vPow(tPar2, tPar1, pResult);
+            break;
+        case C_TERM_CmdLog:
+            pMath->vLog(tPar1, &tPar1);
+            pMath->vLog(tPar2, &tPar2);
+            if (!pMath->bDiv(tPar2, tPar1, pResult)) return C_TERM_DivByZero;
+            break;
+        case C_TERM_CmdArcSin:
+            pMath->vAsin(tPar2, pResult);
+            break;
+        case C_TERM_CmdArcCos:
+            pMath->vAcos(tPar2, pResult);
+            break;
+        case C_TERM_CmdArcTan:
+            pMath->vAtan(tPar2, pResult);
+            break;
+        case C_TERM_CmdSin:
+            pMath->vSin(tPar2, pResult);
+            break;
+        case C_TERM_CmdCos:
+            pMath->vCos(tPar2, pResult);
+            break;
+        case C_TERM_CmdTan:
+            pMath->vTan(tPar2, pResult);
+            break;
+        default:
+            /** Boolean operations on the 64-bit patterns:                            */
+            if (!bBigToPattern(pMath, tPar2, &tBool2)) return C_TERM_BoolTooLarge;
+            if ((tInstr.u32OpCode != C_TERM_CmdNeg) && !bBigToPattern(pMath, tPar1, &tBool1)) return C_TERM_BoolTooLarge;
+            vBoolean(tInstr.u32OpCode, tBool1, tBool2, &tBool2);
+            if (tBool2.bUnsigned) pMath->vFromUInt((UINT64) tBool2.s64Value, pResult);
+            else pMath->vFromInt(tBool2.s64Value, pResult);
+            break;
+        }
+    }
+    *pOutput = std::move(Stack.back());
+    return C_TERM_NumOK;
+}
+
+/** Reference-Executor: ***************************************************************
+ *    Walks the tree recursively. It is slower than the stack-machine, but it is      *
+ *    the reference, which any other executor has to agree with:                      */
+
+INT32 CTerm::s32ExecuteTree(const double dInput, double* pdOutput) {
+    if (m_u32Root == C_TERM_NoNode) return C_TERM_ParsingError;
+    return s32ExecuteNode(m_u32Root, dInput, pdOutput);
+}
+
+/** Private Functions: ****************************************************************/
+
+/** Optimizer: ************************************************************************
+ *    Folds operations on constants into a single constant and drops operations,      *
+ *    which do not change their operand. Operands always precede their operation      *
+ *    in the arena, thus one pass in arena-order sees them already simplified.        *
+ *    Only identities, which are exact in IEEE-arithmetics, are applied. Thus x+0     *
+ *    is kept, since it turns -0 into +0, while x-0 is dropped. A subtraction from    *
+ *    +0 becomes a negation, which still calculates 0-x to keep the sign of zero.     *
+ *    Operations, which fail on constants (like 1/0), are kept to fail at runtime.    *
+ *    Powers and roots always call pow. It is not correctly rounded, thus x*x, 1/x    *
+ *    and sqrt would differ from x^2, x^-1 and the root of 2 now and then, and x^1    *
+ *    is kept, since pow turns -NaN into NaN.                                         *
+ *    The logarithm of a constant base is calculated once. It is still divided by,    *
+ *    since multiplying by its inverse would round twice. Finally, equal nodes are    *
+ *    merged (hash-consing), which turns the tree into a DAG, where each common       *
+ *    subterm exists only once:                                                       */
+
+void CTerm::vOptimize(void) {
+    /** Variables:                                                                    */
+    std::unordered_map<tNodeKey, UINT32, tNodeKeyHash> Known;
+    std::vector<UINT32> Alias(m_Nodes.size());
+    tTermNode*          pNode;
+    const tTermNode*    pSub1;
+    const tTermNode*    pSub2;
+    tNodeKey            tKey;
+    UINT32              u32Node;
+    UINT32              u32Keep;
+    double              dValue;
+    bool                bConst1, bConst2;
+    for (u32Node = 0; u32Node < m_Nodes.size(); u32Node++) {
+        pNode   = &m_Nodes[u32Node];
+        u32Keep = C_TERM_NoNode;
+        if ((pNode->u32Operator != C_TERM_CmdConstant) &&
+            (pNode->u32Operator != C_TERM_CmdParameter) &&
+            (pNode->u32Operator != C_TERM_CmdVariable)) {
+            /** Refer to the merged operands:                                         */
+            pNode->u32Sub1 = Alias[pNode->u32Sub1];
+            pNode->u32Sub2 = Alias[pNode->u32Sub2];
+            pSub1   = &m_Nodes[pNode->u32Sub1];
+            pSub2   = &m_Nodes[pNode->u32Sub2];
+            bConst1 = (pSub1->u32Operator == C_TERM_CmdConstant);
+            bConst2 = (pSub2->u32Operator == C_TERM_CmdConstant);
+            if (bConst1 && bConst2) {
+                /** Fold operations without x:                                        */
+                if (s32ExecuteNode(u32Node, 0, &dValue) == C_TERM_NumOK) {
+                    pNode->u32Operator = C_TERM_CmdConstant;
+                    pNode->u32Sub1     = C_TERM_NoNode;
+                    pNode->u32Sub2     = C_TERM_NoNode;
+                    pNode->dVar        = dValue;
+                }
+            }else{
+                /** Look for neutral operands:                                        */
+                switch (pNode->u32Operator) {
+                case C_TERM_CmdMultiplication:
+                    if (bConst2 && (pSub2->dVar == 1)) u32Keep = pNode->u32Sub1;
+                    else if (bConst1 && (pSub1->dVar == 1)) u32Keep = pNode->u32Sub2;
+                    break;
+                case C_TERM_CmdDivision:
+                    if (bConst2 && (pSub2->dVar == 1)) u32Keep = pNode->u32Sub1;
+                    break;
+                case C_TERM_CmdLog:
+                    if (bConst1) {
+                        pNode->u32Operator = C_TERM_CmdLogConst;
+                        pNode->dVar        = log(pSub1->dVar);
+                    }
+                    break;
+                case C_TERM_CmdAddition:
+                    if (bConst2 && (pSub2->dVar == 0) && signbit(pSub2->dVar)) u32Keep = pNode->u32Sub1;
+                    else if (bConst1 && (pSub1->dVar == 0) && signbit(pSub1->dVar)) u32Keep = pNode->u32Sub2;
+                    break;
+                case C_TERM_CmdSubstraction:
+                    if (bConst2 && (pSub2->dVar == 0) && !signbit(pSub2->dVar)) u32Keep = pNode->u32Sub1;
+                    else if (bConst1 && (pSub1->dVar == 0) && !signbit(pSub1->dVar)) pNode->u32Operator = C_TERM_CmdMinus;
+                    break;
+                }
+            }
+        }
+        if (u32Keep != C_TERM_NoNode) {
+            /** The operation is dropped, thus its users refer to the operand:        */
+            Alias[u32Node] = u32Keep;
+            continue;
+        }
+        /** Merge with an equal node, which was seen before:                          */
+        tKey.u32Operator = pNode->u32Operator;
+        tKey.u32Sub1     = pNode->u32Sub1;
+        tKey.u32Sub2     = pNode->u32Sub2;
+        memcpy(&tKey.u64Var, &pNode->dVar, sizeof(UINT64));
+        tKey.s64Var      = (pNode->u32Operator == C_TERM_CmdVariable) ? pNode->s64Var : 0;
+        Alias[u32Node] = Known.emplace(tKey, u32Node).first->second;
+    }
+    m_u32Root = Alias[m_u32Root];
 }
 
-INT32  CTerm::s32Execute(const double dInput, double* pdOutput) {
-    INT32 iRes;
-    double dPar1, dPar2;
-    INT64  iPar1, iPar2, iOut;
+/** Compiler: *************************************************************************
+ *    Flattens the DAG into postfix-code by a depth-first walk on an explicit         *
+ *    stack. Functions and the boolean negation only take their second operand,       *
+ *    since the first one is always the implicit constant. Operations with more       *
+ *    than one user are calculated once and stored into a slot, their further        *
+ *    users just load the slot. Sine and cosine of the same argument are paired,      *
+ *    the first one calculates both and leaves the other one in a slot. Variables     *
+ *    get a slot of their own, which the executors fill before running the code:      */
+
+void CTerm::vCompile(void) {
+    /** Variables:                                                                    */
+    std::vector<UINT32> Pending;
+    std::vector<bool>   Expanded;
+    std::vector<UINT32> Users;
+    std::vector<UINT32> Slot;
+    std::vector<UINT32> SinOf;
+    std::vector<UINT32> Partner;
+    tTermInstr          tInstr;
+    const tTermNode*    pNode;
+    UINT32              u32Node;
+    UINT32              u32Slots  = 0;
+    size_t              uDepth    = 0;
+    size_t              uMaxDepth = 0;
+    bool                bLeaf;
+    m_Code.clear();
+    if (m_u32Root == C_TERM_NoNode) return;
+    /** Count the users of each reachable node. Users always follow their operands:   */
+    Users.assign(m_u32Root + 1, 0);
+    Slot.assign(m_u32Root + 1, C_TERM_NoNode);
+    Users[m_u32Root] = 1;
+    for (u32Node = m_u32Root + 1; u32Node-- > 0; ) {
+        pNode = &m_Nodes[u32Node];
+        if ((Users[u32Node] == 0) ||
+            (pNode->u32Operator == C_TERM_CmdConstant) ||
+            (pNode->u32Operator == C_TERM_CmdParameter)) continue;
+        if (pNode->u32Operator == C_TERM_CmdVariable) {
+            Slot[u32Node] = u32Slots++;
+            m_Variables.push_back({ Slot[u32Node], (UINT32) pNode->s64Var });
+            continue;
+        }
+        Users[pNode->u32Sub2]++;
+        if (!bIsUnary(pNode->u32Operator)) Users[pNode->u32Sub1]++;
+    }
+    /** Pair the sines with the cosines, by the index of their argument:              */
+    SinOf.assign(m_u32Root + 1, C_TERM_NoNode);
+    Partner.assign(m_u32Root + 1, C_TERM_NoNode);
+    for (u32Node = 0; u32Node <= m_u32Root; u32Node++) {
+        if ((Users[u32Node] != 0) && (m_Nodes[u32Node].u32Operator == C_TERM_CmdSin)) {
+            SinOf[m_Nodes[u32Node].u32Sub2] = u32Node;
+        }
+    }
+    for (u32Node = 0; u32Node <= m_u32Root; u32Node++) {
+        pNode = &m_Nodes[u32Node];
+        if ((Users[u32Node] == 0) || (pNode->u32Operator != C_TERM_CmdCos)) continue;
+        if (SinOf[pNode->u32Sub2] == C_TERM_NoNode) continue;
+        Partner[u32Node] = SinOf[pNode->u32Sub2];
+        Partner[SinOf[pNode->u32Sub2]] = u32Node;
+    }
+    /** Walk through the DAG:                                                         */
+    Pending.push_back(m_u32Root);
+    Expanded.push_back(false);
+    while (!Pending.empty()) {
+        u32Node = Pending.back();
+        pNode   = &m_Nodes[u32Node];
+        bLeaf   = (pNode->u32Operator == C_TERM_CmdConstant) ||
+                  (pNode->u32Operator == C_TERM_CmdParameter);
+        tInstr.u32Arg = 0;
+        tInstr.dVar   = pNode->dVar;
+        if (Slot[u32Node] != C_TERM_NoNode) {
+            /** This one was calculated before, so just fetch it:                     */
+            Pending.pop_back();
+            Expanded.pop_back();
+            tInstr.u32OpCode = C_TERM_CmdLoad;
+            tInstr.u32Arg    = Slot[u32Node];
+            m_Code.push_back(tInstr);
+            uDepth++;
+            if (uDepth > uMaxDepth) uMaxDepth = uDepth;
+            continue;
+        }
+        if ((!Expanded.back()) && (!bLeaf)) {
+            /** First visit of an operation, thus put its operands on top:            */
+            Expanded.back() = true;
+            Pending.push_back(pNode->u32Sub2);
+            Expanded.push_back(false);
+            if (!bIsUnary(pNode->u32Operator)) {
+                Pending.push_back(pNode->u32Sub1);
+                Expanded.push_back(false);
+            }
+            continue;
+        }
+        /** The operands are done, so emit the node itself:                           */
+        Pending.pop_back();
+        Expanded.pop_back();
+        tInstr.u32OpCode = pNode->u32Operator;
+        if ((!bLeaf) && (Partner[u32Node] != C_TERM_NoNode)) {
+            tInstr.u32OpCode = (pNode->u32Operator == C_TERM_CmdSin) ? C_TERM_CmdSinCos : C_TERM_CmdCosSin;
+            tInstr.u32Arg    = u32Slots;
+            Slot[Partner[u32Node]] = u32Slots++;
+        }
+        m_Code.push_back(tInstr);
+        /** Keep track of the stack-depth:                                            */
+        if (bLeaf) {
+            uDepth++;
+            if (uDepth > uMaxDepth) uMaxDepth = uDepth;
+        }else if (!bIsUnary(pNode->u32Operator)) {
+            uDepth--;
+        }
+        /** Keep the result of shared operations:                                     */
+        if ((!bLeaf) && (Users[u32Node] > 1)) {
+            Slot[u32Node]    = u32Slots++;
+            tInstr.u32OpCode = C_TERM_CmdStore;
+            tInstr.u32Arg    = Slot[u32Node];
+            m_Code.push_back(tInstr);
+        }
+    }
+    m_Stack.resize(uMaxDepth);
+    m_Slots.resize(u32Slots);
+}
+
+/** Type-Inference for Integers: *****************************************************
+ *    A term without x, which consists of integer-literals (also 0x and 0b) and       *
+ *    + - * & | ~ only, is integer-typed. Constants like 5.0 count as well, if they   *
+ *    are integers up to C_TERM_ExactInt, thus the spelling does not matter. So do    *
+ *    variables, s32ExecuteInt checks at each run, if they are integer-typed. It gets *
+ *    postfix-code for s32ExecuteInt, which is taken right from the arena. The arena  *
+ *    is still the parse-tree here, thus it is in postfix-order, except for the       *
+ *    unused first operand of ~:                                                      */
+
+void CTerm::vCompileInteger(void) {
+    /** Variables:                                                                    */
+    std::vector<bool> Unused(m_Nodes.size(), false);
+    tTermIntInstr     tInstr;
+    size_t            uDepth    = 0;
+    size_t            uMaxDepth = 0;
+    UINT32            u32Node;
+    m_IntCode.clear();
+    if (m_bHasParameter || (m_u32Root + 1 != m_Nodes.size())) return;
+    /** Check the types, the operations need no further information:                  */
+    for (const tTermNode& tNode : m_Nodes) {
+        switch (tNode.u32Operator) {
+        case C_TERM_CmdConstant:
+            if (tNode.bInteger) break;
+            if ((fabs(tNode.dVar) > C_TERM_ExactInt) || (tNode.dVar != trunc(tNode.dVar))) return;
+            break;
+        case C_TERM_CmdVariable:
+            break;
+        case C_TERM_CmdNeg:
+            Unused[tNode.u32Sub1] = true;
+            break;
+        case C_TERM_CmdAddition:
+        case C_TERM_CmdSubstraction:
+        case C_TERM_CmdMultiplication:
+        case C_TERM_CmdOr:
+        case C_TERM_CmdAnd:
+            break;
+        default:
+            return;
+        }
+    }
+    /** Emit the code, hex and binary literals from 2^63 on are unsigned patterns:    */
+    for (u32Node = 0; u32Node < m_Nodes.size(); u32Node++) {
+        if (Unused[u32Node]) continue;
+        const tTermNode* pNode = &m_Nodes[u32Node];
+        tInstr.u32OpCode = pNode->u32Operator;
+        tInstr.s64Var    = pNode->s64Var;
+        tInstr.bUnsigned = false;
+        if (tInstr.u32OpCode == C_TERM_CmdConstant) {
+            if (pNode->bInteger) tInstr.bUnsigned = (pNode->s64Var < 0);
+            else tInstr.s64Var = (INT64) pNode->dVar;
+            uDepth++;
+            if (uDepth > uMaxDepth) uMaxDepth = uDepth;
+        }else if (tInstr.u32OpCode == C_TERM_CmdVariable) {
+            uDepth++;
+            if (uDepth > uMaxDepth) uMaxDepth = uDepth;
+        }else if (tInstr.u32OpCode != C_TERM_CmdNeg) {
+            uDepth--;
+        }
+        m_IntCode.push_back(tInstr);
+    }
+    m_IntStack.resize(uMaxDepth);
+}
+
+/** Arbitrary-Precision-Compiler: *****************************************************
+ *    Emits the code for s32ExecuteBig from the parse-tree, like vCompileInteger.     *
+ *    The text of every literal is kept, because its double is rounded already:       */
+
+void CTerm::vCompileBig(const std::wstring& sInput) {
+    /** Variables:                                                                    */
+    std::vector<bool> Unused(m_Nodes.size(), false);
+    tTermInstr        tInstr;
+    UINT32            u32Node;
+    if (m_bHasParameter || (m_u32Root + 1 != m_Nodes.size())) return;
+    /** The unary operations do not use their first operand:                          */
+    for (const tTermNode& tNode : m_Nodes) {
+        if ((tNode.u32Operator != C_TERM_CmdConstant) && bIsUnary(tNode.u32Operator)) Unused[tNode.u32Sub1] = true;
+    }
+    /** Emit the code in the order of the arena:                                      */
+    for (u32Node = 0; u32Node < m_Nodes.size(); u32Node++) {
+        if (Unused[u32Node]) continue;
+        const tTermNode* pNode = &m_Nodes[u32Node];
+        tInstr.u32OpCode = pNode->u32Operator;
+        tInstr.u32Arg    = C_TERM_NoNode;
+        tInstr.dVar      = pNode->dVar;
+        if (pNode->u32Operator == C_TERM_CmdVariable) {
+            tInstr.u32Arg = (UINT32) pNode->s64Var;
+        }else if (pNode->u32Token != C_TERM_NoNode) {
+            const tTermToken* pToken = &m_Tokens[pNode->u32Token];
+            tInstr.u32Arg = (UINT32) m_BigLiterals.size();
+            m_BigLiterals.push_back(sInput.substr((size_t) pToken->s32Pos, pToken->u32Length));
+        }
+        m_BigCode.push_back(tInstr);
+    }
+}
+
+/** JIT-Tier: *************************************************************************
+ *    Counts the evaluations and translates the code into machine-code, once there    *
+ *    were C_TERM_JitThreshold of them. Returns true, if m_Jit is to be used. If the  *
+ *    translation fails, the interpreter stays in charge until the next parse:        */
+
+bool CTerm::bUseJit(size_t uCount) {
+    if (m_Jit) return true;
+    if ((!m_bJit) || m_bJitFailed || m_Code.empty()) return false;
+    m_u64Runs += uCount;
+    if (m_u64Runs < C_TERM_JitThreshold) return false;
+    m_bJitFailed = true;
+    /** The fast kernels beat the calls of the libm, so keep them:                    */
+    if (m_bFastKernels) {
+        for (const tTermInstr& tInstr : m_Code) {
+            if ((tInstr.u32OpCode >= C_TERM_CmdSin) && (tInstr.u32OpCode <= C_TERM_CmdTan)) return false;
+            if ((tInstr.u32OpCode == C_TERM_CmdSinCos) || (tInstr.u32OpCode == C_TERM_CmdCosSin)) return false;
+        }
+    }
+    m_Jit = std::make_shared<CTermJit>();
+    if (!m_Jit->bCompile(m_Code, m_Slots.size())) {
+        m_Jit.reset();
+        return false;
+    }
+    m_JitFrame.resize(m_Jit->uGetFrameSize());
+    m_bJitFailed = false;
+    return true;
+}
+
+/** Copies the values of the variables into their slots, each one into uLanes        *
+ *  places, which are uStride apart:                                                  */
+
+void CTerm::vLoadVariables(double* pdSlots, size_t uStride, size_t uLanes) {
+    /** Variables:                                                                    */
+    double dValue;
+    size_t uLane;
+    for (const tTermVariable& tVariable : m_Variables) {
+        dValue = m_pSymbols->dGetValue(tVariable.u32Symbol);
+        for (uLane = 0; uLane < uLanes; uLane++) pdSlots[tVariable.u32Slot * uStride + uLane] = dValue;
+    }
+}
+
+/** Checks, if an operation only uses its second operand: *****************************/
+
+bool CTerm::bIsUnary(UINT32 u32Operator) {
+    switch (u32Operator) {
+    case C_TERM_CmdMinus:
+    case C_TERM_CmdLogConst:
+    case C_TERM_CmdNeg:
+    case C_TERM_CmdArcSin:
+    case C_TERM_CmdArcCos:
+    case C_TERM_CmdArcTan:
+    case C_TERM_CmdSin:
+    case C_TERM_CmdCos:
+    case C_TERM_CmdTan:
+        return true;
+    }
+    return false;
+}
+
+/** Tree-Walker: **********************************************************************
+ *    Calculates the node with the given index, based on its operands:                */
+
+INT32 CTerm::s32ExecuteNode(UINT32 u32Node, const double dInput, double* pdOutput) {
+    /** Variables:                                                                    */
+    const tTermNode* pNode = &m_Nodes[u32Node];
+    UINT32           u32Operator = pNode->u32Operator;
+    INT32            iRes;
+    double           dPar1, dPar2;
     /** Check, if this is a parameter (thus x):                                       */
-    if (m_u32Operator == C_TERM_CmdParameter) {
+    if (u32Operator == C_TERM_CmdParameter) {
         *pdOutput = dInput;
         return C_TERM_NumOK;
     }
     /** Check, if this is a constant:                                                 */
-    if (m_u32Operator == C_TERM_CmdConstant) {
-        *pdOutput = m_dVar;
+    if (u32Operator == C_TERM_CmdConstant) {
+        *pdOutput = pNode->dVar;
+        return C_TERM_NumOK;
+    }
+    if (u32Operator == C_TERM_CmdVariable) {
+        *pdOutput = m_pSymbols->dGetValue((UINT32) pNode->s64Var);
         return C_TERM_NumOK;
     }
     /** It is more than an operand, thus fetch the values:                            */
-    iRes = m_pSubT1->s32Execute(dInput, &dPar1);
+    iRes = s32ExecuteNode(pNode->u32Sub1, dInput, &dPar1);
     if (iRes != C_TERM_NumOK) return iRes;
-    iRes = m_pSubT2->s32Execute(dInput, &dPar2);
+    iRes = s32ExecuteNode(pNode->u32Sub2, dInput, &dPar2);
     if (iRes != C_TERM_NumOK) return iRes;
     /** Check, if it is a boolean operation:                                          */
-    if ((m_u32Operator == C_TERM_CmdOr) ||
-        (m_u32Operator == C_TERM_CmdAnd) ||
-        (m_u32Operator == C_TERM_CmdNeg)) {
-        /** It is, so check the ranges:                                               */
-        if (abs(dPar1) >= C_TERM_MAXINT) return C_TERM_BoolTooLarge;
-        if (abs(dPar2) >= C_TERM_MAXINT) return C_TERM_BoolTooLarge;
-        /** Convert to integers by chopping to 53 bits:                               */
-        iPar1 = ((INT64)dPar1) & (C_TERM_MAXINT - 1);
-        iPar2 = ((INT64)dPar2) & (C_TERM_MAXINT - 1);
-        /** Do the calculus:                                                          */
-        switch (m_u32Operator) {
-        case C_TERM_CmdOr:
-            *pdOutput = (double)(iPar1 | iPar2);
-            return C_TERM_NumOK;
-        case C_TERM_CmdAnd:
-            *pdOutput = (double)(iPar1 & iPar2);
-            return C_TERM_NumOK;
-        case C_TERM_CmdNeg:
-            *pdOutput = (double)((~iPar2) & (C_TERM_MAXINT - 1));
-            return C_TERM_NumOK;
-        }
+    if ((u32Operator == C_TERM_CmdOr) ||
+        (u32Operator == C_TERM_CmdAnd) ||
+        (u32Operator == C_TERM_CmdNeg)) {
+        /** It is, so work on the 64-bit patterns, ~ ignores its first operand:       */
+        return s32Boolean(u32Operator, dPar1, dPar2, pdOutput);
     }
     /**                                                                               */
     /** If it is not boolean, it is conventional:                                     */
-    switch (m_u32Operator) {
+    switch (u32Operator) {
     case C_TERM_CmdAddition:
         *pdOutput = dPar1 + dPar2;
         return C_TERM_NumOK;
@@ -108,6 +1143,9 @@ INT32  CTerm::s32Execute(const double dInput, double* pdOutput) {
     case C_TERM_CmdMultiplication:
         *pdOutput = dPar1 * dPar2;
         return C_TERM_NumOK;
+    case C_TERM_CmdMinus:
+        *pdOutput = 0.0 - dPar2;
+        return C_TERM_NumOK;
     case C_TERM_CmdDivision:
         if (dPar2 == 0) return C_TERM_DivByZero;
         *pdOutput = dPar1 / dPar2;
@@ -121,6 +1159,9 @@ INT32  CTerm::s32Execute(const double dInput, double* pdOutput) {
     case C_TERM_CmdLog:
         *pdOutput = log(dPar2) / log(dPar1);
         return C_TERM_NumOK;
+    case C_TERM_CmdLogConst:
+        *pdOutput = log(dPar2) / pNode->dVar;
+        return C_TERM_NumOK;
     case C_TERM_CmdArcSin:
         *pdOutput = asin(dPar2);
         return C_TERM_NumOK;
@@ -141,310 +1182,440 @@ INT32  CTerm::s32Execute(const double dInput, double* pdOutput) {
         return C_TERM_NumOK;
     }
     return C_TERM_NumOK;
-};
+}
 
-/** Private Functions: ****************************************************************/
+/** Lexer: ****************************************************************************
+ *    Splits the input in one single pass into a vector of tokens, which is           *
+ *    terminated by an end-token. Numbers are converted right here:                   */
 
-bool CTerm::bRemoveSurroundingBrackets(std::wstring* psInput) {
+INT32 CTerm::s32Tokenize(const std::wstring& sInput) {
     /** Variables:                                                                    */
-    int iLvl = 0;
-    int iPos = 0;
-    int iLen = psInput->length();
-    /** Check, if there's actually something to do:                                   */
-    if (psInput->front() != L'(') return false;
-    /** Parse the string and count the bracket-levels:                                */
-    while (iPos < (iLen-1)) {
-        if (psInput->at(iPos) == L'(') iLvl++;
-        if (psInput->at(iPos) == L')') iLvl--;
-        /** If within the string the level reached zero, they are not surrounding:    */
-        if (iLvl==0) return false;
-        iPos++;
-    }
-    /** Check, if at the end there's a closure:                                       */
-    if ((iLvl == 1) && (psInput->back() == L')')) {
-        /** There is, so cut it:                                                      */
-        *psInput = psInput->substr(1, iLen-2);
-        return true;
-    }
-    /** If there wasnt, there's a bracket-error:                                      */
-    return false;
-}    
-
-INT32 CTerm::s32ParseOperand(std::wstring sInput) {
-    UINT64 u64Out;
-    WCHAR* pwszEnd;
-    int    iCount;
-    if (sInput == L"x") {
-        m_u32Operator = C_TERM_CmdParameter;
-        return C_TERM_FuncOK;
-    }
-    if (sInput == L"e") {
-        m_dVar = 2.718281828459045235360287471352;
-        m_u32Operator = C_TERM_CmdConstant;
-        return C_TERM_NumOK;
-    }
-    if (sInput == L"pi") {
-        m_dVar = 3.141592653589793238462643383279;
-        m_u32Operator = C_TERM_CmdConstant;
-        return C_TERM_NumOK;
-    }
-    if (sInput.back() == L'o') {
-        sInput = sInput.substr(0, sInput.length() - 1);
-        m_dVar = wcstod(sInput.c_str(), &pwszEnd);
-        if ((*pwszEnd) != L'\0') return C_TERM_ErroneousNumeric;
-        m_dVar = m_dVar * 0.01745329251994329576923690768489;
-        m_u32Operator = C_TERM_CmdConstant;
-        return C_TERM_NumOK;
-    }
-    if (sInput.substr(0,2) == L"0b") {
-        sInput = sInput.substr(2);
-        iCount = 0;
-        u64Out = 0;
-        while (iCount < (int) sInput.length()) {
-            u64Out = u64Out << 1;
-            if (sInput[iCount] == L'1') {
-                u64Out += 1;
-            }else if (sInput[iCount] != L'0'){
+    const tTermKeyword* pKeyword;
+    tTermToken   tToken;
+    size_t       uPos = 0;
+    size_t       uStart;
+    INT32        s32Res;
+    WCHAR        wc;
+    /** Walk through the input character by character:                                */
+    m_Tokens.clear();
+    while (uPos < sInput.length()) {
+        wc = sInput[uPos];
+        tToken.u32Type     = C_TERM_TokEnd;
+        tToken.u32Operator = C_TERM_CmdEmpty;
+        tToken.u32Level    = C_TERM_LvlPrimary;
+        tToken.dValue      = 0;
+        tToken.s64Value    = 0;
+        tToken.bInteger    = false;
+        tToken.s32Pos      = (INT32) uPos;
+        tToken.u32Length   = 0;
+        tToken.u32Symbol   = 0;
+        tToken.pKeyword    = NULL;
+        /** Skip white-spaces:                                                        */
+        if ((wc == L' ') || (wc == L'\t')) {
+            uPos++;
+            continue;
+        }
+        /** Check for a number:                                                       */
+        if (((wc >= L'0') && (wc <= L'9')) || (wc == L'.')) {
+            s32Res = s32ParseNumber(sInput, &uPos, &tToken);
+            if (s32Res != C_TERM_NumOK) return s32Res;
+            tToken.u32Type   = C_TERM_TokNumber;
+            tToken.u32Length = (UINT32) (uPos - (size_t) tToken.s32Pos);
+            m_Tokens.push_back(tToken);
+            continue;
+        }
+        /** Check for a name, which is either a keyword or a symbol:                  */
+        if ((wc >= L'a') && (wc <= L'z')) {
+            uStart = uPos;
+            while ((uPos < sInput.length()) && (sInput[uPos] >= L'a') && (sInput[uPos] <= L'z')) uPos++;
+            tToken.u32Length = (UINT32) (uPos - uStart);
+            pKeyword = pFindKeyword(sInput.c_str() + uStart, uPos - uStart);
+            if (pKeyword != NULL) {
+                vSetKeyword(pKeyword, &tToken);
+            }else if (!bFindName(sInput.substr(uStart, uPos - uStart), &tToken)) {
                 return C_TERM_ErroneousNumeric;
             }
-            iCount++;
+            m_Tokens.push_back(tToken);
+            continue;
+        }
+        /** Everything else is a single character:                                    */
+        pKeyword = pFindKeyword(&sInput[uPos], 1);
+        if (pKeyword == NULL) return C_TERM_ErroneousNumeric;
+        vSetKeyword(pKeyword, &tToken);
+        m_Tokens.push_back(tToken);
+        uPos++;
+    }
+    /** Terminate the token-list:                                                     */
+    tToken.u32Type     = C_TERM_TokEnd;
+    tToken.u32Operator = C_TERM_CmdEmpty;
+    tToken.u32Level    = C_TERM_LvlPrimary;
+    tToken.dValue      = 0;
+    tToken.s64Value    = 0;
+    tToken.bInteger    = false;
+    tToken.s32Pos      = (INT32) uPos;
+    tToken.u32Length   = 0;
+    tToken.u32Symbol   = 0;
+    tToken.pKeyword    = NULL;
+    m_Tokens.push_back(tToken);
+    return C_TERM_NumOK;
+}
+
+/** Fills a token from the descriptor of its keyword: *********************************/
+
+void CTerm::vSetKeyword(const tTermKeyword* pKeyword, tTermToken* pToken) {
+    pToken->u32Type     = pKeyword->u32Type;
+    pToken->u32Operator = pKeyword->u32Operator;
+    pToken->u32Level    = pKeyword->u32Level;
+    pToken->dValue      = pKeyword->dValue;
+    pToken->pKeyword    = pKeyword;
+}
+
+/** Tells, if the name is taken by a keyword, thus not available for symbols: *********/
+
+bool CTerm::bIsKeyword(const std::wstring& sName) {
+    return pFindKeyword(sName.c_str(), sName.length()) != NULL;
+}
+
+/** Symbol-Lookup: ********************************************************************
+ *    Resolves a name, which is no keyword, to an argument of the function-body       *
+ *    being parsed or to a symbol. This is the only place, where names are compared,  *
+ *    the executors just see slots:                                                   */
+
+bool CTerm::bFindName(const std::wstring& sName, tTermToken* pToken) {
+    /** Variables:                                                                    */
+    UINT32 u32Symbol;
+    if (m_pArguments != NULL) {
+        for (u32Symbol = 0; u32Symbol < m_pArguments->size(); u32Symbol++) {
+            if ((*m_pArguments)[u32Symbol] != sName) continue;
+            pToken->u32Type   = C_TERM_TokArgument;
+            pToken->u32Symbol = u32Symbol;
+            return true;
         }
-        m_dVar = (double) u64Out;
-        m_u32Operator = C_TERM_CmdConstant;
-        return C_TERM_NumOK;
     }
-    /** There's no special case, so try the standard:                       */
-    m_dVar = wcstod(sInput.c_str(), &pwszEnd);
-    if ((*pwszEnd) != L'\0') {
-        return C_TERM_ErroneousNumeric;
+    if (m_pSymbols == NULL) return false;
+    u32Symbol = m_pSymbols->u32Find(sName);
+    if (u32Symbol == C_SYM_NoSymbol) return false;
+    pToken->u32Type   = m_pSymbols->bIsFunction(u32Symbol) ? C_TERM_TokCall : C_TERM_TokVariable;
+    pToken->u32Symbol = u32Symbol;
+    m_Uses.push_back(u32Symbol);
+    return true;
+}
+
+/** Number-Parser: ********************************************************************
+ *    Converts a number at the given position and moves the position behind it.      *
+ *    Besides the standard-notation, 0x, 0b and the degree-suffix o are handled.     *
+ *    Integer-literals are kept exactly as well, see bParseInteger:                   */
+
+INT32 CTerm::s32ParseNumber(const std::wstring& sInput, size_t* puPos, tTermToken* pToken) {
+    /** Variables:                                                                    */
+    const WCHAR* pszwStart = sInput.c_str() + *puPos;
+    double*      pdValue   = &pToken->dValue;
+    WCHAR*       pwszEnd;
+    UINT64       u64Out;
+    /** Check for binary input, which wcstod does not know:                           */
+    if ((pszwStart[0] == L'0') && (pszwStart[1] == L'b')) {
+        pwszEnd = (WCHAR*) &pszwStart[2];
+        u64Out  = 0;
+        while ((*pwszEnd == L'0') || (*pwszEnd == L'1')) {
+            u64Out = (u64Out << 1) + (*pwszEnd - L'0');
+            pwszEnd++;
+        }
+        *pdValue = (double) u64Out;
+    }else{
+        /** The standard covers decimals, exponents and hex:                          */
+        *pdValue = wcstod(pszwStart, &pwszEnd);
+        if (pwszEnd == pszwStart) return C_TERM_ErroneousNumeric;
     }
-    m_u32Operator = C_TERM_CmdConstant;
+    pToken->bInteger = bParseInteger(pszwStart, pwszEnd, &pToken->s64Value);
+    /** Check for an angle in degree:                                                 */
+    if (*pwszEnd == L'o') {
+        pToken->bInteger = false;
+        *pdValue = *pdValue * C_TERM_ValDeg;
+        pwszEnd++;
+    }
+    /** A number directly followed by digits or a point is malformed:                 */
+    if (((*pwszEnd >= L'0') && (*pwszEnd <= L'9')) || (*pwszEnd == L'.')) return C_TERM_ErroneousNumeric;
+    *puPos = (size_t) (pwszEnd - sInput.c_str());
     return C_TERM_NumOK;
-};
+}
+
+/** Precedence-Climbing Parser: *******************************************************
+ *    Parses all tokens into the arena. Instead of recursing per level and bracket,   *
+ *    each pending rule is a frame on an explicit stack, which continues with its     *
+ *    step, once the frame above has returned its node. Thus deep nesting costs no    *
+ *    native stack, and the budget bounds the frames and nodes. Prefix-forms get      *
+ *    their implicit first operand (0, 2 or e), exactly like the former slicer:       */
 
-INT32  CTerm::s32OperatorFinder(const std::wstring sInput, const std::wstring sOperator) {
-    int iOpo  = -1;  // Operator Position
-    int iBlvl = 0;   // Bracket Level
-    /** NOTE: It is assumed, that surrounding brackets have been removed before!!     */
-    while (iOpo < (int) sInput.length()) {
-        iOpo++;
-        if (sInput[iOpo] == L'(') iBlvl++;
-        if (sInput[iOpo] == L')') iBlvl--;
-        /** If at bracket-level-1, there's a bracket-error:                           */
-        if (iBlvl == -1) return -1;
-        /** If within brackets, continue for the next character:                      */
-        if (iBlvl > 0) continue;
-        /** If not within brackets, check for the operator:                           */
-        if (sInput.substr(iOpo, sOperator.length()) == sOperator) {
-            /** Directly take an operator at the beginning:                           */
-            if (iOpo == 0) return iOpo;
-			/** Ignore a minus, which is used for an exponent (thus 10 ^ ...):        */
-            if ((sInput[iOpo-1] == L'e') &&
-                (sOperator == L"-"     ) ){
+INT32 CTerm::s32ParseTree(UINT32* pu32Root) {
+    /** Variables:                                                                    */
+    const tTermToken* pToken;
+    tTermFrame*       pFrame;
+    UINT32            u32Node = C_TERM_NoNode;
+    UINT32            u32Op;
+    UINT32            u32Level;
+    INT32             s32Res;
+    m_Frames.clear();
+    m_CallStarts.clear();
+    bPushFrame(C_TERM_StepLevel, C_TERM_LvlOr, false);
+    while (!m_Frames.empty()) {
+        if (m_Nodes.size() > m_tBudget.u32MaxNodes) return C_TERM_BudgetExceeded;
+        pFrame = &m_Frames.back();
+        pToken = &m_Tokens[m_uTokPos];
+        switch (pFrame->u32Step) {
+        case C_TERM_StepLevel:
+            /** The top-level are the operands themselves:                            */
+            if (pFrame->u32Level == C_TERM_LvlPrimary) {
+                pFrame->u32Step = C_TERM_StepPrimary;
                 continue;
             }
-            return iOpo;
-        }
-    }
-    return -1;
-}
-
-INT32  CTerm::s32OperatorRevFind(const std::wstring sInput, const std::wstring sOperator) {
-    int iOpo  = (int) sInput.length();  // Operator Position
-    int iBlvl = 0;   // Bracket Level
-    /** NOTE: It is assumed, that surrounding brackets have been removed before!!     */
-    while (iOpo > 0) {
-        iOpo--;
-        if (sInput[iOpo] == L')') iBlvl++;
-        if (sInput[iOpo] == L'(') iBlvl--;
-        /** If at bracket-level-1, there's a bracket-error:                           */
-        if (iBlvl == -1) return -1;
-        /** If within brackets, continue for the next character:                      */
-        if (iBlvl > 0) continue;
-        /** If not within brackets, check for the operator:                           */
-        if (sInput.substr(iOpo, sOperator.length()) == sOperator) {
-            /** Directly take an operator at the beginning:                           */
-            if (iOpo == 0) return iOpo;
-			/** Ignore a minus, which is used for an exponent (thus 10 ^ ...):        */
-            if ((sInput[iOpo-1] == L'e') &&
-                (sOperator == L"-"     ) ){
+            /** Check for a prefix-operator at the beginning:                         */
+            u32Op = (pToken->u32Type == C_TERM_TokOperator) ? pToken->u32Operator : C_TERM_CmdEmpty;
+            if ((pFrame->u32Level == C_TERM_LvlNeg) && (u32Op == C_TERM_CmdNeg)) {
+                pFrame->u32Left = u32AddInteger((INT64) pToken->dValue);
+                u32Level = C_TERM_LvlNeg;
+            }else if ((pFrame->u32Level == C_TERM_LvlSub) && (u32Op == C_TERM_CmdSubstraction)) {
+                pFrame->u32Left = u32AddInteger((INT64) pToken->dValue);
+                u32Level = C_TERM_LvlMul;
+            }else if ((pFrame->u32Level == C_TERM_LvlRoot) && (u32Op == C_TERM_CmdRoot)) {
+                pFrame->u32Left = u32AddConstant(pToken->dValue);
+                u32Level = C_TERM_LvlRoot;
+            }else{
+                /** No prefix, so the first operand is of higher priority:            */
+                pFrame->u32Step = C_TERM_StepFirst;
+                bPushFrame(C_TERM_StepLevel, pFrame->u32Level + 1, false);
                 continue;
             }
-            return iOpo;
+            m_uTokPos++;
+            pFrame->u32Operator = u32Op;
+            pFrame->u32Step     = C_TERM_StepPrefix;
+            if (!bPushFrame(C_TERM_StepLevel, u32Level, true)) return C_TERM_BudgetExceeded;
+            continue;
+        case C_TERM_StepFirst:
+            pFrame->u32Left = u32Node;
+            pFrame->u32Step = C_TERM_StepCollect;
+            continue;
+        case C_TERM_StepPrefix:
+        case C_TERM_StepRight:
+            pFrame->u32Left = u32AddNode(pFrame->u32Operator, pFrame->u32Left, u32Node);
+            pFrame->u32Step = C_TERM_StepCollect;
+            continue;
+        case C_TERM_StepCollect:
+            /** Collect the binary operators of this level:                           */
+            if (pToken->u32Level != pFrame->u32Level) {
+                u32Node = pFrame->u32Left;
+                break;
+            }
+            m_uTokPos++;
+            pFrame->u32Operator = pToken->u32Operator;
+            pFrame->u32Step     = C_TERM_StepRight;
+            if (pToken->u32Operator == C_TERM_CmdLog) {
+                /** The logarithm takes its argument in brackets, which count already:   */
+                bPushFrame(C_TERM_StepBracket, C_TERM_LvlOr, false);
+                continue;
+            }
+            /** Right-first ones nest into this level, all others are left-associative: */
+            u32Level = pToken->pKeyword->bRightFirst ? pFrame->u32Level : pFrame->u32Level + 1;
+            if (!bPushFrame(C_TERM_StepLevel, u32Level, true)) return C_TERM_BudgetExceeded;
+            continue;
+        case C_TERM_StepPrimary:
+            /** A number, x, a symbol, a bracket, a call or a negated operand:        */
+            switch (pToken->u32Type) {
+            case C_TERM_TokNumber:
+                m_uTokPos++;
+                if (pToken->bInteger) {
+                    u32Node = u32AddInteger(pToken->s64Value);
+                    m_Nodes[u32Node].dVar = pToken->dValue;
+                }else{
+                    u32Node = u32AddConstant(pToken->dValue);
+                }
+                m_Nodes[u32Node].u32Token = (UINT32) (m_uTokPos - 1);
+                break;
+            case C_TERM_TokParameter:
+                m_uTokPos++;
+                m_bHasParameter = true;
+                u32Node = u32AddNode(C_TERM_CmdParameter, C_TERM_NoNode, C_TERM_NoNode);
+                break;
+            case C_TERM_TokVariable:
+            case C_TERM_TokArgument:
+                m_uTokPos++;
+                u32Node = u32AddNode((pToken->u32Type == C_TERM_TokVariable) ? C_TERM_CmdVariable : C_TERM_CmdArgument, C_TERM_NoNode, C_TERM_NoNode);
+                m_Nodes[u32Node].s64Var = pToken->u32Symbol;
+                break;
+            case C_TERM_TokCall:
+                pFrame->u32Step = C_TERM_StepCall;
+                continue;
+            case C_TERM_TokOpenBrk:
+                pFrame->u32Step = C_TERM_StepBracket;
+                continue;
+            case C_TERM_TokFunction:
+                /** Functions have no first operand, except the base of the logarithm:  */
+                m_uTokPos++;
+                pFrame->u32Left     = u32AddConstant(pToken->dValue);
+                pFrame->u32Operator = pToken->u32Operator;
+                pFrame->u32Step     = C_TERM_StepOperand;
+                bPushFrame(C_TERM_StepBracket, C_TERM_LvlOr, false);
+                continue;
+            case C_TERM_TokOperator:
+                /** A minus within a term (thus 2 * -3) negates the following power:    */
+                if (pToken->u32Operator != C_TERM_CmdSubstraction) return C_TERM_ParsingError;
+                m_uTokPos++;
+                pFrame->u32Left     = u32AddInteger((INT64) pToken->dValue);
+                pFrame->u32Operator = C_TERM_CmdSubstraction;
+                pFrame->u32Step     = C_TERM_StepOperand;
+                if (!bPushFrame(C_TERM_StepLevel, C_TERM_LvlPow, true)) return C_TERM_BudgetExceeded;
+                continue;
+            default:
+                /** Anything else means, that an operand is missing:                  */
+                return C_TERM_ParsingError;
+            }
+            break;
+        case C_TERM_StepOperand:
+            u32Node = u32AddNode(pFrame->u32Operator, pFrame->u32Left, u32Node);
+            break;
+        case C_TERM_StepBracket:
+            /** A complete term within brackets, as used for functions:               */
+            if (pToken->u32Type != C_TERM_TokOpenBrk) return C_TERM_ParsingError;
+            m_uTokPos++;
+            pFrame->u32Step = C_TERM_StepClose;
+            if (!bPushFrame(C_TERM_StepLevel, C_TERM_LvlOr, true)) return C_TERM_BudgetExceeded;
+            continue;
+        case C_TERM_StepClose:
+            if (pToken->u32Type != C_TERM_TokCloseBrk) {
+                if (pToken->u32Type == C_TERM_TokEnd) return C_TERM_MissingBrk;
+                return C_TERM_MissingOperator;
+            }
+            m_uTokPos++;
+            break;
+        case C_TERM_StepCall:
+            /** A user-function, its arguments are parsed like brackets:              */
+            pFrame->u32Symbol = pToken->u32Symbol;
+            pFrame->u32Base   = (UINT32) m_Nodes.size();
+            pFrame->u32Starts = (UINT32) m_CallStarts.size();
+            m_uTokPos++;
+            if (m_Tokens[m_uTokPos].u32Type != C_TERM_TokOpenBrk) return C_TERM_ParsingError;
+            pFrame->u32Step = C_TERM_StepArgument;
+            continue;
+        case C_TERM_StepArgument:
+            m_uTokPos++;
+            m_CallStarts.push_back((UINT32) m_Nodes.size());
+            pFrame->u32Step = C_TERM_StepNextArgument;
+            if (!bPushFrame(C_TERM_StepLevel, C_TERM_LvlOr, true)) return C_TERM_BudgetExceeded;
+            continue;
+        case C_TERM_StepNextArgument:
+            if (pToken->u32Type == C_TERM_TokComma) {
+                pFrame->u32Step = C_TERM_StepArgument;
+                continue;
+            }
+            if (pToken->u32Type != C_TERM_TokCloseBrk) {
+                if (pToken->u32Type == C_TERM_TokEnd) return C_TERM_MissingBrk;
+                return C_TERM_MissingOperator;
+            }
+            m_uTokPos++;
+            s32Res = s32InlineCall(*pFrame, &u32Node);
+            if (s32Res != C_TERM_NumOK) return s32Res;
+            m_CallStarts.resize(pFrame->u32Starts);
+            break;
         }
+        /** The frame is done, its node goes to the one below:                        */
+        m_Frames.pop_back();
     }
-    return -1;
-}
-
-INT32  CTerm::s32ParseOperator(const std::wstring sInput, UINT32* pu32OpType) {
-    int iOpo;
-    *pu32OpType = C_TERM_CmdEmpty;
-    /** Try one by one the possible operators: */
-    iOpo = s32OperatorRevFind(sInput, L"|");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdOr;
-        return iOpo;
-    }
-    iOpo = s32OperatorRevFind(sInput, L"&");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdAnd;
-        return iOpo;
-    }
-    iOpo = s32OperatorRevFind(sInput, L"~");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdNeg;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"+");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdAddition;
-        return iOpo;
-    }
-    iOpo = s32OperatorRevFind(sInput, L"-");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdSubstraction;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"*");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdMultiplication;
-        return iOpo;
-    }
-    iOpo = s32OperatorRevFind(sInput, L"÷");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdDivision;
-        return iOpo;
-    }
-    iOpo = s32OperatorRevFind(sInput, L"/");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdDivision;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"√");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdRoot;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"^");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdPower;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"log(");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdLog;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"asin(");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdArcSin;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"acos(");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdArcCos;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"atan(");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdArcTan;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"sin(");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdSin;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"cos(");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdCos;
-        return iOpo;
-    }
-    iOpo = s32OperatorFinder(sInput, L"tan(");
-    if (iOpo != -1) {
-        *pu32OpType = C_TERM_CmdTan;
-        return iOpo;
-    }
-    return -1;
-}
-
-INT32  CTerm::s32Declare(std::wstring sInput) {
-    INT32 iOpPos;
-    INT32 iRes1, iRes2;
-    /** Trim the string:                                                              */
-    while (sInput.front() == L' ') sInput = sInput.substr(1);
-    while (sInput.back () == L' ') sInput = sInput.substr(0, sInput.length()-1);
-    while (bRemoveSurroundingBrackets(&sInput)) ;
-    /**                                                                               */
-    /** Lookup Operator:                                                              */
-    iOpPos = s32ParseOperator(sInput, &m_u32Operator);
-    /** Check, if by error the operator is at the end:                                */
-    if (iOpPos == ((INT32) sInput.length() -1))  return C_TERM_ParsingError;
-    /**                                                                               */
-    /** If there is none, this is a pure argument:                                    */
-    if (iOpPos == -1) return s32ParseOperand(sInput);
-    /**                                                                               */
-    /** Parse the first operand:                                                      */
-    if (iOpPos == 0) {
-        /** The should be an implicit operand:                                        */
-        if (m_u32Operator == C_TERM_CmdLog) {
-            m_pSubT1 = new CTerm();
-            iRes1    = m_pSubT1->s32Parse(L"e");
-        }
-        else if (m_u32Operator == C_TERM_CmdRoot) {
-            m_pSubT1 = new CTerm();
-            iRes1 = m_pSubT1->s32Parse(L"2");
-        }
-        else if ((m_u32Operator == C_TERM_CmdNeg) ||
-            (m_u32Operator == C_TERM_CmdArcSin) ||
-            (m_u32Operator == C_TERM_CmdArcCos) ||
-            (m_u32Operator == C_TERM_CmdArcTan) ||
-            (m_u32Operator == C_TERM_CmdSin) ||
-            (m_u32Operator == C_TERM_CmdCos) ||
-            (m_u32Operator == C_TERM_CmdTan) ||
-            (m_u32Operator == C_TERM_CmdSubstraction)) {
-            /** There is no first operand expected:                                   */
-            m_pSubT1 = new CTerm();
-            iRes1 = m_pSubT1->s32Parse(L"0");
+    *pu32Root = u32Node;
+    return C_TERM_NumOK;
+}
+
+/** Pushes a frame for the next rule. Nested ones (operands of a pending operation    *
+ *  and brackets) count against the depth of the budget:                              */
+
+bool CTerm::bPushFrame(UINT32 u32Step, UINT32 u32Level, bool bNested) {
+    /** Variables:                                                                    */
+    tTermFrame tFrame;
+    tFrame.u32Step     = u32Step;
+    tFrame.u32Level    = u32Level;
+    tFrame.u32Depth    = m_Frames.empty() ? 0 : m_Frames.back().u32Depth;
+    tFrame.u32Operator = C_TERM_CmdEmpty;
+    tFrame.u32Left     = C_TERM_NoNode;
+    tFrame.u32Base     = 0;
+    tFrame.u32Starts   = 0;
+    tFrame.u32Symbol   = 0;
+    if (bNested) tFrame.u32Depth++;
+    if (tFrame.u32Depth > m_tBudget.u32MaxDepth) return false;
+    m_Frames.push_back(tFrame);
+    return true;
+}
+
+/** Call-Inliner: *********************************************************************
+ *    Inlines a user-function, once its arguments are parsed. They are taken out of   *
+ *    the arena again. Then the body is appended, with each of its arguments          *
+ *    replaced by a copy of the argument's nodes. Thus the arena stays a tree in      *
+ *    postfix-order and the optimizer merges the copies again:                        */
+
+INT32 CTerm::s32InlineCall(const tTermFrame& tFrame, UINT32* pu32Node) {
+    /** Variables:                                                                    */
+    const tTermSymbol*     pSymbol = m_pSymbols->pGetSymbol(tFrame.u32Symbol);
+    std::vector<tTermNode> Arguments;
+    std::vector<UINT32>    Map(pSymbol->Body.size());
+    const UINT32*          pu32Start;
+    tTermNode              tNode;
+    UINT32                 u32Base = tFrame.u32Base;
+    UINT32                 u32Node, u32Copy, u32Index, u32Target;
+    /** A failed redefinition leaves the function without body:                       */
+    if ((m_CallStarts.size() - tFrame.u32Starts != pSymbol->Arguments.size()) || pSymbol->Body.empty()) return C_TERM_ParsingError;
+    m_CallStarts.push_back((UINT32) m_Nodes.size());
+    pu32Start = &m_CallStarts[tFrame.u32Starts];
+    Arguments.assign(m_Nodes.begin() + u32Base, m_Nodes.end());
+    m_Nodes.resize(u32Base);
+    /** Append the body:                                                              */
+    for (u32Node = 0; u32Node < pSymbol->Body.size(); u32Node++) {
+        tNode = pSymbol->Body[u32Node];
+        if (tNode.u32Operator == C_TERM_CmdArgument) {
+            /** Operands within an argument refer to its own nodes only:              */
+            u32Index  = (UINT32) tNode.s64Var;
+            u32Target = (UINT32) m_Nodes.size();
+            for (u32Copy = pu32Start[u32Index]; u32Copy < pu32Start[u32Index + 1]; u32Copy++) {
+                tNode = Arguments[u32Copy - u32Base];
+                if (tNode.u32Sub1 != C_TERM_NoNode) tNode.u32Sub1 = tNode.u32Sub1 - pu32Start[u32Index] + u32Target;
+                if (tNode.u32Sub2 != C_TERM_NoNode) tNode.u32Sub2 = tNode.u32Sub2 - pu32Start[u32Index] + u32Target;
+                m_Nodes.push_back(tNode);
+            }
         }else{
-            /** There should have been but is not:                                    */
-            return C_TERM_ParsingError;
+            if (tNode.u32Sub1 != C_TERM_NoNode) tNode.u32Sub1 = Map[tNode.u32Sub1];
+            if (tNode.u32Sub2 != C_TERM_NoNode) tNode.u32Sub2 = Map[tNode.u32Sub2];
+            m_Nodes.push_back(tNode);
         }
-    }else {
-        if ((m_u32Operator == C_TERM_CmdArcSin) ||
-            (m_u32Operator == C_TERM_CmdArcCos) ||
-            (m_u32Operator == C_TERM_CmdArcTan) ||
-            (m_u32Operator == C_TERM_CmdSin) ||
-            (m_u32Operator == C_TERM_CmdCos) ||
-            (m_u32Operator == C_TERM_CmdTan)) {
-            /** There is no first operand expected:                                   */
-            return C_TERM_ParsingError;
-        }else {
-            /** There is an explicit  defined first operand:                              */
-            m_pSubT1 = new CTerm();
-            iRes1 = m_pSubT1->s32Parse(sInput.substr(0, iOpPos));
-        }
-    }
-    if ((iRes1 != C_TERM_NumOK) && (iRes1 != C_TERM_FuncOK)) return iRes1;
-    /**                                                                               */
-    /** Correct the operator-length:                                                  */
-    if ((m_u32Operator == C_TERM_CmdArcSin) ||
-        (m_u32Operator == C_TERM_CmdArcCos) ||
-        (m_u32Operator == C_TERM_CmdArcTan)) {
-        iOpPos += 3;
-    }
-    if ((m_u32Operator == C_TERM_CmdSin) ||
-        (m_u32Operator == C_TERM_CmdCos) ||
-        (m_u32Operator == C_TERM_CmdTan) ||
-        (m_u32Operator == C_TERM_CmdLog)) {
-        iOpPos += 2;
+        Map[u32Node] = (UINT32) (m_Nodes.size() - 1);
+        if (m_Nodes.size() > m_tBudget.u32MaxNodes) return C_TERM_BudgetExceeded;
     }
-    /**                                                                               */
-    /** Parse the second operand:                                                     */
-    m_pSubT2 = new CTerm();
-    iRes2    = m_pSubT2->s32Parse(sInput.substr(iOpPos + 1));
-    if ((iRes2 != C_TERM_NumOK) && (iRes2 != C_TERM_FuncOK)) return iRes2;
-    /** Check the result and be gone:                                                 */
-    if ((iRes1 == C_TERM_FuncOK) || (iRes2 == C_TERM_FuncOK)) return C_TERM_FuncOK;
+    if (pSymbol->bHasParameter) m_bHasParameter = true;
+    *pu32Node = Map.back();
     return C_TERM_NumOK;
 }
+
+/** Node-Creators: ********************************************************************
+ *    Nodes are appended to the arena, thus operands always precede their            *
+ *    operation and the arena is in postfix-order:                                    */
+
+UINT32 CTerm::u32AddNode(UINT32 u32Operator, UINT32 u32Sub1, UINT32 u32Sub2) {
+    tTermNode tNode;
+    tNode.u32Operator = u32Operator;
+    tNode.u32Sub1     = u32Sub1;
+    tNode.u32Sub2     = u32Sub2;
+    tNode.dVar        = 0;
+    tNode.s64Var      = 0;
+    tNode.bInteger    = false;
+    tNode.u32Token    = C_TERM_NoNode;
+    m_Nodes.push_back(tNode);
+    return (UINT32) (m_Nodes.size() - 1);
+}
+
+UINT32 CTerm::u32AddConstant(double dValue) {
+    UINT32 u32Node = u32AddNode(C_TERM_CmdConstant, C_TERM_NoNode, C_TERM_NoNode);
+    m_Nodes[u32Node].dVar = dValue;
+    return u32Node;
+}
+
+UINT32 CTerm::u32AddInteger(INT64 s64Value) {
+    UINT32 u32Node = u32AddConstant((double) s64Value);
+    m_Nodes[u32Node].s64Var   = s64Value;
+    m_Nodes[u32Node].bInteger = true;
+    return u32Node;
+}
@@ -20,6 +20,10 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+#include <memory>
+
 #define C_TERM_NumOK             0x01
 #define C_TERM_FuncOK            0x02
 #define C_TERM_MissingBrk        0x03
@@ -28,6 +32,9 @@
 #define C_TERM_ParsingError      0x06
 #define C_TERM_DivByZero         0x07
 #define C_TERM_BoolTooLarge      0x08
+#define C_TERM_IntOverflow       0x09    // Only from s32ExecuteInt, s32Execute takes over then
+#define C_TERM_Cancelled         0x0A    // Stopped by its CCancelToken, from s32ExecuteBig and the runners
+#define C_TERM_BudgetExceeded    0x0B    // The term is beyond the nodes or nesting of its tTermBudget
 
 #define C_TERM_CmdEmpty          0x0000
 #define C_TERM_CmdConstant       0x0001
@@ -48,30 +55,231 @@
 #define C_TERM_CmdSin            0x0010
 #define C_TERM_CmdCos            0x0011
 #define C_TERM_CmdTan            0x0012
+#define C_TERM_CmdMinus          0x0013
+#define C_TERM_CmdStore          0x0014  // Only in code: copies the top into a slot
+#define C_TERM_CmdLoad           0x0015  // Only in code: pushes a slot
+#define C_TERM_CmdLogConst       0x0016  // Logarithm to a constant base, dVar is log(base)
+#define C_TERM_CmdSinCos         0x0017  // Only in code: sine on top, cosine into a slot
+#define C_TERM_CmdCosSin         0x0018  // Only in code: cosine on top, sine into a slot
+#define C_TERM_CmdVariable       0x0019  // Symbol of CTermSymbols, s64Var is its index
+#define C_TERM_CmdArgument       0x001A  // Only in function-bodies: argument number s64Var
+
+#define C_TERM_TokEnd            0x00
+#define C_TERM_TokNumber         0x01
+#define C_TERM_TokParameter      0x02
+#define C_TERM_TokOperator       0x03
+#define C_TERM_TokFunction       0x04
+#define C_TERM_TokOpenBrk        0x05
+#define C_TERM_TokCloseBrk       0x06
+#define C_TERM_TokVariable       0x07
+#define C_TERM_TokCall           0x08    // Function of CTermSymbols
+#define C_TERM_TokArgument       0x09    // Argument-name within a function-body
+#define C_TERM_TokComma          0x0A
+
+#define C_TERM_LvlOr             0x00
+#define C_TERM_LvlAnd            0x01
+#define C_TERM_LvlNeg            0x02
+#define C_TERM_LvlAdd            0x03
+#define C_TERM_LvlSub            0x04
+#define C_TERM_LvlMul            0x05
+#define C_TERM_LvlDiv            0x06
+#define C_TERM_LvlSlash          0x07
+#define C_TERM_LvlRoot           0x08
+#define C_TERM_LvlPow            0x09
+#define C_TERM_LvlLog            0x0A
+#define C_TERM_LvlPrimary        0x0B
+
+#define C_TERM_StepLevel         0x00    // Steps of the parser, see s32ParseTree
+#define C_TERM_StepFirst         0x01
+#define C_TERM_StepPrefix        0x02
+#define C_TERM_StepCollect       0x03
+#define C_TERM_StepRight         0x04
+#define C_TERM_StepPrimary       0x05
+#define C_TERM_StepOperand       0x06
+#define C_TERM_StepBracket       0x07
+#define C_TERM_StepClose         0x08
+#define C_TERM_StepCall          0x09
+#define C_TERM_StepArgument      0x0A
+#define C_TERM_StepNextArgument  0x0B
+
+#define C_TERM_NoNode            0xFFFFFFFF
+#define C_TERM_BatchSize         256
+#define C_TERM_JitThreshold      4096    // Evaluations before the machine-code is generated
+#define C_TERM_MaxNodes          0x100000 // Limit of the arena, which nested calls could blow up
+#define C_TERM_DefMaxNodes       C_TERM_MaxNodes
+#define C_TERM_DefMaxDepth       1000    // Nesting of brackets, pending operations and calls
+#define C_TERM_KeywordSlots      64      // Slots of the perfect hash over all keywords
 
 #define C_TERM_MAXINT     0x10000000000000
+#define C_TERM_ExactInt   9007199254740992.0     // 2^53, up to it each integer is a double
+#define C_TERM_BoolSign   9223372036854775808.0  // 2^63, patterns from it on are unsigned
+#define C_TERM_BoolMax    18446744073709551616.0 // 2^64, operands of & | ~ are below it
+
+#define C_TERM_ValE       2.718281828459045235360287471352
+#define C_TERM_ValPi      3.141592653589793238462643383279
+#define C_TERM_ValDeg     0.01745329251994329576923690768489
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct {
+    const WCHAR* pszName;        // Name or operator-character
+    UINT32 u32Type;              // C_TERM_Tok... of its token
+    UINT32 u32Operator;          // C_TERM_Cmd... for operators and functions
+    UINT32 u32Level;             // C_TERM_Lvl... when used as binary operator
+    bool   bRightFirst;          // Associative, thus the right side binds first
+    double dValue;               // Value of a constant, or the implicit first operand
+} tTermKeyword;
+
+typedef struct {
+    UINT32 u32MaxNodes;          // Nodes of the parse-tree, with the inlined functions
+    UINT32 u32MaxDepth;          // Nesting of the parse, see C_TERM_DefMaxDepth
+    UINT32 u32TimeLimit;         // Milliseconds per input, 0 for none, see CCalculator
+} tTermBudget;
 
+typedef struct {
+    UINT32 u32Step;              // C_TERM_Step... to continue with
+    UINT32 u32Level;             // C_TERM_Lvl... of the operators to collect
+    UINT32 u32Depth;             // Nesting, which led to this frame
+    UINT32 u32Operator;          // Operation, which waits for its right operand
+    UINT32 u32Left;              // ... and its left one
+    UINT32 u32Base;              // Arena-size before the arguments of a call
+    UINT32 u32Starts;            // First start of its arguments within m_CallStarts
+    UINT32 u32Symbol;            // Function of a call
+} tTermFrame;
+
+typedef struct {
+    UINT32 u32Type;              // C_TERM_Tok...
+    UINT32 u32Operator;          // C_TERM_Cmd... for operators and functions
+    UINT32 u32Level;             // C_TERM_Lvl... when used as binary operator
+    double dValue;               // Value of a number-token
+    INT64  s64Value;             // Exact value, if it is an integer-literal
+    bool   bInteger;             // Number-token without point, exponent or degree
+    INT32  s32Pos;               // Position within the input-string
+    UINT32 u32Length;            // Characters of a number-token within the input-string
+    UINT32 u32Symbol;            // Index of a symbol or an argument
+    const tTermKeyword* pKeyword; // Descriptor of a keyword, NULL for numbers and symbols
+} tTermToken;
+
+typedef struct {
+    UINT32 u32Operator;          // C_TERM_Cmd...
+    UINT32 u32Sub1;              // Arena-index of the first operand
+    UINT32 u32Sub2;              // Arena-index of the second operand
+    double dVar;                 // Value of a constant
+    INT64  s64Var;               // Exact value of an integer-literal
+    bool   bInteger;             // The constant is an integer-literal
+    UINT32 u32Token;             // Token of a literal, C_TERM_NoNode for implicit constants
+} tTermNode;
+
+typedef struct {
+    UINT32 u32OpCode;            // C_TERM_Cmd... of the operation
+    UINT32 u32Arg;               // Slot of a store or load
+    double dVar;                 // Value to be pushed by a constant
+} tTermInstr;
+
+typedef struct {
+    UINT32 u32OpCode;            // C_TERM_Cmd... of the operation
+    INT64  s64Var;               // Value to be pushed by a constant
+    bool   bUnsigned;            // The constant is a pattern from 2^63 on
+} tTermIntInstr;
+
+typedef struct {
+    INT64  s64Value;             // 64-bit pattern
+    bool   bUnsigned;            // The top bit is set and stands for 2^63, not for -2^63
+} tTermInt;
+
+typedef struct {
+    UINT32 u32Slot;              // Slot, which gets the value before each execution
+    UINT32 u32Symbol;            // Index within CTermSymbols
+} tTermVariable;
+
+typedef struct {
+    double dValue;               // Value of the operand
+    double dSlope;               // Its derivative with respect to x
+} tTermDual;
 
 /** Class Definition: *****************************************************************/
 
+class CTermJit;
+class CBigMath;
+class CTermSymbols;
+class CCancelToken;
+struct tBigFloat;
+
 class CTerm {
 public:
     CTerm();
     ~CTerm();
     void   vReset(void);
-    INT32  s32Parse(const std::wstring sInput);
+    void   vSetFastKernels(bool bFast);
+    void   vSetJit(bool bEnable);
+    void   vSetOptimize(bool bEnable);
+    void   vSetSymbols(CTermSymbols* pSymbols);
+    void   vSetBudget(const tTermBudget& tBudget);
+    INT32  s32Parse(const std::wstring& sInput);
+    INT32  s32ParseBody(const std::wstring& sInput, const std::vector<std::wstring>& Arguments, std::vector<tTermNode>* pBody);
+    void   vGetSymbols(std::vector<UINT32>* pSymbols);
     INT32  s32Execute(const double dInput, double* pdOutput);
+    INT32  s32ExecuteTree(const double dInput, double* pdOutput);
+    INT32  s32ExecuteBatch(const double* pdInput, double* pdOutput, UINT8* pu8Status, size_t uCount);
+    INT32  s32ExecuteInt(tTermInt* pOutput);
+    INT32  s32ExecuteDual(const double dInput, double* pdOutput, double* pdSlope);
+    bool   bIsInteger(void);
+    void   vSetBig(bool bEnable);
+    INT32  s32ExecuteBig(CBigMath* pMath, tBigFloat* pOutput, CCancelToken* pCancel = NULL);
+    static bool bIsKeyword(const std::wstring& sName);
+    static bool   bToPattern(double dValue, tTermInt* pPattern);
+    static double dFromPattern(const tTermInt& tPattern);
+    static void   vBoolean(UINT32 u32OpCode, const tTermInt& tPar1, const tTermInt& tPar2, tTermInt* pResult);
+    static INT32  s32Boolean(UINT32 u32OpCode, double dPar1, double dPar2, double* pdResult);
 protected:
-    bool   bRemoveSurroundingBrackets(std::wstring* psInput);
-    INT32  s32ParseOperand(std::wstring sInput);
-    INT32  s32OperatorFinder (const std::wstring sInput, const std::wstring sOperator);
-    INT32  s32OperatorRevFind(const std::wstring sInput, const std::wstring sOperator);
-    INT32  s32ParseOperator(const std::wstring sInput, UINT32* pu32OpType);
-    INT32  s32Declare(std::wstring sInput);
+    void   vOptimize(void);
+    void   vCompile(void);
+    void   vCompileInteger(void);
+    void   vCompileBig(const std::wstring& sInput);
+    bool   bIsUnary(UINT32 u32Operator);
+    bool   bUseJit(size_t uCount);
+    void   vLoadVariables(double* pdSlots, size_t uStride, size_t uLanes);
+    INT32  s32ExecuteNode(UINT32 u32Node, const double dInput, double* pdOutput);
+    INT32  s32Tokenize(const std::wstring& sInput);
+    void   vSetKeyword(const tTermKeyword* pKeyword, tTermToken* pToken);
+    bool   bFindName(const std::wstring& sName, tTermToken* pToken);
+    INT32  s32ParseNumber(const std::wstring& sInput, size_t* puPos, tTermToken* pToken);
+    INT32  s32ParseTree(UINT32* pu32Root);
+    bool   bPushFrame(UINT32 u32Step, UINT32 u32Level, bool bNested);
+    INT32  s32InlineCall(const tTermFrame& tFrame, UINT32* pu32Node);
+    UINT32 u32AddNode(UINT32 u32Operator, UINT32 u32Sub1, UINT32 u32Sub2);
+    UINT32 u32AddConstant(double dValue);
+    UINT32 u32AddInteger(INT64 s64Value);
 private:
-    CTerm* m_pSubT1;
-    CTerm* m_pSubT2;
-    double m_dVar;
-    UINT32 m_u32Operator;
-    
+    std::vector<tTermNode>  m_Nodes;
+    UINT32                  m_u32Root;
+    std::vector<tTermInstr> m_Code;
+    std::vector<double>     m_Stack;
+    std::vector<double>     m_Slots;
+    std::vector<tTermVariable> m_Variables;
+    std::vector<double>     m_Batch;
+    std::vector<double>     m_BatchSlots;
+    std::vector<tTermIntInstr> m_IntCode;
+    std::vector<tTermInt>   m_IntStack;
+    std::vector<tTermDual>  m_DualStack;
+    std::vector<tTermDual>  m_DualSlots;
+    std::vector<tTermInstr> m_BigCode;
+    std::vector<std::wstring> m_BigLiterals;
+    bool                    m_bBig;
+    std::vector<tTermToken> m_Tokens;
+    size_t                  m_uTokPos;
+    std::vector<tTermFrame> m_Frames;
+    std::vector<UINT32>     m_CallStarts;
+    tTermBudget             m_tBudget;
+    bool                    m_bHasParameter;
+    CTermSymbols*           m_pSymbols;
+    const std::vector<std::wstring>* m_pArguments;
+    std::vector<UINT32>     m_Uses;
+    bool                    m_bFastKernels;
+    std::shared_ptr<CTermJit> m_Jit;
+    std::vector<double>     m_JitFrame;
+    UINT64                  m_u64Runs;
+    bool                    m_bJit;
+    bool                    m_bJitFailed;
+    bool                    m_bOptimize;
 };
@@ -0,0 +1,266 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string>
+#include <math.h>
+#include <utility>
+#include <memory>
+#include "Term.h"
+#include "TermKernels.h"
+#include "TermJit.h"
+
+#if defined(__AVX2__) || defined(__AVX__)
+#include <immintrin.h>
+#define C_BATCH_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define C_BATCH_SSE2
+#endif
+
+/** Local Functions: ******************************************************************/
+
+/** Vector-Kernels: *******************************************************************
+ *    Each kernel works on a full row of the block-stack. AVX handles four,           *
+ *    SSE2 two values at once, the scalar loop does the rest. If both operands are    *
+ *    NaN, the first one is taken like in s32Execute, since the compiler may swap     *
+ *    the operands of + and * and their signs differ (-NaN and NaN are printed):      */
+
+#define C_BATCH_QuietBit    0x0008000000000000LL
+
+#define C_BATCH_SCALAR(OP)                                                              \
+    for (; uPos < uCount; uPos++) {                                                     \
+        pdA[uPos] = isnan(pdA[uPos]) ? (pdA[uPos] + 0.0) : (pdA[uPos] OP pdB[uPos]);    \
+    }
+
+#if defined(C_BATCH_AVX)
+#define C_BATCH_KERNEL(NAME, OP, VOP)                                                   \
+static void NAME(double* pdA, const double* pdB, size_t uCount) {                       \
+    const __m256d vQuiet = _mm256_castsi256_pd(_mm256_set1_epi64x(C_BATCH_QuietBit));   \
+    __m256d       vA, vNaN;                                                             \
+    size_t        uPos = 0;                                                             \
+    for (; uPos + 4 <= uCount; uPos += 4) {                                             \
+        vA   = _mm256_loadu_pd(&pdA[uPos]);                                             \
+        vNaN = _mm256_cmp_pd(vA, vA, _CMP_UNORD_Q);                                     \
+        _mm256_storeu_pd(&pdA[uPos], _mm256_blendv_pd(VOP(vA, _mm256_loadu_pd(&pdB[uPos])), _mm256_or_pd(vA, vQuiet), vNaN)); \
+    }                                                                                   \
+    C_BATCH_SCALAR(OP)                                                                  \
+}
+C_BATCH_KERNEL(vAddRow, +, _mm256_add_pd)
+C_BATCH_KERNEL(vSubRow, -, _mm256_sub_pd)
+C_BATCH_KERNEL(vMulRow, *, _mm256_mul_pd)
+C_BATCH_KERNEL(vDivRow, /, _mm256_div_pd)
+#elif defined(C_BATCH_SSE2)
+#define C_BATCH_KERNEL(NAME, OP, VOP)                                                   \
+static void NAME(double* pdA, const double* pdB, size_t uCount) {                       \
+    const __m128d vQuiet = _mm_castsi128_pd(_mm_set1_epi64x(C_BATCH_QuietBit));         \
+    __m128d       vA, vNaN;                                                             \
+    size_t        uPos = 0;                                                             \
+    for (; uPos + 2 <= uCount; uPos += 2) {                                             \
+        vA   = _mm_loadu_pd(&pdA[uPos]);                                                \
+        vNaN = _mm_cmpunord_pd(vA, vA);                                                 \
+        _mm_storeu_pd(&pdA[uPos], _mm_or_pd(_mm_andnot_pd(vNaN, VOP(vA, _mm_loadu_pd(&pdB[uPos]))), _mm_and_pd(vNaN, _mm_or_pd(vA, vQuiet)))); \
+    }                                                                                   \
+    C_BATCH_SCALAR(OP)                                                                  \
+}
+C_BATCH_KERNEL(vAddRow, +, _mm_add_pd)
+C_BATCH_KERNEL(vSubRow, -, _mm_sub_pd)
+C_BATCH_KERNEL(vMulRow, *, _mm_mul_pd)
+C_BATCH_KERNEL(vDivRow, /, _mm_div_pd)
+#else
+#define C_BATCH_KERNEL(NAME, OP)                                                        \
+static void NAME(double* pdA, const double* pdB, size_t uCount) {                       \
+    size_t uPos = 0;                                                                    \
+    C_BATCH_SCALAR(OP)                                                                  \
+}
+C_BATCH_KERNEL(vAddRow, +)
+C_BATCH_KERNEL(vSubRow, -)
+C_BATCH_KERNEL(vMulRow, *)
+C_BATCH_KERNEL(vDivRow, /)
+#endif
+
+/** Marks all lanes with a failure, which had none before: ****************************/
+
+static inline void vSetStatus(UINT8* pu8Status, size_t uPos, UINT8 u8Error) {
+    if (pu8Status[uPos] == C_TERM_NumOK) pu8Status[uPos] = u8Error;
+}
+
+/** Public Functions: *****************************************************************/
+
+/** Batch-Executor: *******************************************************************
+ *    Evaluates the compiled term for a whole array of x-values. The input is cut     *
+ *    into blocks and each instruction runs once over a complete block, thus the      *
+ *    code is walked once per block instead of once per value. The status of each     *
+ *    element is the one, which s32Execute would have returned for it. Outputs of     *
+ *    failed elements are NaN. The values are the ones of s32Execute as well, unless *
+ *    the fast kernels were selected:                                                 */
+
+INT32 CTerm::s32ExecuteBatch(const double* pdInput, double* pdOutput, UINT8* pu8Status, size_t uCount) {
+    /** Variables:                                                                    */
+    const tTermInstr* pInstr;
+    const tTermInstr* pEnd = m_Code.data() + m_Code.size();
+    double*           pdTop;
+    double*           pdSub;
+    size_t            uBlock, uLen, uPos, uSp;
+    double            dPar1, dPar2;
+    INT32             s32Res;
+    if (m_Code.empty()) return C_TERM_ParsingError;
+    /** Hot terms run as machine-code, which loops over the values itself:            */
+    if (bUseJit(uCount)) {
+        if (!m_Variables.empty()) vLoadVariables(m_JitFrame.data(), 2, 2);
+        m_Jit->vRun(pdInput, pdOutput, pu8Status, uCount, m_JitFrame.data());
+        return C_TERM_NumOK;
+    }
+    /** Make sure, that there is a row for every stack-entry:                         */
+    if (m_Batch.size() < (m_Stack.size() * C_TERM_BatchSize)) m_Batch.resize(m_Stack.size() * C_TERM_BatchSize);
+    if (m_BatchSlots.size() < (m_Slots.size() * C_TERM_BatchSize)) m_BatchSlots.resize(m_Slots.size() * C_TERM_BatchSize);
+    if (!m_Variables.empty()) vLoadVariables(m_BatchSlots.data(), C_TERM_BatchSize, C_TERM_BatchSize);
+    /** Process block by block:                                                       */
+    for (uBlock = 0; uBlock < uCount; uBlock += C_TERM_BatchSize) {
+        uLen  = ((uCount - uBlock) < C_TERM_BatchSize) ? (uCount - uBlock) : C_TERM_BatchSize;
+        pdTop = NULL;
+        uSp   = 0;
+        for (uPos = 0; uPos < uLen; uPos++) pu8Status[uBlock + uPos] = C_TERM_NumOK;
+        /** Run through the code, one row per stack-entry:                            */
+        for (pInstr = m_Code.data(); pInstr < pEnd; pInstr++) {
+            switch (pInstr->u32OpCode) {
+            case C_TERM_CmdConstant:
+                pdTop = &m_Batch[(uSp++) * C_TERM_BatchSize];
+                for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = pInstr->dVar;
+                break;
+            case C_TERM_CmdParameter:
+                pdTop = &m_Batch[(uSp++) * C_TERM_BatchSize];
+                for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = pdInput[uBlock + uPos];
+                break;
+            case C_TERM_CmdStore:
+                pdSub = &m_BatchSlots[pInstr->u32Arg * C_TERM_BatchSize];
+                for (uPos = 0; uPos < uLen; uPos++) pdSub[uPos] = pdTop[uPos];
+                break;
+            case C_TERM_CmdLoad:
+                pdSub = &m_BatchSlots[pInstr->u32Arg * C_TERM_BatchSize];
+                pdTop = &m_Batch[(uSp++) * C_TERM_BatchSize];
+                for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = pdSub[uPos];
+                break;
+            case C_TERM_CmdAddition:
+                pdSub = &m_Batch[(--uSp - 1) * C_TERM_BatchSize];
+                vAddRow(pdSub, pdTop, uLen);
+                pdTop = pdSub;
+                break;
+            case C_TERM_CmdSubstraction:
+                pdSub = &m_Batch[(--uSp - 1) * C_TERM_BatchSize];
+                vSubRow(pdSub, pdTop, uLen);
+                pdTop = pdSub;
+                break;
+            case C_TERM_CmdMultiplication:
+                pdSub = &m_Batch[(--uSp - 1) * C_TERM_BatchSize];
+                vMulRow(pdSub, pdTop, uLen);
+                pdTop = pdSub;
+                break;
+            case C_TERM_CmdMinus:
+                for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = 0.0 - pdTop[uPos];
+                break;
+            case C_TERM_CmdDivision:
+                pdSub = &m_Batch[(--uSp - 1) * C_TERM_BatchSize];
+                for (uPos = 0; uPos < uLen; uPos++) {
+                    if (pdTop[uPos] == 0) vSetStatus(pu8Status, uBlock + uPos, C_TERM_DivByZero);
+                }
+                vDivRow(pdSub, pdTop, uLen);
+                pdTop = pdSub;
+                break;
+            case C_TERM_CmdPower:
+                pdSub = &m_Batch[(--uSp - 1) * C_TERM_BatchSize];
+                for (uPos = 0; uPos < uLen; uPos++) pdSub[uPos] = pow(pdSub[uPos], pdTop[uPos]);
+                pdTop = pdSub;
+                break;
+            case C_TERM_CmdRoot:
+                pdSub = &m_Batch[(--uSp - 1) * C_TERM_BatchSize];
+                for (uPos = 0; uPos < uLen; uPos++) pdSub[uPos] = pow(pdTop[uPos], 1 / pdSub[uPos]);
+                pdTop = pdSub;
+                break;
+            case C_TERM_CmdLog:
+                pdSub = &m_Batch[(--uSp - 1) * C_TERM_BatchSize];
+                for (uPos = 0; uPos < uLen; uPos++) pdSub[uPos] = log(pdTop[uPos]) / log(pdSub[uPos]);
+                pdTop = pdSub;
+                break;
+            case C_TERM_CmdLogConst:
+                for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = log(pdTop[uPos]) / pInstr->dVar;
+                break;
+            case C_TERM_CmdOr:
+            case C_TERM_CmdAnd:
+                pdSub = &m_Batch[(--uSp - 1) * C_TERM_BatchSize];
+                for (uPos = 0; uPos < uLen; uPos++) {
+                    s32Res = s32Boolean(pInstr->u32OpCode, pdSub[uPos], pdTop[uPos], &pdSub[uPos]);
+                    if (s32Res != C_TERM_NumOK) vSetStatus(pu8Status, uBlock + uPos, (UINT8) s32Res);
+                }
+                pdTop = pdSub;
+                break;
+            case C_TERM_CmdNeg:
+                for (uPos = 0; uPos < uLen; uPos++) {
+                    s32Res = s32Boolean(C_TERM_CmdNeg, 0, pdTop[uPos], &pdTop[uPos]);
+                    if (s32Res != C_TERM_NumOK) vSetStatus(pu8Status, uBlock + uPos, (UINT8) s32Res);
+                }
+                break;
+            case C_TERM_CmdArcSin:
+                for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = asin(pdTop[uPos]);
+                break;
+            case C_TERM_CmdArcCos:
+                for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = acos(pdTop[uPos]);
+                break;
+            case C_TERM_CmdArcTan:
+                for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = atan(pdTop[uPos]);
+                break;
+            case C_TERM_CmdSin:
+                if (m_bFastKernels) vKernelSin(pdTop, uLen);
+                else for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = sin(pdTop[uPos]);
+                break;
+            case C_TERM_CmdCos:
+                if (m_bFastKernels) vKernelCos(pdTop, uLen);
+                else for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = cos(pdTop[uPos]);
+                break;
+            case C_TERM_CmdTan:
+                if (m_bFastKernels) vKernelTan(pdTop, uLen);
+                else for (uPos = 0; uPos < uLen; uPos++) pdTop[uPos] = tan(pdTop[uPos]);
+                break;
+            case C_TERM_CmdSinCos:
+            case C_TERM_CmdCosSin:
+                /** Sine and cosine, the one not on top goes to its slot:             */
+                pdSub = &m_BatchSlots[pInstr->u32Arg * C_TERM_BatchSize];
+                if (m_bFastKernels) {
+                    vKernelSinCos(pdTop, pdSub, uLen);
+                }else{
+                    for (uPos = 0; uPos < uLen; uPos++) {
+                        dPar1 = sin(pdTop[uPos]);
+                        pdSub[uPos] = cos(pdTop[uPos]);
+                        pdTop[uPos] = dPar1;
+                    }
+                }
+                if (pInstr->u32OpCode == C_TERM_CmdCosSin) {
+                    for (uPos = 0; uPos < uLen; uPos++) std::swap(pdTop[uPos], pdSub[uPos]);
+                }
+                break;
+            }
+        }
+        /** Hand out the results of this block:                                       */
+        for (uPos = 0; uPos < uLen; uPos++) {
+            pdOutput[uBlock + uPos] = (pu8Status[uBlock + uPos] == C_TERM_NumOK) ? pdTop[uPos] : NAN;
+        }
+    }
+    return C_TERM_NumOK;
+}
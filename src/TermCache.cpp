@@ -0,0 +1,151 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string>
+#include <cwctype>
+#include <iterator>
+#include <utility>
+#include "Term.h"
+#include "TermCache.h"
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************/
+
+CTermCache::CTermCache(INT32 s32Capacity) {
+    m_uCapacity = 0;
+    m_pSymbols  = NULL;
+    m_tBudget.u32MaxNodes  = C_TERM_DefMaxNodes;
+    m_tBudget.u32MaxDepth  = C_TERM_DefMaxDepth;
+    m_tBudget.u32TimeLimit = 0;
+    vSetCapacity(s32Capacity);
+}
+
+/** Destructor: ***********************************************************************/
+
+CTermCache::~CTermCache() {
+}
+
+/** Set-Function of the capacity: *****************************************************
+ *    Zero disables the cache. Surplus entries are dropped, oldest first:             */
+
+void CTermCache::vSetCapacity(INT32 s32Capacity) {
+    m_uCapacity = (s32Capacity > 0) ? (size_t) s32Capacity : 0;
+    while (m_Entries.size() > m_uCapacity) {
+        m_Index.erase(m_Entries.back().sKey);
+        m_Entries.pop_back();
+    }
+}
+
+/** Drops all entries: ****************************************************************/
+
+void CTermCache::vClear(void) {
+    m_Index.clear();
+    m_Entries.clear();
+}
+
+/** Set-Function of the symbol-table, which new entries resolve their names with. As  *
+ *  the entries are compiled against it, the cache is cleared:                        */
+
+void CTermCache::vSetSymbols(CTermSymbols* pSymbols) {
+    vClear();
+    m_pSymbols = pSymbols;
+    m_Scratch.vSetSymbols(pSymbols);
+}
+
+/** Set-Function of the budget of new entries. Inputs, which exceeded the old one,    *
+ *  may fit now, thus the cache is cleared:                                           */
+
+void CTermCache::vSetBudget(const tTermBudget& tBudget) {
+    vClear();
+    m_tBudget = tBudget;
+    m_Scratch.vSetBudget(tBudget);
+}
+
+/** Cached Parser: ********************************************************************
+ *    Returns the compiled term for the input. A hit moves the entry to the front     *
+ *    and skips parsing completely. A miss parses into a new front-entry. If the      *
+ *    cache is full, the least recently used entry is recycled for it, so that its    *
+ *    storage is reused. The pointer is valid until the next call:                    */
+
+INT32 CTermCache::s32Parse(const std::wstring& sInput, CTerm** ppTerm) {
+    /** Variables:                                                                    */
+    tEntryPos Pos;
+    vNormalize(sInput, &m_sKey);
+    /** Without capacity, just parse:                                                 */
+    if (m_uCapacity == 0) {
+        *ppTerm = &m_Scratch;
+        return m_Scratch.s32Parse(m_sKey);
+    }
+    /** Check for a hit:                                                              */
+    auto Hit = m_Index.find(m_sKey);
+    if (Hit != m_Index.end()) {
+        m_Entries.splice(m_Entries.begin(), m_Entries, Hit->second);
+        *ppTerm = &Hit->second->Term;
+        return Hit->second->s32Result;
+    }
+    /** It is a miss, so take the oldest entry, if the cache is full:                 */
+    if (m_Entries.size() >= m_uCapacity) {
+        auto Node = m_Index.extract(m_Entries.back().sKey);
+        m_Entries.splice(m_Entries.begin(), m_Entries, std::prev(m_Entries.end()));
+        Pos = m_Entries.begin();
+        Pos->sKey     = m_sKey;
+        Node.key()    = m_sKey;
+        Node.mapped() = Pos;
+        m_Index.insert(std::move(Node));
+    }else{
+        m_Entries.emplace_front();
+        Pos = m_Entries.begin();
+        Pos->sKey       = m_sKey;
+        Pos->Term.vSetSymbols(m_pSymbols);
+        Pos->Term.vSetBudget(m_tBudget);
+        m_Index[m_sKey] = Pos;
+    }
+    Pos->s32Result = Pos->Term.s32Parse(m_sKey);
+    *ppTerm = &Pos->Term;
+    return Pos->s32Result;
+}
+
+/** Normalizer: ***********************************************************************
+ *    Builds the cache-key by lower-casing, trimming and collapsing white-spaces      *
+ *    to one single blank. Blanks are not simply removed, since 1 2 is no 12:         */
+
+std::wstring CTermCache::sNormalize(const std::wstring& sInput) {
+    std::wstring sKey;
+    vNormalize(sInput, &sKey);
+    return sKey;
+}
+
+/** Same as sNormalize, but into a buffer of the caller, which keeps its storage: ****/
+
+void CTermCache::vNormalize(const std::wstring& sInput, std::wstring* psKey) {
+    bool bBlank = false;
+    psKey->clear();
+    for (WCHAR wc : sInput) {
+        if ((wc == L' ') || (wc == L'\t')) {
+            bBlank = !psKey->empty();
+            continue;
+        }
+        if (bBlank) *psKey += L' ';
+        bBlank = false;
+        *psKey += (WCHAR) towlower(wc);
+    }
+}
@@ -0,0 +1,57 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct {
+    std::wstring sKey;           // Normalized input
+    INT32        s32Result;      // Result of the parser
+    CTerm        Term;           // Compiled term
+} tTermCacheEntry;
+
+/** Class Definition: *****************************************************************/
+
+class CTermCache {
+public:
+    CTermCache(INT32 s32Capacity);
+    ~CTermCache();
+    void   vSetCapacity(INT32 s32Capacity);
+    void   vClear(void);
+    void   vSetSymbols(CTermSymbols* pSymbols);
+    void   vSetBudget(const tTermBudget& tBudget);
+    INT32  s32Parse(const std::wstring& sInput, CTerm** ppTerm);
+    static std::wstring sNormalize(const std::wstring& sInput);
+    static void         vNormalize(const std::wstring& sInput, std::wstring* psKey);
+private:
+    typedef std::list<tTermCacheEntry>::iterator tEntryPos;
+    std::list<tTermCacheEntry>                   m_Entries;
+    std::unordered_map<std::wstring, tEntryPos>  m_Index;
+    size_t                                       m_uCapacity;
+    CTermSymbols*                                m_pSymbols;
+    CTerm                                        m_Scratch;
+    tTermBudget                                  m_tBudget;
+    std::wstring                                 m_sKey;
+};
@@ -0,0 +1,197 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string>
+#include <math.h>
+#include <memory>
+#include "Term.h"
+#include "TermSymbols.h"
+
+/** Public Functions: *****************************************************************/
+
+/** Derivative-Executor: **************************************************************
+ *    Runs the compiled code on dual numbers, thus each value carries its derivative  *
+ *    with respect to x, as forward-mode automatic differentiation. The values and    *
+ *    the status are the ones of s32Execute. The boolean operators are constant in    *
+ *    pieces and get a derivative of zero:                                            */
+
+INT32 CTerm::s32ExecuteDual(const double dInput, double* pdOutput, double* pdSlope) {
+    /** Variables:                                                                    */
+    const tTermInstr* pInstr = m_Code.data();
+    const tTermInstr* pEnd   = pInstr + m_Code.size();
+    tTermDual*        pSp;
+    tTermDual*        pSlot;
+    tTermDual         tPar1, tPar2;
+    double            dValue, dFactor;
+    INT32             s32Res;
+    if (pInstr == pEnd) return C_TERM_ParsingError;
+    if (m_DualStack.size() < m_Stack.size()) m_DualStack.resize(m_Stack.size());
+    if (m_DualSlots.size() < m_Slots.size()) m_DualSlots.resize(m_Slots.size());
+    pSp   = m_DualStack.data();
+    pSlot = m_DualSlots.data();
+    /** Variables do not depend on x:                                                 */
+    for (const tTermVariable& tVariable : m_Variables) {
+        pSlot[tVariable.u32Slot].dValue = m_pSymbols->dGetValue(tVariable.u32Symbol);
+        pSlot[tVariable.u32Slot].dSlope = 0;
+    }
+    /** Run through the code:                                                         */
+    for (; pInstr < pEnd; pInstr++) {
+        switch (pInstr->u32OpCode) {
+        case C_TERM_CmdConstant:
+            pSp->dValue = pInstr->dVar;
+            pSp->dSlope = 0;
+            pSp++;
+            break;
+        case C_TERM_CmdParameter:
+            pSp->dValue = dInput;
+            pSp->dSlope = 1;
+            pSp++;
+            break;
+        case C_TERM_CmdStore:
+            pSlot[pInstr->u32Arg] = pSp[-1];
+            break;
+        case C_TERM_CmdLoad:
+            *pSp++ = pSlot[pInstr->u32Arg];
+            break;
+        case C_TERM_CmdAddition:
+            pSp--;
+            pSp[-1].dValue += pSp[0].dValue;
+            pSp[-1].dSlope += pSp[0].dSlope;
+            break;
+        case C_TERM_CmdSubstraction:
+            pSp--;
+            pSp[-1].dValue -= pSp[0].dValue;
+            pSp[-1].dSlope -= pSp[0].dSlope;
+            break;
+        case C_TERM_CmdMultiplication:
+            pSp--;
+            tPar1 = pSp[-1];
+            tPar2 = pSp[0];
+            pSp[-1].dValue = tPar1.dValue * tPar2.dValue;
+            pSp[-1].dSlope = tPar1.dSlope * tPar2.dValue + tPar1.dValue * tPar2.dSlope;
+            break;
+        case C_TERM_CmdMinus:
+            pSp[-1].dValue = 0.0 - pSp[-1].dValue;
+            pSp[-1].dSlope = 0.0 - pSp[-1].dSlope;
+            break;
+        case C_TERM_CmdDivision:
+            pSp--;
+            tPar1 = pSp[-1];
+            tPar2 = pSp[0];
+            if (tPar2.dValue == 0) return C_TERM_DivByZero;
+            pSp[-1].dValue = tPar1.dValue / tPar2.dValue;
+            pSp[-1].dSlope = (tPar1.dSlope - pSp[-1].dValue * tPar2.dSlope) / tPar2.dValue;
+            break;
+        case C_TERM_CmdPower:
+            /** (a^b)' = b a^(b-1) a' + a^b log(a) b', each part only if it is needed: */
+            pSp--;
+            tPar1 = pSp[-1];
+            tPar2 = pSp[0];
+            pSp[-1].dValue = pow(tPar1.dValue, tPar2.dValue);
+            pSp[-1].dSlope = 0;
+            if (tPar1.dSlope != 0) pSp[-1].dSlope += tPar2.dValue * pow(tPar1.dValue, tPar2.dValue - 1) * tPar1.dSlope;
+            if (tPar2.dSlope != 0) pSp[-1].dSlope += pSp[-1].dValue * log(tPar1.dValue) * tPar2.dSlope;
+            break;
+        case C_TERM_CmdRoot:
+            /** The same with the exponent 1/a:                                       */
+            pSp--;
+            tPar1 = pSp[-1];
+            tPar2 = pSp[0];
+            dFactor = 1 / tPar1.dValue;
+            pSp[-1].dValue = pow(tPar2.dValue, dFactor);
+            pSp[-1].dSlope = 0;
+            if (tPar2.dSlope != 0) pSp[-1].dSlope += dFactor * pow(tPar2.dValue, dFactor - 1) * tPar2.dSlope;
+            if (tPar1.dSlope != 0) pSp[-1].dSlope -= pSp[-1].dValue * log(tPar2.dValue) * dFactor * dFactor * tPar1.dSlope;
+            break;
+        case C_TERM_CmdLog:
+            /** log(b) / log(a), by the quotient rule:                                */
+            pSp--;
+            tPar1 = pSp[-1];
+            tPar2 = pSp[0];
+            dFactor = log(tPar1.dValue);
+            pSp[-1].dValue = log(tPar2.dValue) / dFactor;
+            pSp[-1].dSlope = (tPar2.dSlope / tPar2.dValue - pSp[-1].dValue * tPar1.dSlope / tPar1.dValue) / dFactor;
+            break;
+        case C_TERM_CmdLogConst:
+            pSp[-1].dSlope = pSp[-1].dSlope / (pSp[-1].dValue * pInstr->dVar);
+            pSp[-1].dValue = log(pSp[-1].dValue) / pInstr->dVar;
+            break;
+        case C_TERM_CmdOr:
+        case C_TERM_CmdAnd:
+            pSp--;
+            s32Res = s32Boolean(pInstr->u32OpCode, pSp[-1].dValue, pSp[0].dValue, &pSp[-1].dValue);
+            if (s32Res != C_TERM_NumOK) return s32Res;
+            pSp[-1].dSlope = 0;
+            break;
+        case C_TERM_CmdNeg:
+            s32Res = s32Boolean(C_TERM_CmdNeg, 0, pSp[-1].dValue, &pSp[-1].dValue);
+            if (s32Res != C_TERM_NumOK) return s32Res;
+            pSp[-1].dSlope = 0;
+            break;
+        case C_TERM_CmdArcSin:
+            dValue = pSp[-1].dValue;
+            pSp[-1].dValue = asin(dValue);
+            pSp[-1].dSlope = pSp[-1].dSlope / sqrt(1 - dValue * dValue);
+            break;
+        case C_TERM_CmdArcCos:
+            dValue = pSp[-1].dValue;
+            pSp[-1].dValue = acos(dValue);
+            pSp[-1].dSlope = 0.0 - pSp[-1].dSlope / sqrt(1 - dValue * dValue);
+            break;
+        case C_TERM_CmdArcTan:
+            dValue = pSp[-1].dValue;
+            pSp[-1].dValue = atan(dValue);
+            pSp[-1].dSlope = pSp[-1].dSlope / (1 + dValue * dValue);
+            break;
+        case C_TERM_CmdSin:
+            dValue = pSp[-1].dValue;
+            pSp[-1].dValue = sin(dValue);
+            pSp[-1].dSlope = pSp[-1].dSlope * cos(dValue);
+            break;
+        case C_TERM_CmdCos:
+            dValue = pSp[-1].dValue;
+            pSp[-1].dValue = cos(dValue);
+            pSp[-1].dSlope = 0.0 - pSp[-1].dSlope * sin(dValue);
+            break;
+        case C_TERM_CmdTan:
+            dValue  = pSp[-1].dValue;
+            dFactor = cos(dValue);
+            pSp[-1].dValue = tan(dValue);
+            pSp[-1].dSlope = pSp[-1].dSlope / (dFactor * dFactor);
+            break;
+        case C_TERM_CmdSinCos:
+        case C_TERM_CmdCosSin:
+            /** Both share the argument, the other one goes into the slot:            */
+            dValue  = sin(pSp[-1].dValue);
+            dFactor = cos(pSp[-1].dValue);
+            tPar1.dValue = dValue;
+            tPar1.dSlope = pSp[-1].dSlope * dFactor;
+            tPar2.dValue = dFactor;
+            tPar2.dSlope = 0.0 - pSp[-1].dSlope * dValue;
+            pSp[-1] = (pInstr->u32OpCode == C_TERM_CmdSinCos) ? tPar1 : tPar2;
+            pSlot[pInstr->u32Arg] = (pInstr->u32OpCode == C_TERM_CmdSinCos) ? tPar2 : tPar1;
+            break;
+        }
+    }
+    *pdOutput = pSp[-1].dValue;
+    *pdSlope  = pSp[-1].dSlope;
+    return C_TERM_NumOK;
+}
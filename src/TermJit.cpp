@@ -0,0 +1,639 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+#include <initializer_list>
+#include "Term.h"
+#include "TermJit.h"
+
+#if defined(C_JIT_Available)
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#endif
+
+/** Used Defines: *********************************************************************/
+
+#define C_JIT_RegRax         0x00
+#define C_JIT_RegRcx         0x01
+#define C_JIT_RegRdx         0x02
+#define C_JIT_RegRbx         0x03
+#define C_JIT_RegRsp         0x04
+#define C_JIT_RegRbp         0x05
+#define C_JIT_RegRdi         0x07
+#define C_JIT_RegR12         0x0C
+#define C_JIT_RegR13         0x0D
+
+#define C_JIT_FirstStackReg  4           // Stack-entry i lives in xmm4+i
+#define C_JIT_NoOperand      ((size_t) -1)
+#define C_JIT_PrefixNone     0x00
+#define C_JIT_PrefixPd       0x66        // Packed doubles
+#define C_JIT_PrefixSd       0xF2        // Scalar double
+
+#define C_JIT_OpMovUpLoad    0x10        // With 0x66: movupd, with 0xF2: movsd
+#define C_JIT_OpMovUpStore   0x11
+#define C_JIT_OpMovHpdLoad   0x16        // With 0x66: movhpd xmm, m64
+#define C_JIT_OpMovApLoad    0x28        // With 0x66: movapd
+#define C_JIT_OpUComiSd      0x2E        // With 0x66
+#define C_JIT_OpMovMskPd     0x50        // With 0x66
+#define C_JIT_OpXorPd        0x57        // With 0x66
+#define C_JIT_OpAdd          0x58
+#define C_JIT_OpMul          0x59
+#define C_JIT_OpSub          0x5C
+#define C_JIT_OpDiv          0x5E
+#define C_JIT_OpCmpPd        0xC2        // With 0x66 and a predicate
+
+#define C_JIT_CmpEqual       0x00
+
+#define C_JIT_CondAlways     0x00
+#define C_JIT_CondBelow      0x82        // Second byte of jcc rel32
+#define C_JIT_CondAboveEqual 0x83
+#define C_JIT_CondEqual      0x84
+#define C_JIT_CondNotEqual   0x85
+#define C_JIT_CondAbove      0x87
+#define C_JIT_CondParity     0x8A
+
+#define C_JIT_StackFrame     200         // Shadow-space, run-limit and the saved xmm6-15
+#define C_JIT_LimitOffset    32          // [rsp+32]: end of the current scalar run
+#define C_JIT_XmmSaveOffset  40
+
+#if defined(_WIN32)
+#define C_JIT_RegArg         C_JIT_RegRcx
+#define C_JIT_RegPtrArg      C_JIT_RegRdx    // Pointer after a double, by position
+#else
+#define C_JIT_RegArg         C_JIT_RegRdi
+#define C_JIT_RegPtrArg      C_JIT_RegRdi    // First integer-argument
+#endif
+
+/** Local Functions: ******************************************************************/
+
+#if defined(C_JIT_Available)
+
+/** The libm is called through these, so the calls need no overload-resolution: *******/
+
+static double dJitPow(double dBase, double dExp) { return pow(dBase, dExp); }
+static double dJitLog(double dValue)             { return log(dValue); }
+static double dJitAsin(double dValue)            { return asin(dValue); }
+static double dJitAcos(double dValue)            { return acos(dValue); }
+static double dJitAtan(double dValue)            { return atan(dValue); }
+static double dJitSin(double dValue)             { return sin(dValue); }
+static double dJitCos(double dValue)             { return cos(dValue); }
+static double dJitTan(double dValue)             { return tan(dValue); }
+
+/** Like in s32Execute, the compiler fuses these into one sincos, where there is one: */
+
+static double dJitSinCos(double dValue, double* pdCos) {
+    *pdCos = cos(dValue);
+    return sin(dValue);
+}
+
+static double dJitCosSin(double dValue, double* pdSin) {
+    *pdSin = sin(dValue);
+    return cos(dValue);
+}
+
+/** The bool-ops of CTerm, NaN tells the code to jump to BoolFail: ********************/
+
+static double dJitOr(double dPar1, double dPar2) {
+    double dResult;
+    if (CTerm::s32Boolean(C_TERM_CmdOr, dPar1, dPar2, &dResult) != C_TERM_NumOK) return NAN;
+    return dResult;
+}
+
+static double dJitAnd(double dPar1, double dPar2) {
+    double dResult;
+    if (CTerm::s32Boolean(C_TERM_CmdAnd, dPar1, dPar2, &dResult) != C_TERM_NumOK) return NAN;
+    return dResult;
+}
+
+static double dJitNot(double dValue) {
+    double dResult;
+    if (CTerm::s32Boolean(C_TERM_CmdNeg, 0, dValue, &dResult) != C_TERM_NumOK) return NAN;
+    return dResult;
+}
+
+#define C_JIT_CALL(FUNC) ((UINT64) (uintptr_t) (FUNC))
+
+/** Assembler: ************************************************************************
+ *    Emits the few instructions, which the translation needs. Jumps go to labels,    *
+ *    constants to a pool behind the code, both are patched by vFinish:               */
+
+class CJitAssembler {
+public:
+    std::vector<UINT8> Bytes;
+    void vEmit(std::initializer_list<UINT8> Code) {
+        Bytes.insert(Bytes.end(), Code.begin(), Code.end());
+    }
+    void vEmit32(UINT32 u32Value) {
+        for (int iByte = 0; iByte < 4; iByte++) Bytes.push_back((UINT8) (u32Value >> (8 * iByte)));
+    }
+    void vEmit64(UINT64 u64Value) {
+        for (int iByte = 0; iByte < 8; iByte++) Bytes.push_back((UINT8) (u64Value >> (8 * iByte)));
+    }
+    /** Prefix, REX and opcode of an SSE-op, R extends modrm.reg, B the base:         */
+    void vSseHead(UINT8 u8Prefix, UINT8 u8Op, UINT32 u32Reg, UINT32 u32Base, bool bWide = false) {
+        UINT8 u8Rex = (UINT8) (0x40 | (bWide ? 0x08 : 0) | ((u32Reg & 8) ? 0x04 : 0) | ((u32Base & 8) ? 0x01 : 0));
+        if (u8Prefix != C_JIT_PrefixNone) Bytes.push_back(u8Prefix);
+        if (u8Rex != 0x40) Bytes.push_back(u8Rex);
+        vEmit({ 0x0F, u8Op });
+    }
+    /** op xmm, xmm:                                                                  */
+    void vSseReg(UINT8 u8Prefix, UINT8 u8Op, UINT32 u32Dst, UINT32 u32Src) {
+        vSseHead(u8Prefix, u8Op, u32Dst, u32Src);
+        Bytes.push_back((UINT8) (0xC0 | ((u32Dst & 7) << 3) | (u32Src & 7)));
+    }
+    /** op xmm, [rbx + disp32] or op [rbx + disp32], xmm:                             */
+    void vSseFrame(UINT8 u8Prefix, UINT8 u8Op, UINT32 u32Reg, size_t uOffset) {
+        vSseHead(u8Prefix, u8Op, u32Reg, C_JIT_RegRbx);
+        Bytes.push_back((UINT8) (0x80 | ((u32Reg & 7) << 3) | C_JIT_RegRbx));
+        vEmit32((UINT32) uOffset);
+    }
+    /** op xmm, [r12/r13 + rbp*8]:                                                    */
+    void vSseIndexed(UINT8 u8Prefix, UINT8 u8Op, UINT32 u32Reg, UINT32 u32Base) {
+        vSseHead(u8Prefix, u8Op, u32Reg, u32Base);
+        vEmit({ (UINT8) (0x44 | ((u32Reg & 7) << 3)), (UINT8) (0xE8 | (u32Base & 7)), 0x00 });
+    }
+    /** op xmm, [rip + constant], the pool-entries hold the value twice:              */
+    void vSsePool(UINT8 u8Prefix, UINT8 u8Op, UINT32 u32Reg, double dValue) {
+        UINT64 u64Bits;
+        size_t uEntry;
+        memcpy(&u64Bits, &dValue, sizeof(u64Bits));
+        for (uEntry = 0; uEntry < Pool.size(); uEntry++) if (Pool[uEntry] == u64Bits) break;
+        if (uEntry == Pool.size()) Pool.push_back(u64Bits);
+        vSseHead(u8Prefix, u8Op, u32Reg, 0);
+        Bytes.push_back((UINT8) (0x05 | ((u32Reg & 7) << 3)));
+        vEmit32(0);
+        PoolFixups.push_back(std::make_pair(Bytes.size(), uEntry));
+    }
+    /** mov rax/rcx, imm64:                                                           */
+    void vMovImm(UINT32 u32Reg, UINT64 u64Value) {
+        vEmit({ 0x48, (UINT8) (0xB8 + u32Reg) });
+        vEmit64(u64Value);
+    }
+    void vCall(UINT64 u64Func) {
+        vMovImm(C_JIT_RegRax, u64Func);
+        vEmit({ 0xFF, 0xD0 });                                 // call rax
+    }
+    /** Labels and jumps with rel32:                                                  */
+    UINT32 u32Label(void) {
+        Labels.push_back(0);
+        return (UINT32) (Labels.size() - 1);
+    }
+    void vBind(UINT32 u32Label) {
+        Labels[u32Label] = Bytes.size();
+    }
+    void vJump(UINT8 u8Cond, UINT32 u32Label) {
+        if (u8Cond == C_JIT_CondAlways) vEmit({ 0xE9 });
+        else vEmit({ 0x0F, u8Cond });
+        vEmit32(0);
+        JumpFixups.push_back(std::make_pair(Bytes.size(), (size_t) u32Label));
+    }
+    /** Appends the 16-byte aligned pool and patches all references:                  */
+    void vFinish(void) {
+        size_t uPool;
+        while (Bytes.size() % 16) Bytes.push_back(0xCC);
+        uPool = Bytes.size();
+        for (UINT64 u64Bits : Pool) {
+            vEmit64(u64Bits);
+            vEmit64(u64Bits);
+        }
+        for (const auto& tFix : JumpFixups) vPatch(tFix.first, Labels[tFix.second]);
+        for (const auto& tFix : PoolFixups) vPatch(tFix.first, uPool + 16 * tFix.second);
+    }
+private:
+    void vPatch(size_t uEnd, size_t uTarget) {
+        UINT32 u32Rel = (UINT32) (uTarget - uEnd);
+        memcpy(&Bytes[uEnd - 4], &u32Rel, sizeof(u32Rel));
+    }
+    std::vector<size_t>                      Labels;
+    std::vector<std::pair<size_t, size_t> >  JumpFixups;
+    std::vector<std::pair<size_t, size_t> >  PoolFixups;
+    std::vector<UINT64>                      Pool;
+};
+
+/** Translator of one loop-body: ******************************************************
+ *    The packed body evaluates two values at once. Whenever one of them needs the    *
+ *    special handling of a division by zero or of a root of a non-positive value,    *
+ *    it jumps to Redo and the scalar body takes over the pair. The scalar body       *
+ *    jumps to DivFail or BoolFail. Calls clobber all xmm-registers, thus the stack   *
+ *    is spilled into the frame around them and each lane gets a call of its own:     */
+
+class CJitBody {
+public:
+    CJitBody(CJitAssembler* pAsm, size_t uSlots, bool bPacked, UINT32 u32Redo, UINT32 u32DivFail, UINT32 u32BoolFail) {
+        m_pAsm        = pAsm;
+        m_uSlots      = uSlots;
+        m_bPacked     = bPacked;
+        m_u8Prefix    = bPacked ? C_JIT_PrefixPd : C_JIT_PrefixSd;
+        m_u32Redo     = u32Redo;
+        m_u32DivFail  = u32DivFail;
+        m_u32BoolFail = u32BoolFail;
+    }
+    bool bEmit(const std::vector<tTermInstr>& Code);
+private:
+    UINT32 u32Reg(size_t uEntry)        { return (UINT32) (C_JIT_FirstStackReg + uEntry); }
+    size_t uSlotOffset(size_t uSlot)    { return 16 * uSlot; }
+    size_t uSpillOffset(size_t uEntry)  { return 16 * (m_uSlots + uEntry); }
+    size_t uTempOffset(void)            { return 16 * (m_uSlots + C_JIT_Registers); }
+    void   vSpill(size_t uCount);
+    void   vReload(size_t uCount);
+    void   vLoadLanes(UINT32 u32Xmm, size_t uOffset);
+    void   vCallLanes(UINT64 u64Func, size_t uArg1, size_t uArg2, size_t uResult, size_t uPointer = C_JIT_NoOperand);
+    CJitAssembler* m_pAsm;
+    size_t         m_uSlots;
+    bool           m_bPacked;
+    UINT8          m_u8Prefix;
+    UINT32         m_u32Redo, m_u32DivFail, m_u32BoolFail;
+};
+
+void CJitBody::vSpill(size_t uCount) {
+    for (size_t uEntry = 0; uEntry < uCount; uEntry++) {
+        m_pAsm->vSseFrame(C_JIT_PrefixPd, C_JIT_OpMovUpStore, u32Reg(uEntry), uSpillOffset(uEntry));
+    }
+}
+
+void CJitBody::vReload(size_t uCount) {
+    for (size_t uEntry = 0; uEntry < uCount; uEntry++) vLoadLanes(u32Reg(uEntry), uSpillOffset(uEntry));
+}
+
+/** Loads lane by lane. A load of 16 bytes, which were stored as two lanes, would    *
+ *  miss the store-forwarding and stall:                                              */
+
+void CJitBody::vLoadLanes(UINT32 u32Xmm, size_t uOffset) {
+    m_pAsm->vSseFrame(C_JIT_PrefixSd, C_JIT_OpMovUpLoad, u32Xmm, uOffset);
+    if (m_bPacked) m_pAsm->vSseFrame(C_JIT_PrefixPd, C_JIT_OpMovHpdLoad, u32Xmm, uOffset + 8);
+}
+
+/** Calls a function of one or two arguments for each lane. A function with a second *
+ *  result gets a pointer to uPointer. All operands are frame-offsets:                */
+
+void CJitBody::vCallLanes(UINT64 u64Func, size_t uArg1, size_t uArg2, size_t uResult, size_t uPointer) {
+    for (size_t uLane = 0; uLane < (m_bPacked ? 2U : 1U); uLane++) {
+        m_pAsm->vSseFrame(C_JIT_PrefixSd, C_JIT_OpMovUpLoad, 0, uArg1 + 8 * uLane);
+        if (uArg2 != C_JIT_NoOperand) m_pAsm->vSseFrame(C_JIT_PrefixSd, C_JIT_OpMovUpLoad, 1, uArg2 + 8 * uLane);
+        if (uPointer != C_JIT_NoOperand) {                                   // lea reg, [rbx+disp32]
+            m_pAsm->vEmit({ 0x48, 0x8D, (UINT8) (0x80 | (C_JIT_RegPtrArg << 3) | C_JIT_RegRbx) });
+            m_pAsm->vEmit32((UINT32) (uPointer + 8 * uLane));
+        }
+        m_pAsm->vCall(u64Func);
+        m_pAsm->vSseFrame(C_JIT_PrefixSd, C_JIT_OpMovUpStore, 0, uResult + 8 * uLane);
+    }
+}
+
+bool CJitBody::bEmit(const std::vector<tTermInstr>& Code) {
+    /** Variables:                                                                    */
+    CJitAssembler* pAsm = m_pAsm;
+    UINT8          u8Pre = m_u8Prefix;
+    size_t         uSp   = 0;
+    UINT32         u32Top, u32Sub, u32Label1, u32Label2;
+    for (const tTermInstr& tInstr : Code) {
+        u32Top = u32Reg(uSp - 1);
+        u32Sub = u32Reg(uSp - 2);
+        switch (tInstr.u32OpCode) {
+        case C_TERM_CmdConstant:
+            pAsm->vSsePool(C_JIT_PrefixPd, C_JIT_OpMovApLoad, u32Reg(uSp++), tInstr.dVar);
+            break;
+        case C_TERM_CmdParameter:
+            pAsm->vSseIndexed(u8Pre, C_JIT_OpMovUpLoad, u32Reg(uSp++), C_JIT_RegR12);
+            break;
+        case C_TERM_CmdLoad:
+            vLoadLanes(u32Reg(uSp++), uSlotOffset(tInstr.u32Arg));
+            break;
+        case C_TERM_CmdStore:
+            pAsm->vSseFrame(C_JIT_PrefixPd, C_JIT_OpMovUpStore, u32Top, uSlotOffset(tInstr.u32Arg));
+            break;
+        case C_TERM_CmdAddition:
+            pAsm->vSseReg(u8Pre, C_JIT_OpAdd, u32Sub, u32Top);
+            uSp--;
+            break;
+        case C_TERM_CmdSubstraction:
+            pAsm->vSseReg(u8Pre, C_JIT_OpSub, u32Sub, u32Top);
+            uSp--;
+            break;
+        case C_TERM_CmdMultiplication:
+            pAsm->vSseReg(u8Pre, C_JIT_OpMul, u32Sub, u32Top);
+            uSp--;
+            break;
+        case C_TERM_CmdDivision:
+            /** The divisor must not be zero, NaN is unordered and passes:            */
+            pAsm->vSseReg(C_JIT_PrefixPd, C_JIT_OpXorPd, 0, 0);
+            if (m_bPacked) {
+                pAsm->vSseReg(C_JIT_PrefixPd, C_JIT_OpCmpPd, 0, u32Top);
+                pAsm->vEmit({ C_JIT_CmpEqual });
+                pAsm->vSseReg(C_JIT_PrefixPd, C_JIT_OpMovMskPd, C_JIT_RegRax, 0);
+                pAsm->vEmit({ 0x85, 0xC0 });                   // test eax, eax
+                pAsm->vJump(C_JIT_CondNotEqual, m_u32Redo);
+            }else{
+                u32Label1 = pAsm->u32Label();
+                pAsm->vSseReg(C_JIT_PrefixPd, C_JIT_OpUComiSd, u32Top, 0);
+                pAsm->vJump(C_JIT_CondParity, u32Label1);
+                pAsm->vJump(C_JIT_CondEqual, m_u32DivFail);
+                pAsm->vBind(u32Label1);
+            }
+            pAsm->vSseReg(u8Pre, C_JIT_OpDiv, u32Sub, u32Top);
+            uSp--;
+            break;
+        case C_TERM_CmdMinus:
+            pAsm->vSseReg(C_JIT_PrefixPd, C_JIT_OpXorPd, 0, 0);
+            pAsm->vSseReg(u8Pre, C_JIT_OpSub, 0, u32Top);
+            pAsm->vSseReg(C_JIT_PrefixPd, C_JIT_OpMovApLoad, u32Top, 0);
+            break;
+        case C_TERM_CmdPower:
+            vSpill(uSp);
+            vCallLanes(C_JIT_CALL(dJitPow), uSpillOffset(uSp - 2), uSpillOffset(uSp - 1), uSpillOffset(uSp - 2));
+            vReload(--uSp);
+            break;
+        case C_TERM_CmdRoot:
+            pAsm->vSsePool(C_JIT_PrefixPd, C_JIT_OpMovApLoad, 0, 1.0);
+            pAsm->vSseReg(u8Pre, C_JIT_OpDiv, 0, u32Sub);
+            pAsm->vSseReg(C_JIT_PrefixPd, C_JIT_OpMovApLoad, u32Sub, 0);
+            vSpill(uSp);
+            vCallLanes(C_JIT_CALL(dJitPow), uSpillOffset(uSp - 1), uSpillOffset(uSp - 2), uSpillOffset(uSp - 2));
+            vReload(--uSp);
+            break;
+        case C_TERM_CmdLog:
+            vSpill(uSp);
+            vCallLanes(C_JIT_CALL(dJitLog), uSpillOffset(uSp - 1), C_JIT_NoOperand, uSpillOffset(uSp - 1));
+            vCallLanes(C_JIT_CALL(dJitLog), uSpillOffset(uSp - 2), C_JIT_NoOperand, uSpillOffset(uSp - 2));
+            vReload(uSp);
+            pAsm->vSseReg(C_JIT_PrefixPd, C_JIT_OpMovApLoad, 0, u32Top);
+            pAsm->vSseReg(u8Pre, C_JIT_OpDiv, 0, u32Sub);
+            pAsm->vSseReg(C_JIT_PrefixPd, C_JIT_OpMovApLoad, u32Sub, 0);
+            uSp--;
+            break;
+        case C_TERM_CmdLogConst:
+            vSpill(uSp);
+            vCallLanes(C_JIT_CALL(dJitLog), uSpillOffset(uSp - 1), C_JIT_NoOperand, uSpillOffset(uSp - 1));
+            vReload(uSp);
+            pAsm->vSsePool(C_JIT_PrefixPd, C_JIT_OpMovApLoad, 0, tInstr.dVar);
+            pAsm->vSseReg(u8Pre, C_JIT_OpDiv, u32Top, 0);
+            break;
+        case C_TERM_CmdArcSin:
+        case C_TERM_CmdArcCos:
+        case C_TERM_CmdArcTan:
+        case C_TERM_CmdSin:
+        case C_TERM_CmdCos:
+        case C_TERM_CmdTan:
+            vSpill(uSp);
+            vCallLanes((tInstr.u32OpCode == C_TERM_CmdArcSin) ? C_JIT_CALL(dJitAsin) :
+                       (tInstr.u32OpCode == C_TERM_CmdArcCos) ? C_JIT_CALL(dJitAcos) :
+                       (tInstr.u32OpCode == C_TERM_CmdArcTan) ? C_JIT_CALL(dJitAtan) :
+                       (tInstr.u32OpCode == C_TERM_CmdSin)    ? C_JIT_CALL(dJitSin)  :
+                       (tInstr.u32OpCode == C_TERM_CmdCos)    ? C_JIT_CALL(dJitCos)  : C_JIT_CALL(dJitTan),
+                       uSpillOffset(uSp - 1), C_JIT_NoOperand, uSpillOffset(uSp - 1));
+            vReload(uSp);
+            break;
+        case C_TERM_CmdSinCos:
+        case C_TERM_CmdCosSin:
+            /** The partner goes to its slot, the top is replaced:                    */
+            vSpill(uSp);
+            vCallLanes((tInstr.u32OpCode == C_TERM_CmdSinCos) ? C_JIT_CALL(dJitSinCos) : C_JIT_CALL(dJitCosSin),
+                       uSpillOffset(uSp - 1), C_JIT_NoOperand, uSpillOffset(uSp - 1), uSlotOffset(tInstr.u32Arg));
+            vReload(uSp);
+            break;
+        case C_TERM_CmdOr:
+        case C_TERM_CmdAnd:
+        case C_TERM_CmdNeg:
+            /** The bool-ops run in the scalar body, which has a status per value:    */
+            if (m_bPacked) return false;
+            vSpill(uSp);
+            if (tInstr.u32OpCode == C_TERM_CmdNeg) {
+                vCallLanes(C_JIT_CALL(dJitNot), uSpillOffset(uSp - 1), C_JIT_NoOperand, uSpillOffset(uSp - 1));
+                vReload(uSp);
+            }else{
+                vCallLanes((tInstr.u32OpCode == C_TERM_CmdOr) ? C_JIT_CALL(dJitOr) : C_JIT_CALL(dJitAnd),
+                           uSpillOffset(uSp - 2), uSpillOffset(uSp - 1), uSpillOffset(uSp - 2));
+                vReload(--uSp);
+                u32Top = u32Sub;
+            }
+            pAsm->vSseReg(C_JIT_PrefixPd, C_JIT_OpUComiSd, u32Top, u32Top);
+            pAsm->vJump(C_JIT_CondParity, m_u32BoolFail);
+            break;
+        default:
+            return false;
+        }
+        if (uSp > C_JIT_Registers) return false;
+    }
+    if (uSp != 1) return false;
+    /** Store the result and the status:                                              */
+    pAsm->vSseIndexed(u8Pre, C_JIT_OpMovUpStore, u32Reg(0), C_JIT_RegR13);
+    if (m_bPacked) {
+        pAsm->vEmit({ 0x66, 0x41, 0xC7, 0x04, 0x2E, C_TERM_NumOK, C_TERM_NumOK });  // mov word [r14+rbp], ...
+    }else{
+        pAsm->vEmit({ 0x41, 0xC6, 0x04, 0x2E, C_TERM_NumOK });                      // mov byte [r14+rbp], ...
+    }
+    return true;
+}
+
+/** Checks, if all operations work on both lanes of a register: ***********************/
+
+static bool bIsPackable(const std::vector<tTermInstr>& Code) {
+    for (const tTermInstr& tInstr : Code) {
+        if ((tInstr.u32OpCode == C_TERM_CmdOr) || (tInstr.u32OpCode == C_TERM_CmdAnd) ||
+            (tInstr.u32OpCode == C_TERM_CmdNeg)) return false;
+    }
+    return true;
+}
+
+#endif
+
+/** Public Functions: *****************************************************************/
+
+CTermJit::CTermJit() {
+    m_pCode      = NULL;
+    m_uSize      = 0;
+    m_uFrameSize = 0;
+}
+
+CTermJit::~CTermJit() {
+#if defined(C_JIT_Available)
+    if (m_pCode == NULL) return;
+#if defined(_WIN32)
+    VirtualFree(m_pCode, 0, MEM_RELEASE);
+#else
+    munmap(m_pCode, m_uSize);
+#endif
+#endif
+}
+
+/** Translator: ***********************************************************************
+ *    Returns false, if the code contains an operation, which is not supported, needs *
+ *    more than C_JIT_Registers stack-entries, or there is no executable memory.  *
+ *    The caller keeps using the interpreter then. The generated function runs pairs  *
+ *    through the packed body and the rest through the scalar one:                    *
+ *                                                                                    *
+ *      Packed:  while (i + 2 <= n) { packed body, on trouble goto Redo; i += 2; }    *
+ *               Limit = n; goto Scalar;                                              *
+ *      Redo:    Limit = i + 2;                                                       *
+ *      Scalar:  while (i < Limit) { scalar body; i++; }  goto Packed, if i < n       */
+
+bool CTermJit::bCompile(const std::vector<tTermInstr>& Code, size_t uSlots) {
+#if defined(C_JIT_Available)
+    /** Variables:                                                                    */
+    CJitAssembler Asm;
+    UINT32        u32Packed   = Asm.u32Label();
+    UINT32        u32Tail     = Asm.u32Label();
+    UINT32        u32Redo     = Asm.u32Label();
+    UINT32        u32Scalar   = Asm.u32Label();
+    UINT32        u32Next     = Asm.u32Label();
+    UINT32        u32Done     = Asm.u32Label();
+    UINT32        u32DivFail  = Asm.u32Label();
+    UINT32        u32BoolFail = Asm.u32Label();
+    UINT32        u32Fail     = Asm.u32Label();
+    UINT32        u32Xmm;
+    size_t        uPage;
+    double        dNaN = NAN;
+    UINT64        u64Bits;
+    void*         pMem;
+    if (Code.empty() || (m_pCode != NULL)) return false;
+    /** Prologue: save rbx, rbp, r12-r15 and on Win64 xmm6-15, which are callee-saved *
+     *  there. The frame keeps the stack aligned and has the shadow-space of Win64:   */
+    Asm.vEmit({ 0x55, 0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57 });
+    Asm.vEmit({ 0x48, 0x81, 0xEC });                           // sub rsp, C_JIT_StackFrame
+    Asm.vEmit32(C_JIT_StackFrame);
+#if defined(_WIN32)
+    for (u32Xmm = 6; u32Xmm < 16; u32Xmm++) {                  // movups [rsp+disp32], xmm
+        Asm.vSseHead(C_JIT_PrefixNone, 0x11, u32Xmm, 0);
+        Asm.vEmit({ (UINT8) (0x84 | ((u32Xmm & 7) << 3)), 0x24 });
+        Asm.vEmit32(C_JIT_XmmSaveOffset + 16 * (u32Xmm - 6));
+    }
+#endif
+    /** r12 = input, r13 = output, r14 = status, r15 = count, rbx = frame, rbp = i:   */
+    Asm.vEmit({ 0x4C, 0x8B, (UINT8) (0x60 | C_JIT_RegArg), 0x00 });
+    Asm.vEmit({ 0x4C, 0x8B, (UINT8) (0x68 | C_JIT_RegArg), 0x08 });
+    Asm.vEmit({ 0x4C, 0x8B, (UINT8) (0x70 | C_JIT_RegArg), 0x10 });
+    Asm.vEmit({ 0x4C, 0x8B, (UINT8) (0x78 | C_JIT_RegArg), 0x18 });
+    Asm.vEmit({ 0x48, 0x8B, (UINT8) (0x58 | C_JIT_RegArg), 0x20 });
+    Asm.vEmit({ 0x31, 0xED });                                 // xor ebp, ebp
+    /** Pairs through the packed body:                                                */
+    Asm.vBind(u32Packed);
+    if (bIsPackable(Code)) {
+        Asm.vEmit({ 0x48, 0x8D, 0x45, 0x02 });                 // lea rax, [rbp+2]
+        Asm.vEmit({ 0x4C, 0x39, 0xF8 });                       // cmp rax, r15
+        Asm.vJump(C_JIT_CondAbove, u32Tail);
+        if (!CJitBody(&Asm, uSlots, true, u32Redo, u32DivFail, u32BoolFail).bEmit(Code)) return false;
+        Asm.vEmit({ 0x48, 0x83, 0xC5, 0x02 });                 // add rbp, 2
+        Asm.vJump(C_JIT_CondAlways, u32Packed);
+        Asm.vBind(u32Redo);
+        Asm.vEmit({ 0x48, 0x8D, 0x45, 0x02 });                 // lea rax, [rbp+2]
+        Asm.vEmit({ 0x48, 0x89, 0x44, 0x24, C_JIT_LimitOffset });  // mov [rsp+32], rax
+        Asm.vJump(C_JIT_CondAlways, u32Scalar);
+    }
+    Asm.vBind(u32Tail);
+    Asm.vEmit({ 0x4C, 0x39, 0xFD });                           // cmp rbp, r15
+    Asm.vJump(C_JIT_CondAboveEqual, u32Done);
+    Asm.vEmit({ 0x4C, 0x89, 0x7C, 0x24, C_JIT_LimitOffset });  // mov [rsp+32], r15
+    /** Single values through the scalar body:                                        */
+    Asm.vBind(u32Scalar);
+    Asm.vEmit({ 0x48, 0x3B, 0x6C, 0x24, C_JIT_LimitOffset });  // cmp rbp, [rsp+32]
+    Asm.vJump(C_JIT_CondAboveEqual, u32Packed);
+    if (!CJitBody(&Asm, uSlots, false, u32Redo, u32DivFail, u32BoolFail).bEmit(Code)) return false;
+    Asm.vBind(u32Next);
+    Asm.vEmit({ 0x48, 0xFF, 0xC5 });                           // inc rbp
+    Asm.vJump(C_JIT_CondAlways, u32Scalar);
+    /** Failures of the scalar body: eax holds the status, the output becomes NaN:    */
+    Asm.vBind(u32DivFail);
+    Asm.vEmit({ 0xB8 });                                       // mov eax, C_TERM_DivByZero
+    Asm.vEmit32(C_TERM_DivByZero);
+    Asm.vJump(C_JIT_CondAlways, u32Fail);
+    Asm.vBind(u32BoolFail);
+    Asm.vEmit({ 0xB8 });                                       // mov eax, C_TERM_BoolTooLarge
+    Asm.vEmit32(C_TERM_BoolTooLarge);
+    Asm.vBind(u32Fail);
+    Asm.vEmit({ 0x41, 0x88, 0x04, 0x2E });                     // mov [r14+rbp], al
+    memcpy(&u64Bits, &dNaN, sizeof(u64Bits));
+    Asm.vMovImm(C_JIT_RegRax, u64Bits);
+    Asm.vEmit({ 0x49, 0x89, 0x44, 0xED, 0x00 });               // mov [r13+rbp*8], rax
+    Asm.vJump(C_JIT_CondAlways, u32Next);
+    /** Epilogue:                                                                     */
+    Asm.vBind(u32Done);
+#if defined(_WIN32)
+    for (u32Xmm = 6; u32Xmm < 16; u32Xmm++) {                  // movups xmm, [rsp+disp32]
+        Asm.vSseHead(C_JIT_PrefixNone, 0x10, u32Xmm, 0);
+        Asm.vEmit({ (UINT8) (0x84 | ((u32Xmm & 7) << 3)), 0x24 });
+        Asm.vEmit32(C_JIT_XmmSaveOffset + 16 * (u32Xmm - 6));
+    }
+#endif
+    Asm.vEmit({ 0x48, 0x81, 0xC4 });                           // add rsp, C_JIT_StackFrame
+    Asm.vEmit32(C_JIT_StackFrame);
+    Asm.vEmit({ 0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0x5D, 0xC3 });
+    Asm.vFinish();
+    (void) u32Xmm;
+    /** Copy it into pages of its own, which are executable but no longer writable:   */
+#if defined(_WIN32)
+    SYSTEM_INFO tInfo;
+    DWORD       dwOld;
+    GetSystemInfo(&tInfo);
+    uPage   = tInfo.dwPageSize;
+    m_uSize = (Asm.Bytes.size() + uPage - 1) / uPage * uPage;
+    pMem    = VirtualAlloc(NULL, m_uSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+    if (pMem == NULL) return false;
+    memcpy(pMem, Asm.Bytes.data(), Asm.Bytes.size());
+    if (!VirtualProtect(pMem, m_uSize, PAGE_EXECUTE_READ, &dwOld)) {
+        VirtualFree(pMem, 0, MEM_RELEASE);
+        return false;
+    }
+    FlushInstructionCache(GetCurrentProcess(), pMem, m_uSize);
+#else
+    uPage   = (size_t) sysconf(_SC_PAGESIZE);
+    m_uSize = (Asm.Bytes.size() + uPage - 1) / uPage * uPage;
+    pMem    = mmap(NULL, m_uSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pMem == MAP_FAILED) return false;
+    memcpy(pMem, Asm.Bytes.data(), Asm.Bytes.size());
+    if (mprotect(pMem, m_uSize, PROT_READ | PROT_EXEC) != 0) {
+        munmap(pMem, m_uSize);
+        return false;
+    }
+#endif
+    m_pCode      = pMem;
+    m_uFrameSize = 2 * (uSlots + C_JIT_Registers + 1);
+    return true;
+#else
+    (void) Code;
+    (void) uSlots;
+    return false;
+#endif
+}
+
+/** Get-Function of the doubles, which the frame of vRun needs: ***********************/
+
+size_t CTermJit::uGetFrameSize(void) const {
+    return m_uFrameSize;
+}
+
+/** Runs the generated code: **********************************************************/
+
+void CTermJit::vRun(const double* pdInput, double* pdOutput, UINT8* pu8Status, size_t uCount, double* pdFrame) const {
+    tTermJitArgs tArgs;
+    tArgs.pdInput   = pdInput;
+    tArgs.pdOutput  = pdOutput;
+    tArgs.pu8Status = pu8Status;
+    tArgs.uCount    = uCount;
+    tArgs.pdFrame   = pdFrame;
+    ((void (*)(tTermJitArgs*)) m_pCode)(&tArgs);
+}
@@ -0,0 +1,60 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define C_JIT_Available
+#endif
+
+#define C_JIT_Registers     12           // xmm4-xmm15 hold the stack
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct {
+    const double* pdInput;
+    double*       pdOutput;
+    UINT8*        pu8Status;
+    size_t        uCount;
+    double*       pdFrame;       // Slots, spilled stack-entries and a temporary
+} tTermJitArgs;
+
+/** Class Definition: *****************************************************************
+ *    Translates the postfix-code of a CTerm into x86-64 machine-code. The generated  *
+ *    function loops over the input and runs straight-line SSE2-code, two values at   *
+ *    once where possible. The stack lives in xmm-registers, the slots in the frame.  *
+ *    Transcendental functions call the libm, thus the results and the status are     *
+ *    the ones of s32Execute. The code is read-only after bCompile, so copies of a    *
+ *    term may share it:                                                              */
+
+class CTermJit {
+public:
+    CTermJit();
+    ~CTermJit();
+    bool   bCompile(const std::vector<tTermInstr>& Code, size_t uSlots);
+    size_t uGetFrameSize(void) const;
+    void   vRun(const double* pdInput, double* pdOutput, UINT8* pu8Status, size_t uCount, double* pdFrame) const;
+private:
+    CTermJit(const CTermJit&);
+    CTermJit& operator=(const CTermJit&);
+    void*  m_pCode;
+    size_t m_uSize;
+    size_t m_uFrameSize;
+};
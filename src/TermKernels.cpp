@@ -0,0 +1,182 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string.h>
+#include <math.h>
+#include "TermKernels.h"
+
+/** Local Defines: ********************************************************************/
+
+#define C_KERNEL_Shift      6755399441055744.0          // 1.5 * 2^52, rounds to integers
+#define C_KERNEL_InvPio2    6.36619772367581382433e-01  // 2 / pi
+#define C_KERNEL_Pio2_1     1.57079632673412561417e+00  // pi / 2 in three parts of
+#define C_KERNEL_Pio2_2     6.07710050630396597660e-11  // 33 bits, thus q * part is
+#define C_KERNEL_Pio2_3     2.02226624871116645580e-21  // exact for small q
+#define C_KERNEL_TrigTiny   7.450580596923828125e-09    // 2^-27, sin(x) = x below
+
+/** Local Functions: ******************************************************************/
+
+static inline UINT64 u64Bits(double dValue) {
+    UINT64 u64Value;
+    memcpy(&u64Value, &dValue, sizeof(u64Value));
+    return u64Value;
+}
+
+static inline double dFromBits(UINT64 u64Value) {
+    double dValue;
+    memcpy(&dValue, &u64Value, sizeof(dValue));
+    return dValue;
+}
+
+/** Reduction by pi/2: ****************************************************************
+ *    Returns x - q * pi/2 with q being the nearest integer to x * 2/pi. The low bits *
+ *    of q are returned in pu64Quad:                                                  */
+
+static inline double dReduce(double dX, UINT64* pu64Quad) {
+    double dQ = dX * C_KERNEL_InvPio2 + C_KERNEL_Shift;
+    *pu64Quad = u64Bits(dQ);
+    dQ -= C_KERNEL_Shift;
+    return ((dX - dQ * C_KERNEL_Pio2_1) - dQ * C_KERNEL_Pio2_2) - dQ * C_KERNEL_Pio2_3;
+}
+
+/** Polynomials of fdlibm for |r| <= pi/4: ********************************************/
+
+static inline double dPolySin(double dR) {
+    const double dZ = dR * dR;
+    const double dP = 8.33333333332248946124e-03 + dZ * (-1.98412698298579493134e-04 +
+                      dZ * (2.75573137070700676789e-06 + dZ * (-2.50507602534068634195e-08 +
+                      dZ * 1.58969099521155010221e-10)));
+    return dR + dZ * dR * (-1.66666666666666324348e-01 + dZ * dP);
+}
+
+static inline double dPolyCos(double dR) {
+    const double dZ  = dR * dR;
+    const double dP  = dZ * (4.16666666666666019037e-02 + dZ * (-1.38888888888741095749e-03 +
+                       dZ * (2.48015872894767294178e-05 + dZ * (-2.75573143513906633035e-07 +
+                       dZ * (2.08757232129817482790e-09 + dZ * -1.13596475577881948265e-11)))));
+    const double dHz = 0.5 * dZ;
+    const double dW  = 1.0 - dHz;
+    return dW + (((1.0 - dW) - dHz) + dZ * dP);
+}
+
+/** Selects between two values by the lowest bit and flips the sign by the second: ****/
+
+static inline double dSelect(double dEven, double dOdd, UINT64 u64Quad) {
+    const UINT64 u64Mask = 0 - (u64Quad & 1);
+    return dFromBits(((u64Bits(dOdd) & u64Mask) | (u64Bits(dEven) & ~u64Mask)) ^ ((u64Quad & 2) << 62));
+}
+
+/** Checks, if the polynomial is valid for an argument of sin, cos or tan: ************/
+
+static inline bool bTrigInRange(double dX) {
+    return (fabs(dX) <= C_KERNEL_TrigLimit) && (fabs(dX) >= C_KERNEL_TrigTiny);
+}
+
+/** Public Functions: *****************************************************************/
+
+/** Sine: *****************************************************************************/
+
+void vKernelSin(double* pdRow, size_t uCount) {
+    double dResult[C_KERNEL_Chunk];
+    size_t uBase, uLen, uPos;
+    UINT64 u64Quad;
+    double dR;
+    for (uBase = 0; uBase < uCount; uBase += C_KERNEL_Chunk) {
+        uLen = ((uCount - uBase) < C_KERNEL_Chunk) ? (uCount - uBase) : C_KERNEL_Chunk;
+        for (uPos = 0; uPos < uLen; uPos++) {
+            dR = dReduce(pdRow[uBase + uPos], &u64Quad);
+            dResult[uPos] = dSelect(dPolySin(dR), dPolyCos(dR), u64Quad);
+        }
+        for (uPos = 0; uPos < uLen; uPos++) {
+            pdRow[uBase + uPos] = bTrigInRange(pdRow[uBase + uPos]) ? dResult[uPos] : sin(pdRow[uBase + uPos]);
+        }
+    }
+}
+
+/** Cosine: ***************************************************************************/
+
+void vKernelCos(double* pdRow, size_t uCount) {
+    double dResult[C_KERNEL_Chunk];
+    size_t uBase, uLen, uPos;
+    UINT64 u64Quad;
+    double dR;
+    for (uBase = 0; uBase < uCount; uBase += C_KERNEL_Chunk) {
+        uLen = ((uCount - uBase) < C_KERNEL_Chunk) ? (uCount - uBase) : C_KERNEL_Chunk;
+        for (uPos = 0; uPos < uLen; uPos++) {
+            dR = dReduce(pdRow[uBase + uPos], &u64Quad);
+            dResult[uPos] = dSelect(dPolySin(dR), dPolyCos(dR), u64Quad + 1);
+        }
+        for (uPos = 0; uPos < uLen; uPos++) {
+            pdRow[uBase + uPos] = bTrigInRange(pdRow[uBase + uPos]) ? dResult[uPos] : cos(pdRow[uBase + uPos]);
+        }
+    }
+}
+
+/** Tangent: **************************************************************************
+ *    sin/cos in the even quadrants, -cos/sin in the odd ones:                        */
+
+void vKernelTan(double* pdRow, size_t uCount) {
+    double dResult[C_KERNEL_Chunk];
+    size_t uBase, uLen, uPos;
+    UINT64 u64Quad;
+    double dR, dSin, dCos;
+    for (uBase = 0; uBase < uCount; uBase += C_KERNEL_Chunk) {
+        uLen = ((uCount - uBase) < C_KERNEL_Chunk) ? (uCount - uBase) : C_KERNEL_Chunk;
+        for (uPos = 0; uPos < uLen; uPos++) {
+            dR   = dReduce(pdRow[uBase + uPos], &u64Quad);
+            dSin = dPolySin(dR);
+            dCos = dPolyCos(dR);
+            dResult[uPos] = dSelect(dSin, dCos, u64Quad & 1) / dSelect(dCos, dSin, (u64Quad & 1) * 3);
+        }
+        for (uPos = 0; uPos < uLen; uPos++) {
+            pdRow[uBase + uPos] = bTrigInRange(pdRow[uBase + uPos]) ? dResult[uPos] : tan(pdRow[uBase + uPos]);
+        }
+    }
+}
+
+/** Sine and cosine of the same argument: *********************************************
+ *    Takes the arguments in pdSin. Both share a single reduction:                    */
+
+void vKernelSinCos(double* pdSin, double* pdCos, size_t uCount) {
+    double dResult[C_KERNEL_Chunk];
+    size_t uBase, uLen, uPos;
+    UINT64 u64Quad;
+    double dR, dPolyS, dPolyC, dX;
+    for (uBase = 0; uBase < uCount; uBase += C_KERNEL_Chunk) {
+        uLen = ((uCount - uBase) < C_KERNEL_Chunk) ? (uCount - uBase) : C_KERNEL_Chunk;
+        for (uPos = 0; uPos < uLen; uPos++) {
+            dR     = dReduce(pdSin[uBase + uPos], &u64Quad);
+            dPolyS = dPolySin(dR);
+            dPolyC = dPolyCos(dR);
+            dResult[uPos]       = dSelect(dPolyS, dPolyC, u64Quad);
+            pdCos[uBase + uPos] = dSelect(dPolyS, dPolyC, u64Quad + 1);
+        }
+        for (uPos = 0; uPos < uLen; uPos++) {
+            dX = pdSin[uBase + uPos];
+            if (bTrigInRange(dX)) {
+                pdSin[uBase + uPos] = dResult[uPos];
+            }else{
+                pdSin[uBase + uPos] = sin(dX);
+                pdCos[uBase + uPos] = cos(dX);
+            }
+        }
+    }
+}
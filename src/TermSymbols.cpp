@@ -0,0 +1,364 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+#include <utility>
+#include "Term.h"
+#include "TermSymbols.h"
+
+/** Local Functions: ******************************************************************/
+
+/** Cuts the white-spaces off both ends: **********************************************/
+
+static std::wstring sTrim(const std::wstring& sInput) {
+    size_t uStart = sInput.find_first_not_of(L" \t");
+    if (uStart == std::wstring::npos) return std::wstring();
+    return sInput.substr(uStart, sInput.find_last_not_of(L" \t") - uStart + 1);
+}
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************/
+
+CTermSymbols::CTermSymbols() {
+    m_u32Version = 0;
+    m_tBudget.u32MaxNodes  = C_TERM_DefMaxNodes;
+    m_tBudget.u32MaxDepth  = C_TERM_DefMaxDepth;
+    m_tBudget.u32TimeLimit = 0;
+    m_Scratch.vSetSymbols(this);
+}
+
+/** Destructor: ***********************************************************************/
+
+CTermSymbols::~CTermSymbols() {
+}
+
+/** Definition: ***********************************************************************
+ *    Takes name = expr or name(a, b) = expr. Variables are calculated right away,    *
+ *    functions are parsed. A definition, which fails, changes nothing. Otherwise,    *
+ *    the symbols depending on it are updated, see vPropagate. They are listed in     *
+ *    pUpdated, if they are variables:                                                */
+
+INT32 CTermSymbols::s32Define(const std::wstring& sInput, UINT32* pu32Symbol, std::vector<UINT32>* pUpdated) {
+    /** Variables:                                                                    */
+    tTermSymbol         tNew;
+    std::vector<UINT32> OldUses;
+    tTermValue          tValue = { 0, { 0, false }, false };
+    UINT8               u8Flags;
+    UINT32              u32Symbol;
+    INT32               s32Res;
+    pUpdated->clear();
+    if (!bSplit(sInput, &tNew)) return C_SYM_InvalidName;
+    u32Symbol = u32Find(tNew.sName);
+    if ((u32Symbol != C_SYM_NoSymbol) && (m_Symbols[u32Symbol].bFunction != tNew.bFunction)) return C_SYM_NameInUse;
+    s32Res = s32Compile(&tNew, &tValue);
+    if (s32Res != C_TERM_NumOK) return s32Res;
+    /** A symbol must not depend on itself:                                           */
+    if (u32Symbol != C_SYM_NoSymbol) {
+        for (UINT32 u32Use : tNew.Uses) {
+            if (bReaches(u32Use, u32Symbol)) return C_SYM_Circular;
+        }
+    }
+    /** Take it over, compiled terms may refer to names and functions, which changed: */
+    if (u32Symbol == C_SYM_NoSymbol) {
+        u32Symbol = (UINT32) m_Symbols.size();
+        m_Symbols.emplace_back();
+        m_Values.push_back(tValue);
+        m_Index[tNew.sName] = u32Symbol;
+        m_u32Version++;
+        u8Flags = 0;
+    }else{
+        OldUses.swap(m_Symbols[u32Symbol].Uses);
+        tNew.Users.swap(m_Symbols[u32Symbol].Users);
+        if (tNew.bFunction) {
+            m_u32Version++;
+            u8Flags = C_SYM_Changed | C_SYM_Reparsed;
+        }else{
+            /** An unchanged value leaves its users as they are:                      */
+            u8Flags = ((m_Symbols[u32Symbol].s32Status != C_TERM_NumOK) || !bSameValue(tValue, m_Values[u32Symbol])) ? C_SYM_Changed : 0;
+        }
+    }
+    tNew.s32Status       = C_TERM_NumOK;
+    m_Symbols[u32Symbol] = std::move(tNew);
+    m_Values[u32Symbol]  = tValue;
+    vLink(u32Symbol, OldUses);
+    vPropagate(u32Symbol, u8Flags, pUpdated);
+    *pu32Symbol = u32Symbol;
+    return C_TERM_NumOK;
+}
+
+/** Get-Function of the index of a name, C_SYM_NoSymbol if it is unknown: *************/
+
+UINT32 CTermSymbols::u32Find(const std::wstring& sName) const {
+    auto Hit = m_Index.find(sName);
+    if (Hit == m_Index.end()) return C_SYM_NoSymbol;
+    return Hit->second;
+}
+
+/** Tells, if the symbol is a function: ***********************************************/
+
+bool CTermSymbols::bIsFunction(UINT32 u32Symbol) const {
+    return m_Symbols[u32Symbol].bFunction;
+}
+
+/** Get-Function of the value of a variable, NaN if its calculation failed: ***********/
+
+double CTermSymbols::dGetValue(UINT32 u32Symbol) const {
+    return m_Values[u32Symbol].dValue;
+}
+
+/** Get-Function of the exact value of an integer-typed variable, false otherwise: ****/
+
+bool CTermSymbols::bGetInteger(UINT32 u32Symbol, tTermInt* pValue) const {
+    if (!m_Values[u32Symbol].bInteger) return false;
+    *pValue = m_Values[u32Symbol].tInteger;
+    return true;
+}
+
+/** Get-Function of the complete definition: ******************************************/
+
+const tTermSymbol* CTermSymbols::pGetSymbol(UINT32 u32Symbol) const {
+    return &m_Symbols[u32Symbol];
+}
+
+/** Get-Function of the version, which changes, whenever compiled terms may have     *
+ *  become outdated, thus new names and redefined functions:                          */
+
+UINT32 CTermSymbols::u32GetVersion(void) const {
+    return m_u32Version;
+}
+
+/** Set-Function of the budget, which definitions are parsed with. Existing ones stay *
+ *  as they are, only new and updated definitions are checked against it:             */
+
+void CTermSymbols::vSetBudget(const tTermBudget& tBudget) {
+    m_tBudget = tBudget;
+    m_Scratch.vSetBudget(tBudget);
+}
+
+/** Tells, if the input is a definition rather than a term: ***************************/
+
+bool CTermSymbols::bIsDefinition(const std::wstring& sInput) {
+    return sInput.find(L'=') != std::wstring::npos;
+}
+
+/** Private Functions: ****************************************************************/
+
+/** Splitter: *************************************************************************
+ *    Separates the name, the argument-names and the body of a definition:            */
+
+bool CTermSymbols::bSplit(const std::wstring& sInput, tTermSymbol* pSymbol) {
+    /** Variables:                                                                    */
+    std::wstring sHead;
+    std::wstring sArgument;
+    size_t       uEqual = sInput.find(L'=');
+    size_t       uOpen;
+    size_t       uStart, uPos;
+    if (uEqual == std::wstring::npos) return false;
+    sHead = sTrim(sInput.substr(0, uEqual));
+    pSymbol->sBody         = sInput.substr(uEqual + 1);
+    pSymbol->bFunction     = false;
+    pSymbol->bHasParameter = false;
+    pSymbol->s32Status     = C_TERM_NumOK;
+    pSymbol->Arguments.clear();
+    uOpen = sHead.find(L'(');
+    if (uOpen == std::wstring::npos) {
+        pSymbol->sName = sHead;
+        return bIsName(sHead);
+    }
+    /** A function has its argument-names in brackets:                                */
+    if (sHead.back() != L')') return false;
+    pSymbol->bFunction = true;
+    pSymbol->sName     = sTrim(sHead.substr(0, uOpen));
+    if (!bIsName(pSymbol->sName)) return false;
+    for (uStart = uPos = uOpen + 1; uPos < sHead.length(); uPos++) {
+        if ((sHead[uPos] != L',') && (sHead[uPos] != L')')) continue;
+        sArgument = sTrim(sHead.substr(uStart, uPos - uStart));
+        if (!bIsName(sArgument)) return false;
+        if (std::find(pSymbol->Arguments.begin(), pSymbol->Arguments.end(), sArgument) != pSymbol->Arguments.end()) return false;
+        pSymbol->Arguments.push_back(sArgument);
+        uStart = uPos + 1;
+    }
+    return true;
+}
+
+/** Checks, if the name consists of letters and is no keyword: ************************/
+
+bool CTermSymbols::bIsName(const std::wstring& sName) {
+    if (sName.empty()) return false;
+    for (WCHAR wc : sName) {
+        if ((wc < L'a') || (wc > L'z')) return false;
+    }
+    return !CTerm::bIsKeyword(sName);
+}
+
+/** Checks, if the definition of one symbol refers to another one, directly or not: ***/
+
+bool CTermSymbols::bReaches(UINT32 u32From, UINT32 u32To) {
+    /** Variables:                                                                    */
+    std::vector<UINT32> Pending(1, u32From);
+    std::vector<bool>   Seen(m_Symbols.size(), false);
+    UINT32              u32Symbol;
+    while (!Pending.empty()) {
+        u32Symbol = Pending.back();
+        Pending.pop_back();
+        if (u32Symbol == u32To) return true;
+        if (Seen[u32Symbol]) continue;
+        Seen[u32Symbol] = true;
+        for (UINT32 u32Use : m_Symbols[u32Symbol].Uses) Pending.push_back(u32Use);
+    }
+    return false;
+}
+
+/** Compiler: *************************************************************************
+ *    Parses the body of the symbol and collects the symbols it refers to. Variables  *
+ *    are calculated as well, they must not depend on x:                              */
+
+INT32 CTermSymbols::s32Compile(tTermSymbol* pSymbol, tTermValue* pValue) {
+    /** Variables:                                                                    */
+    INT32 s32Res;
+    if (pSymbol->bFunction) {
+        s32Res = m_Scratch.s32ParseBody(pSymbol->sBody, pSymbol->Arguments, &pSymbol->Body);
+        if ((s32Res != C_TERM_NumOK) && (s32Res != C_TERM_FuncOK)) return s32Res;
+        pSymbol->bHasParameter = (s32Res == C_TERM_FuncOK);
+        m_Scratch.vGetSymbols(&pSymbol->Uses);
+        s32Res = C_TERM_NumOK;
+    }else{
+        pSymbol->Term.vSetSymbols(this);
+        pSymbol->Term.vSetBudget(m_tBudget);
+        s32Res = pSymbol->Term.s32Parse(pSymbol->sBody);
+        if (s32Res != C_TERM_NumOK) return s32Res;
+        pSymbol->Term.vGetSymbols(&pSymbol->Uses);
+        s32Res = s32Evaluate(pSymbol, pValue);
+    }
+    std::sort(pSymbol->Uses.begin(), pSymbol->Uses.end());
+    pSymbol->Uses.erase(std::unique(pSymbol->Uses.begin(), pSymbol->Uses.end()), pSymbol->Uses.end());
+    return s32Res;
+}
+
+/** Calculates a variable, integer-terms exactly like CCalculator does. The variable *
+ *  is integer-typed then, or if its value is an integer up to C_TERM_ExactInt, like  *
+ *  the constants of CTerm::vCompileInteger:                                          */
+
+INT32 CTermSymbols::s32Evaluate(tTermSymbol* pSymbol, tTermValue* pValue) {
+    /** Variables:                                                                    */
+    INT32 s32Res;
+    pValue->bInteger = false;
+    if (pSymbol->Term.bIsInteger() && (pSymbol->Term.s32ExecuteInt(&pValue->tInteger) == C_TERM_NumOK)) {
+        pValue->dValue   = CTerm::dFromPattern(pValue->tInteger);
+        pValue->bInteger = true;
+        return C_TERM_NumOK;
+    }
+    s32Res = pSymbol->Term.s32Execute(0, &pValue->dValue);
+    if (s32Res != C_TERM_NumOK) {
+        pValue->dValue = NAN;
+        return s32Res;
+    }
+    if ((fabs(pValue->dValue) <= C_TERM_ExactInt) && (pValue->dValue == trunc(pValue->dValue))) {
+        pValue->bInteger = CTerm::bToPattern(pValue->dValue, &pValue->tInteger);
+    }
+    return C_TERM_NumOK;
+}
+
+/** Tells, if both values are the same, thus the users need no update. The bits of    *
+ *  the doubles are compared, integers beyond C_TERM_ExactInt may differ with them:   */
+
+bool CTermSymbols::bSameValue(const tTermValue& tValue1, const tTermValue& tValue2) {
+    if (memcmp(&tValue1.dValue, &tValue2.dValue, sizeof(double)) != 0) return false;
+    if (tValue1.bInteger != tValue2.bInteger) return false;
+    if (!tValue1.bInteger) return true;
+    return (tValue1.tInteger.s64Value == tValue2.tInteger.s64Value) && (tValue1.tInteger.bUnsigned == tValue2.tInteger.bUnsigned);
+}
+
+/** Moves the symbol from the users of its former symbols to the ones of its current: */
+
+void CTermSymbols::vLink(UINT32 u32Symbol, const std::vector<UINT32>& OldUses) {
+    for (UINT32 u32Use : OldUses) {
+        std::vector<UINT32>& Users = m_Symbols[u32Use].Users;
+        Users.erase(std::remove(Users.begin(), Users.end(), u32Symbol), Users.end());
+    }
+    for (UINT32 u32Use : m_Symbols[u32Symbol].Uses) m_Symbols[u32Use].Users.push_back(u32Symbol);
+}
+
+/** Propagation: **********************************************************************
+ *    Updates the symbols, which depend on the given one. They are visited in         *
+ *    topological order, thus each one after all of its symbols. A variable is        *
+ *    calculated again, only if one of its symbols changed, and it passes a change    *
+ *    on, only if its own value changed. Users of a redefined function have it        *
+ *    inlined, so they are parsed again:                                              */
+
+void CTermSymbols::vPropagate(UINT32 u32Symbol, UINT8 u8Flags, std::vector<UINT32>* pUpdated) {
+    /** Variables:                                                                    */
+    std::vector<std::pair<UINT32, size_t>> Pending;
+    std::vector<bool>   Seen(m_Symbols.size(), false);
+    std::vector<UINT8>  Flags(m_Symbols.size(), 0);
+    std::vector<UINT32> Order;
+    tTermSymbol*        pSymbol;
+    tTermValue          tValue;
+    UINT32              u32User;
+    UINT8               u8Need;
+    INT32               s32Res;
+    size_t              uPos;
+    if (u8Flags == 0) return;
+    /** Depth-first along the users, the reversed post-order is topological:          */
+    Pending.push_back(std::make_pair(u32Symbol, (size_t) 0));
+    Seen[u32Symbol] = true;
+    while (!Pending.empty()) {
+        const std::vector<UINT32>& Users = m_Symbols[Pending.back().first].Users;
+        if (Pending.back().second < Users.size()) {
+            u32User = Users[Pending.back().second++];
+            if (Seen[u32User]) continue;
+            Seen[u32User] = true;
+            Pending.push_back(std::make_pair(u32User, (size_t) 0));
+            continue;
+        }
+        Order.push_back(Pending.back().first);
+        Pending.pop_back();
+    }
+    /** Update the users, the given symbol is the last one of the post-order:         */
+    Flags[u32Symbol] = u8Flags;
+    for (uPos = Order.size() - 1; uPos-- > 0; ) {
+        u32User = Order[uPos];
+        pSymbol = &m_Symbols[u32User];
+        u8Need  = 0;
+        for (UINT32 u32Use : pSymbol->Uses) u8Need |= Flags[u32Use];
+        if (u8Need == 0) continue;
+        if (pSymbol->bFunction) {
+            /** Without a body, calls of the function fail:                           */
+            if ((u8Need & C_SYM_Reparsed) && (s32Compile(pSymbol, &tValue) != C_TERM_NumOK)) pSymbol->Body.clear();
+            if (u8Need & C_SYM_Reparsed) m_u32Version++;
+            Flags[u32User] = u8Need;
+            continue;
+        }
+        s32Res = (u8Need & C_SYM_Reparsed) ? s32Compile(pSymbol, &tValue) : s32Evaluate(pSymbol, &tValue);
+        if (s32Res != C_TERM_NumOK) {
+            tValue.dValue   = NAN;
+            tValue.bInteger = false;
+        }
+        if ((s32Res != pSymbol->s32Status) || !bSameValue(tValue, m_Values[u32User])) Flags[u32User] = C_SYM_Changed;
+        pSymbol->s32Status = s32Res;
+        m_Values[u32User]  = tValue;
+        pUpdated->push_back(u32User);
+    }
+}
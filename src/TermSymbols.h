@@ -0,0 +1,90 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#define C_SYM_NoSymbol           0xFFFFFFFF
+#define C_SYM_InvalidName        0x50
+#define C_SYM_NameInUse          0x51    // A variable is not redefined as function and vice versa
+#define C_SYM_Circular           0x52
+
+#define C_SYM_Changed            0x01    // Flags of vPropagate
+#define C_SYM_Reparsed           0x02
+
+/** Type Definitions: *****************************************************************/
+
+typedef struct {
+    std::wstring              sName;
+    std::wstring              sBody;          // Definition right of the =
+    std::vector<std::wstring> Arguments;      // Argument-names of a function
+    bool                      bFunction;
+    bool                      bHasParameter;  // The function-body uses x
+    INT32                     s32Status;      // Result of the last evaluation
+    CTerm                     Term;           // Compiled definition of a variable
+    std::vector<tTermNode>    Body;           // Parse-tree of a function, see s32ParseBody
+    std::vector<UINT32>       Uses;           // Symbols within the definition
+    std::vector<UINT32>       Users;          // Symbols, whose definitions use this one
+} tTermSymbol;
+
+typedef struct {
+    double                    dValue;         // NaN, if the calculation failed
+    tTermInt                  tInteger;       // The exact value, if bInteger
+    bool                      bInteger;       // Integer-typed, so integer-terms take the variable as integer
+} tTermValue;
+
+/** Class Definition: *****************************************************************
+ *    The variables (a = 2) and functions (f(a, b) = a * b) of the user. Terms        *
+ *    resolve the names while parsing, variables become slots and functions are       *
+ *    inlined. The definitions form a graph, thus a new definition only updates the   *
+ *    symbols, which depend on it:                                                    */
+
+class CTermSymbols {
+public:
+    CTermSymbols();
+    ~CTermSymbols();
+    INT32  s32Define(const std::wstring& sInput, UINT32* pu32Symbol, std::vector<UINT32>* pUpdated);
+    UINT32 u32Find(const std::wstring& sName) const;
+    bool   bIsFunction(UINT32 u32Symbol) const;
+    double dGetValue(UINT32 u32Symbol) const;
+    bool   bGetInteger(UINT32 u32Symbol, tTermInt* pValue) const;
+    const tTermSymbol* pGetSymbol(UINT32 u32Symbol) const;
+    UINT32 u32GetVersion(void) const;
+    void   vSetBudget(const tTermBudget& tBudget);
+    static bool bIsDefinition(const std::wstring& sInput);
+private:
+    std::vector<tTermSymbol>                 m_Symbols;
+    std::vector<tTermValue>                  m_Values;
+    std::unordered_map<std::wstring, UINT32> m_Index;
+    UINT32                                   m_u32Version;
+    CTerm                                    m_Scratch;
+    tTermBudget                              m_tBudget;
+    bool   bSplit(const std::wstring& sInput, tTermSymbol* pSymbol);
+    static bool bIsName(const std::wstring& sName);
+    bool   bReaches(UINT32 u32From, UINT32 u32To);
+    INT32  s32Compile(tTermSymbol* pSymbol, tTermValue* pValue);
+    INT32  s32Evaluate(tTermSymbol* pSymbol, tTermValue* pValue);
+    static bool bSameValue(const tTermValue& tValue1, const tTermValue& tValue2);
+    void   vLink(UINT32 u32Symbol, const std::vector<UINT32>& OldUses);
+    void   vPropagate(UINT32 u32Symbol, UINT8 u8Flags, std::vector<UINT32>* pUpdated);
+};
@@ -0,0 +1,168 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Global Includes: ******************************************************************/
+
+#include "CoreTypes.h"
+#include "WorkerPool.h"
+
+/** Public Functions: *****************************************************************/
+
+/** Constructor: **********************************************************************
+ *    Starts the worker-threads. Without a given count, there's one per core:         */
+
+CWorkerPool::CWorkerPool(UINT32 u32Threads) {
+    UINT32 u32Index;
+    m_uPending = 0;
+    m_bStop    = false;
+    if (u32Threads == 0) u32Threads = std::thread::hardware_concurrency();
+    if (u32Threads == 0) u32Threads = 1;
+    for (u32Index = 0; u32Index < u32Threads; u32Index++) {
+        m_Threads.push_back(std::thread(&CWorkerPool::vWorker, this, u32Index));
+    }
+}
+
+/** Destructor: ***********************************************************************
+ *    Lets the workers finish the queued jobs and joins them:                         */
+
+CWorkerPool::~CWorkerPool() {
+    {
+        std::unique_lock<std::mutex> Guard(m_Lock);
+        m_bStop = true;
+    }
+    m_JobReady.notify_all();
+    for (std::thread& Thread : m_Threads) Thread.join();
+}
+
+/** Get-Function of the number of workers: ********************************************/
+
+UINT32 CWorkerPool::u32GetThreads(void) {
+    return (UINT32) m_Threads.size();
+}
+
+/** Queues a job for the next free worker: ********************************************/
+
+void CWorkerPool::vSubmit(const tWorkerJob& fnJob) {
+    {
+        std::unique_lock<std::mutex> Guard(m_Lock);
+        m_Jobs.push_back(fnJob);
+        m_uPending++;
+    }
+    m_JobReady.notify_one();
+}
+
+/** Blocks until all queued jobs are done: ********************************************/
+
+void CWorkerPool::vWait(void) {
+    std::unique_lock<std::mutex> Guard(m_Lock);
+    m_AllDone.wait(Guard, [this] { return (m_uPending == 0); });
+}
+
+/** Private Functions: ****************************************************************/
+
+/** Worker-Loop: **********************************************************************
+ *    Each worker passes its index to the jobs, so that they can keep per-thread      *
+ *    copies of their data:                                                           */
+
+void CWorkerPool::vWorker(UINT32 u32Worker) {
+    tWorkerJob fnJob;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> Guard(m_Lock);
+            m_JobReady.wait(Guard, [this] { return (m_bStop || !m_Jobs.empty()); });
+            if (m_Jobs.empty()) return;
+            fnJob = m_Jobs.front();
+            m_Jobs.pop_front();
+        }
+        fnJob(u32Worker);
+        {
+            std::unique_lock<std::mutex> Guard(m_Lock);
+            m_uPending--;
+            if (m_uPending == 0) m_AllDone.notify_all();
+        }
+    }
+}
+
+/** Cancellation-Token: ***************************************************************/
+
+/** Constructor: **********************************************************************/
+
+CCancelToken::CCancelToken() {
+    vReset();
+}
+
+/** Destructor: ***********************************************************************/
+
+CCancelToken::~CCancelToken() {
+}
+
+/** Prepares the token for the next calculation: **************************************/
+
+void CCancelToken::vReset(void) {
+    m_bCancelled  = false;
+    m_u32Progress = C_CANCEL_NoProgress;
+    m_s64Deadline = 0;
+}
+
+/** Asks the calculation to stop, it may be called from any thread: *******************/
+
+void CCancelToken::vCancel(void) {
+    m_bCancelled = true;
+}
+
+/** Tells, if the calculation shall stop: *********************************************/
+
+bool CCancelToken::bIsCancelled(void) const {
+    return m_bCancelled || bIsExpired();
+}
+
+/** Starts the time limit from now on, 0 removes it: **********************************/
+
+void CCancelToken::vSetDeadline(UINT32 u32Milliseconds) {
+    /** Variables:                                                                    */
+    std::chrono::steady_clock::time_point tEnd;
+    if (u32Milliseconds == 0) {
+        m_s64Deadline = 0;
+        return;
+    }
+    tEnd          = std::chrono::steady_clock::now() + std::chrono::milliseconds(u32Milliseconds);
+    m_s64Deadline = (INT64) tEnd.time_since_epoch().count();
+}
+
+/** Tells, if the time limit is over: *************************************************/
+
+bool CCancelToken::bIsExpired(void) const {
+    /** Variables:                                                                    */
+    INT64 s64Deadline = m_s64Deadline;
+    if (s64Deadline == 0) return false;
+    return (INT64) std::chrono::steady_clock::now().time_since_epoch().count() >= s64Deadline;
+}
+
+/** Set-Function of the progress, as the done fraction of the work: *******************/
+
+void CCancelToken::vSetProgress(double dFraction) {
+    if (!(dFraction > 0)) dFraction = 0;
+    if (dFraction > 1) dFraction = 1;
+    m_u32Progress = (UINT32) (dFraction * 1000);
+}
+
+/** Get-Function of the progress in per mille, or C_CANCEL_NoProgress: ****************/
+
+UINT32 CCancelToken::u32GetProgress(void) const {
+    return m_u32Progress;
+}
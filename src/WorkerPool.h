@@ -0,0 +1,78 @@
+//
+//  This file is part of PeaCalc++ project
+//  Copyright (C)2018 Jens Daniel Schlachter <osw.schlachter@mailbox.org>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/** Used Defines: *********************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+
+#define C_CANCEL_NoProgress      0xFFFFFFFF  // The calculation does not know its progress
+
+/** Type Definitions: *****************************************************************/
+
+typedef std::function<void(UINT32 u32Worker)> tWorkerJob;
+
+/** Class Definition: *****************************************************************/
+
+class CWorkerPool {
+public:
+    CWorkerPool(UINT32 u32Threads = 0);
+    ~CWorkerPool();
+    UINT32 u32GetThreads(void);
+    void   vSubmit(const tWorkerJob& fnJob);
+    void   vWait(void);
+private:
+    std::vector<std::thread> m_Threads;
+    std::deque<tWorkerJob>   m_Jobs;
+    std::mutex               m_Lock;
+    std::condition_variable  m_JobReady;
+    std::condition_variable  m_AllDone;
+    size_t                   m_uPending;
+    bool                     m_bStop;
+    void   vWorker(UINT32 u32Worker);
+};
+
+/** Class Definition: *****************************************************************
+ *    Shared by the thread, which asks for a calculation, and the ones doing it. The  *
+ *    calculation polls it, where it can stop cleanly, and reports its progress. A    *
+ *    deadline cancels it as well, once the time limit of the budget is over:         */
+
+class CCancelToken {
+public:
+    CCancelToken();
+    ~CCancelToken();
+    void   vReset(void);
+    void   vCancel(void);
+    bool   bIsCancelled(void) const;
+    void   vSetDeadline(UINT32 u32Milliseconds);
+    bool   bIsExpired(void) const;
+    void   vSetProgress(double dFraction);
+    UINT32 u32GetProgress(void) const;
+private:
+    std::atomic<bool>   m_bCancelled;
+    std::atomic<UINT32> m_u32Progress;    // Per mille or C_CANCEL_NoProgress
+    std::atomic<INT64>  m_s64Deadline;    // Steady-clock ticks or 0 without limit
+};
@@ -28,7 +28,7 @@ copy   ..\LICENSE     ..\build\LICENSE.txt /Y
 
 rem * ... and build:
 windres PeaCalc.rc -O coff -o PeaCalc.res
-g++ -O3 -s -o ..\build\PeaCalc.exe -mwindows -static PeaCalc.cpp ConfigHandler.cpp CommandHandler.cpp Term.cpp PeaCalc.res -lversion -ladvapi32
+g++ -O3 -s -o ..\build\PeaCalc.exe -mwindows -static PeaCalc.cpp ConfigHandler.cpp CommandHandler.cpp Term.cpp TermBatch.cpp TermDual.cpp TermKernels.cpp TermJit.cpp WorkerPool.cpp Sweep.cpp Integrate.cpp Solver.cpp TermCache.cpp TermSymbols.cpp History.cpp NumFormat.cpp BigFloat.cpp Calculator.cpp PeaCalc.res -lversion -ladvapi32
 del *.res
 
 pause
\ No newline at end of file